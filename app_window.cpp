@@ -1,6 +1,7 @@
 //Copyright 2015. Patent pending.
 # include <iostream>
 # include <gsim/gs.h>
+# include <gsim/gs_timer.h>
 # include "app_window.h"
 
 AppWindow::AppWindow ( const char* label, int x, int y, int w, int h )
@@ -14,28 +15,14 @@ AppWindow::AppWindow ( const char* label, int x, int y, int w, int h )
    _rotx = _roty = 0;
    _w = w;
    _h = h;
-   rotate = 0;
-   speed = 0; _turnlr = 0; _turnud = 0;
    xview = 0; yview = 0;
-   animate = false;
    sunx = 0.5f; suny = 1.0f; sunz = 0.8f;
    camera = true;
-   sunanim = true;
-   curvegen = false;
-   curving = false;
-   frontfl = false;
-   backfl = false;
-   concatfl = false;
-   concatch1 = false;
-   concatch2 = false;
-   concatflr = false;
-   flcount = 0;
-   brcount = 0;
-   barrellroll = false, barrellrollr = false;
    _showcurve = false; _shownorms = false;
-   halfrollflip = false;
-   ccount = 0;
-   oldtrans.setrans(GsVec(0, 0, 0));
+   _curveid = 0;
+   _lasttime = gs_seconds();
+   _showprof = false;
+   _proftexttime = 0;
  }
 
 void AppWindow::initPrograms ()
@@ -46,11 +33,14 @@ void AppWindow::initPrograms ()
    _sun.init(); 
    _sun.build(1.0f, 1, 1, 0);
    _building.load("../models/The_City.obj"); //_building.scale(.7f);
-   _city.init(); _city.build(_building);
+   _city.init(); _city.vertex_format(SoModel::InterleavedHalf); _city.build(_building);
    _normal.init(); _tangent.init(); _bitangent.init();
+   # if defined(FRAME_PROFILER)
+   _prof.init(); _proftext.init();
+   # endif
 
    //initiate models
-   _model.init(); _model2.init(); _model3.init(); _model4.init(); _model5.init(); _model6.init();
+   _aircraft.init();
 
    // set light:
    _light.set ( GsVec(0,0,10), GsColor(90,90,90,255), GsColor::white, GsColor::white );
@@ -88,7 +78,7 @@ void AppWindow::loadModel ( int model )
 				}*/
 				printInfo(_gsm); printInfo(_gsm2); printInfo(_gsm3); printInfo(_gsm4); printInfo(_gsm5); printInfo(_gsm6);
 				_gsm.scale(f); _gsm2.scale(f); _gsm3.scale(f); _gsm4.scale(f); _gsm5.scale(f); _gsm6.scale(f);
-				_model.build(_gsm); _model2.build(_gsm2); _model3.build(_gsm3); _model4.build(_gsm4); _model5.build(_gsm5); _model6.build(_gsm6);
+				buildAircraft();
 				break;
       /*case 7:	f=0.20f;
 				file = "../models/al.obj";
@@ -125,6 +115,14 @@ void AppWindow::loadModel ( int model )
 	redraw();
  }
 
+// The body, wings, top tail and back wings are merged in one instanced model,
+// in the order of the part matrices set in glutDisplay()
+void AppWindow::buildAircraft ()
+ {
+   GsModel* parts[6] = { &_gsm, &_gsm2, &_gsm3, &_gsm4, &_gsm5, &_gsm6 };
+   _aircraft.build ( parts, 6 );
+ }
+
 // mouse events are in window coordinates, but your 2D scene is in [0,1]x[0,1],
 // so make here the conversion when needed
 GsVec2 AppWindow::windowToScene ( const GsVec2& v )
@@ -141,59 +139,65 @@ void AppWindow::glutKeyboard ( unsigned char key, int x, int y )
    {
    case ' ': camera = !camera; redraw(); break;
 	  case 27 : exit(1); // Esc was pressed
-      /*case 'o' : std::cout<<"Smoothing normals...\n";
-                _gsm.smooth ( GS_TORAD(35) ); 
+      case 'o' : std::cout<<"Smoothing normals...\n";
+                _gsm.smooth ( GS_TORAD(35) ); _gsm2.smooth ( GS_TORAD(35) ); _gsm3.smooth ( GS_TORAD(35) );
+                _gsm4.smooth ( GS_TORAD(35) ); _gsm5.smooth ( GS_TORAD(35) ); _gsm6.smooth ( GS_TORAD(35) );
                  printInfo(_gsm);
-                 _model.build(_gsm); 
+                 buildAircraft();
                  redraw(); 
-                 break;*/
+                 break;
       case 'f' : std::cout<<"Flat normals...\n";
                 _gsm.flat();
                  printInfo(_gsm);
-                 _model.build(_gsm); 
+                 buildAircraft();
                  redraw(); 
                  break;
-      case 'p' : if ( !_model.phong() )
+      case 'p' : if ( !_aircraft.phong() )
                   { std::cout<<"Switching to phong shader...\n";
-                    _model.phong(true);
+                    _aircraft.phong(true);
                   }
                  redraw(); 
                  break;
-      case 'g' : if ( _model.phong() )
+      case 'g' : if ( _aircraft.phong() )
                   { std::cout<<"Switching to gouraud shader...\n";
-                    _model.phong(false);
+                    _aircraft.phong(false);
                   }
                  redraw(); 
                  break;
-	  case 'e': rotate += 1; redraw(); break;
-	  case 'q': rotate -= 1; redraw(); break;
-	  case 'w': _turnud -= 1; if(curving) _exitcurve = true; redraw(); break;
-	  case 's': _turnud += 1; if (curving) _exitcurve = true; redraw(); break;
-	  case 'a': _turnlr += 1; if (curving) _exitcurve = true; redraw(); break;
-	  case 'd': _turnlr -= 1; if (curving) _exitcurve = true; redraw(); break;
-	  case '[': speed -= .001; redraw(); break;
-	  case '\'': speed += .001; redraw(); break;
-	  case 'n': _wingsflyR++; redraw(); break;
-	  case 'm': _wingsflyR--;  redraw(); break;
-	  case 'b': _wingsflyL++; redraw(); break;
-	  case 'v': _wingsflyL--;  redraw(); break;
-	  case 'l': _backR++; redraw(); break;
-	  case 'k': _backR--; redraw(); break;
-	  case 'j': _backL++; redraw(); break;
-	  case 'h': _backL--; redraw(); break;
+	  case 'e': _sim.turn(1, 0, 0); redraw(); break;
+	  case 'q': _sim.turn(-1, 0, 0); redraw(); break;
+	  case 'w': _sim.turn(0, -1, 0); redraw(); break;
+	  case 's': _sim.turn(0, 1, 0); redraw(); break;
+	  case 'a': _sim.turn(0, 0, 1); redraw(); break;
+	  case 'd': _sim.turn(0, 0, -1); redraw(); break;
+	  case '[': _sim.accelerate(-0.06f); redraw(); break;
+	  case '\'': _sim.accelerate(0.06f); redraw(); break;
+	  case 'n': _sim.move_surfaces(1, 0, 0, 0); redraw(); break;
+	  case 'm': _sim.move_surfaces(-1, 0, 0, 0); redraw(); break;
+	  case 'b': _sim.move_surfaces(0, 1, 0, 0); redraw(); break;
+	  case 'v': _sim.move_surfaces(0, -1, 0, 0); redraw(); break;
+	  case 'l': _sim.move_surfaces(0, 0, 1, 0); redraw(); break;
+	  case 'k': _sim.move_surfaces(0, 0, -1, 0); redraw(); break;
+	  case 'j': _sim.move_surfaces(0, 0, 0, 1); redraw(); break;
+	  case 'h': _sim.move_surfaces(0, 0, 0, -1); redraw(); break;
 	  case 'z': _showcurve = !_showcurve; redraw(); break;
 	  case 'x': _shownorms = !_shownorms; redraw(); break;
-	  case 'y': sunanim = !sunanim; redraw(); break;
-	  case '1': curvegen = !curvegen; break;
-	  case '2': frontfl = !frontfl; redraw(); break;
-	  case '3': backfl = !backfl; redraw(); break;
-	  case '4': barrellroll = !barrellroll; break;
-	  case '5': barrellrollr = !barrellrollr; break;
-	  case '6': concatfl = !concatfl; concatch1 = !concatch1;  redraw(); break;
-	  case '7': concatflr = !concatflr; concatch1 = !concatch1; redraw(); break;
-	  case '8': halfrollflip = !halfrollflip; redraw(); break;
-	  case 't': if (!animate) { animate = true; resetanim = false; }
-				else resetanim = true; redraw(); break;
+	  case 'y': _sim.animate_sun(!_sim.animating_sun()); redraw(); break;
+	  case '1': _sim.gen_curve(); redraw(); break;
+	  case '2': _sim.maneuver(FlightSim::FrontFlip); redraw(); break;
+	  case '3': _sim.maneuver(FlightSim::BackFlip); redraw(); break;
+	  case '4': _sim.maneuver(FlightSim::BarrelRoll); redraw(); break;
+	  case '5': _sim.maneuver(FlightSim::ReverseBarrelRoll); redraw(); break;
+	  case '6': _sim.maneuver(FlightSim::FlipRoll); redraw(); break;
+	  case '7': _sim.maneuver(FlightSim::ReverseFlipRoll); redraw(); break;
+	  case '8': _sim.maneuver(FlightSim::HalfRollFlip); redraw(); break;
+	  case 't': _sim.animate_surfaces(); redraw(); break;
+	  # if defined(FRAME_PROFILER)
+	  case 'i': _showprof = !_showprof; _proftexttime = 0; redraw(); break;
+	  case 'c': if ( _prof.save_csv("profile.csv") && _prof.save_json("profile.json") )
+	             std::cout<<"Saved "<<_prof.frames()<<" frames in profile.csv and profile.json\n";
+	            break;
+	  # endif
       default : loadModel ( int(key-'0') );
                 break;
 	}
@@ -242,6 +246,9 @@ void AppWindow::glutReshape ( int w, int h )
 // here we will redraw the scene according to the current state of the application.
 void AppWindow::glutDisplay ()
  {
+   PROFILE_FRAME ( _prof ); // until the buffers are swapped
+   _frame.reset(); // the temporary data of the last frame is no longer used
+
    // Clear the rendering window
    glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
@@ -250,8 +257,10 @@ void AppWindow::glutDisplay ()
    if ( _axis.changed ) // needs update
     { _axis.build(1.0f); // axis has radius 1.0
     }
-   if (sunanim) {
-	   sunx = 2 * (cos(2 * M_PI*sunxc / 360) + sin(2 * M_PI*sunxc / 360)); suny = 50.0f; sunz = 2 * (-sin(2 * M_PI*sunxz / 360) + cos(2 * M_PI*sunxz / 360));
+   // state of the simulation, interpolated between its last two steps:
+   FlightSim::State st = _sim.interpolated();
+   if (_sim.animating_sun()) {
+	   sunx = 2 * (cos(2 * M_PI*st.sun / 360) + sin(2 * M_PI*st.sun / 360)); suny = 50.0f; sunz = 2 * (-sin(2 * M_PI*st.sun / 360) + cos(2 * M_PI*st.sun / 360));
    }
    else {
 	   sunx = 0.0; suny = 1; sunz = -.5;
@@ -259,34 +268,29 @@ void AppWindow::glutDisplay ()
 
    // Define our scene transformation:
    GsMat rx, ry, stransf, barrelroll, leftright, transf, updown, rightwing, leftwing, offsety, centerrwing, centerlwing, rl, rr, backR, backL, centerbackl, centerbackr, br, bl;
-   GsMat rfrot, lfrot, rbrot, lbrot, rollyawpitch, ShadowT, sunrot, camerarot, ctrans, ctrans2, ctrans3, ctrans4, frenet;
+   GsMat rfrot, lfrot, rbrot, lbrot, rollyawpitch, ShadowT, sunrot, camerarot, ctrans, frenet;
    rx.rotx ( _rotx );
    ry.roty ( _roty );
    camerarot = rx*ry; // set the scene transformation matrix
 
-   if (curving) {
-	   ctrans.setrans(ptrns);
-	   std::cout << "ptrns: \n" << ptrns << std::endl;
-	   std::cout << "ctrans:\n" << ctrans << std::endl;
-
-	   //Frenet-Sennet Frame
-	   frenet.setc3(-1*ctangent);
-	   frenet.setc2(cbitangent);
-	   frenet.setc1(cnormal);
+   if (st.curving) {
+	   ctrans.setrans(st.cpos);
 
-	   //std::cout << "frenet:\n" << frenet << std::endl;
+	   //Rotation minimizing frame
+	   frenet.setc3(-1*st.ctangent);
+	   frenet.setc2(st.cbitangent);
+	   frenet.setc1(st.cnormal);
    }
-   //std::cout << "ctrans:\n" << ctrans2 << std::endl << ctrans3 << std::endl;
    
    //set city in floor
    offsety.translation(GsVec(0.0f, -5.7f, 0.0f));
 
    //Rotate many degrees
-   barrelroll.rotz(2 * M_PI * rotate / 360);
-   leftright.roty(2 * M_PI * _turnlr / 360);
-   updown.rotx(2 * M_PI * _turnud / 360);
+   barrelroll.rotz(2 * M_PI * st.roll / 360);
+   leftright.roty(2 * M_PI * st.yaw / 360);
+   updown.rotx(2 * M_PI * st.pitch / 360);
    //Roll, yaw and pitch for the airplane
-   if (!curving) {
+   if (!st.curving) {
 	   rollyawpitch = leftright*updown*barrelroll;
    }
    
@@ -300,44 +304,22 @@ void AppWindow::glutDisplay ()
    //Translate back wings to airplane
    bl.translation(GsVec(0.05f, 0.2f, 0.0f)); br.translation(GsVec(-0.05f, 0.2f, 0.0f));
    //Rotate front wings
-   rightwing.rotz(2 * M_PI * _wingsflyR / 360); leftwing.rotz(2 * M_PI * -_wingsflyL / 360);
+   rightwing.rotz(2 * M_PI * st.wingr / 360); leftwing.rotz(2 * M_PI * -st.wingl / 360);
    //Rotate back wings
-   backR.rotz(2 * M_PI * _backR / 360); backL.rotz(2 * M_PI * -_backL / 360);
+   backR.rotz(2 * M_PI * st.backr / 360); backL.rotz(2 * M_PI * -st.backl / 360);
    //Sun rotation
-   sunrot.translation(5.f, 50 * cos(2.f * M_PI * sunxc / 360.f), 50 * sin(2.f * M_PI * sunxc / 360.f));
+   sunrot.translation(5.f, 50 * cos(2.f * M_PI * st.sun / 360.f), 50 * sin(2.f * M_PI * st.sun / 360.f));
    //Clean up draw function
    rfrot = rr*rightwing*centerrwing;
    lfrot = rl*leftwing*centerlwing;
    rbrot = br*backR*centerbackr;
    lbrot = bl*backL*centerbackl;
 
-	//speed is fast
-	//Translation matrix for pivot point
-   GsVec P = GsVec(0, 0, speed);
-   GsVec bd = leftright*updown*barrelroll*P;
-   if (!curving) {
-	   R += bd;
-	   transf.setrans(R);
-   }
-   else {
-	   //rollyawpitch.setc1(GsVec(0, 0, 0)); rollyawpitch.setc2(GsVec(0, 0, 0)); rollyawpitch.setc3(GsVec(0, 0, 0)); rollyawpitch.setc4(GsVec(0, 0, 0));
-	   transf.setrans(GsVec(0, 0, 0));
-   }
-   if (_exitcurve) {
-	   curving = false;
-	   //R = bd + ptrns;
-	   R = bd + ptrns;
-	   ctrans.setrans(GsVec(0, 0, 0));
-	   _exitcurve = false;
+   //Airplane and shadow positions, integrated by the simulation
+   if (!st.curving) {
+	   transf.setrans(st.pos);
    }
-	//std::cout << "transf:\n" << transf << std::endl;
-
-
-	
-	//set translations for shadows of airplane
-	GsVec sbd = leftright*P;
-	SR = SR + sbd;
-	ShadowT.setrans(SR);
+	ShadowT.setrans(st.shadowpos);
 
    // Define our projection transformation:
    // (see demo program in gltutors-projection.7z, we are replicating the same behavior here)
@@ -347,13 +329,13 @@ void AppWindow::glutDisplay ()
    GsVec eye(0,0,0), center(0,0,0), up(0,1,0);
    GsVec eye2(0, 10, 0), center2(0, 0, 0), up2(0, 0, 1);
    //set translation for the camera based on airplane
-   eye += R + leftright*updown*barrelroll*camerarot*GsVec(0,0,2);
-   if (!curving) {
-	   center += R + GsVec(0, 0, 0);
+   eye += st.pos + leftright*updown*barrelroll*camerarot*GsVec(0,0,2);
+   if (!st.curving) {
+	   center += st.pos;
    }
    else {
-	   eye = bd + ctrans*frenet*camerarot*GsVec(0, 0, 2);
-	   center = ctrans*cnormal;
+	   eye = ctrans*frenet*camerarot*GsVec(0, 0, 2);
+	   center = ctrans*st.cnormal;
    }
    
    //Shadow matrix calculation
@@ -372,46 +354,12 @@ void AppWindow::glutDisplay ()
    shadowMat.setl3(0.0 - light[2] * ground[0], 0.0 - light[2] * ground[1], dot - light[2] * ground[2], 0.0 - light[2] * ground[3]);
    shadowMat.setl4(0.0 - light[3] * ground[0], 0.0 - light[3] * ground[1], 0.0 - light[3] * ground[2], dot - light[3] * ground[3]);
    
-   //Curve generation
-   if (curvegen) {
-	   ccount = 0;
-	   std::cout << "R: " << R << std::endl;
-	   curvepoints.capacity(0);
-	   controlpoints.push() = GsVec(rand() % 20 + (-10), rand() % 20 + (-10), rand() % 20 + (-3));
-	   if (!curving) {
-		   controlpoints.push() = R; controlpoints.push(GsVec(R.x, R.y, R.z - .5f));
-	   }
-	   else {
-		   controlpoints.push() = ptrns; controlpoints.push(GsVec(ptrns.x, ptrns.y, ptrns.z - .5f));
-	   }
-	   for (int i = 0; i < 10; i++) {
-		   float x = rand() % 20 + (-10);
-		   float y = rand() % 20 + (-10);
-		   float z = rand() % 20 + (-3);
-		   controlpoints.push() = GsVec(x, y, z);
-	   }
-	   if (!curving) 
-		   controlpoints.push() = R; 
-	   else 
-		   controlpoints.push() = ptrns;
-	   controlpoints.push() = controlpoints[3];
-	   std::cout << "controlpoints: " << controlpoints << std::endl;
-	   for (int j = 0; j < controlpoints.size() - 3; j++) {
-		   GsArray<GsVec> pnts; pnts.push() = controlpoints[j]; pnts.push() = controlpoints[j + 1]; pnts.push() = controlpoints[j + 2]; pnts.push() = controlpoints[j + 3];
-		   for (float i = 0; i <= 300; i++) {
-				curvepoints.push() = bospline(i / (float)300, pnts);
-				//c++;
-		   }
-	   }
-	   oldtrans.setrans(curvepoints[0]);
-	   _curve.build(curvepoints, GsColor::red);
-	   //std::cout << "curvepoints: " << curvepoints << std::endl;
-	   controlpoints.capacity(0);
-	   curvegen = false;
-	   curving = true;
+   //Curve of the simulation, built again when a new one is generated
+   if (_sim.curve_id() != _curveid) {
+	   _curve.build(_sim.curve(), GsColor::red);
+	   _curveid = _sim.curve_id();
    }
 
-
    /*if (curving) {
 	   ctrans.setrans(ptrns);
    }
@@ -434,235 +382,78 @@ void AppWindow::glutDisplay ()
    else {
 	   sproj = persp * camview2;
    }
-   _tangent.build(_tan, GsColor::green);
-   _normal.build(_norm, GsColor::yellow);
-   _bitangent.build(_bit, GsColor::magenta);
+   //Tangent, normal and bitangent lines at the curve point, only updated when
+   //shown; their points are temporary data of the frame
+   if (st.curving && _shownorms) {
+	   GsVec* lines = _frame.alloc<GsVec>(6);
+	   lines[0] = st.cpoint; lines[1] = st.cpoint + st.ctangent;
+	   lines[2] = st.cpoint; lines[3] = st.cpoint + st.cnormal;
+	   lines[4] = st.cpoint; lines[5] = st.cpoint + st.cbitangent;
+	   _tangent.build(lines, 2, GsColor::green);
+	   _normal.build(lines + 2, 2, GsColor::yellow);
+	   _bitangent.build(lines + 4, 2, GsColor::magenta);
+   }
 
    //  Note however that when the shader receives a matrix it will store it in column-major 
    //  format, what will cause our values to be transposed, and we will then have in our 
    //  shaders vectors on the left side of a multiplication to a matrix.
    float col = 1;
 
-   // Draw:
-	_model.draw(stransf*transf*ctrans*frenet*rollyawpitch, sproj, _light, 0);
-	_model2.draw(stransf*transf*ctrans*frenet*rollyawpitch*rfrot, sproj, _light, 0);
-	_model3.draw(stransf*transf*ctrans*frenet*rollyawpitch*lfrot, sproj, _light, 0);
-	_model4.draw(stransf*transf*ctrans*frenet*rollyawpitch, sproj, _light, 0);
-	_model5.draw(stransf*transf*ctrans*frenet*rollyawpitch*rbrot, sproj, _light, 0);
-	_model6.draw(stransf*transf*ctrans*frenet*rollyawpitch*lbrot, sproj, _light, 0);
-	_city.draw(stransf*offsety, sproj, _light, 0);
-	_city.draw(stransf*shadowMat*offsety, sproj, _shadow, 0);
-	if(_showcurve)
+   // Draw, each draw call timed as one pass of the frame profiler:
+	// one matrix per part, the body and top tail only move with the airplane:
+	GsMat parts[6];
+	parts[1] = rfrot; parts[2] = lfrot; parts[4] = rbrot; parts[5] = lbrot;
+	{ PROFILE_PASS(_prof, "aircraft");
+	  _aircraft.transform(0, stransf*transf*ctrans*frenet*rollyawpitch, stransf*ShadowT*shadowMat*rollyawpitch, parts);
+	  _aircraft.draw(sproj, _light); }
+	{ PROFILE_PASS(_prof, "city");
+	  _city.draw(stransf*offsety, sproj, _light, 0); }
+	{ PROFILE_PASS(_prof, "city shadow");
+	  _city.draw(stransf*shadowMat*offsety, sproj, _shadow, 0); }
+	if(_showcurve) {
+		PROFILE_PASS(_prof, "curve");
 		_curve.draw(stransf, sproj);
+	}
 	if (_shownorms) {
+		PROFILE_PASS(_prof, "frame lines");
 		_tangent.draw(stransf, sproj);
 		_normal.draw(stransf, sproj);
 		_bitangent.draw(stransf, sproj);
 	}
 	//Shadows
-	_model.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_model2.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_model3.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_model4.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_model5.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_model6.draw(stransf*ShadowT*shadowMat*rollyawpitch, sproj, _shadow, 1);
-	_side.draw(stransf, sproj, _light, col, textures);
-	_sun.draw(stransf * sunrot, sproj);
-
-	//oldtrans.setrans(ptrns);
+	{ PROFILE_PASS(_prof, "aircraft shadow");
+	  _aircraft.draw_shadows(sproj, _shadow); }
+	{ PROFILE_PASS(_prof, "tube");
+	  _side.draw(stransf, sproj, _light, col, textures); }
+	{ PROFILE_PASS(_prof, "sun");
+	  _sun.draw(stransf * sunrot, sproj); }
+
+   # if defined(FRAME_PROFILER)
+   // the overlay text is built again 4 times per second:
+   if ( _showprof )
+    { PROFILE_PASS(_prof, "overlay");
+      double t = gs_seconds();
+      if ( t-_proftexttime>0.25 )
+       { _proftext.build ( _prof.text(_frame), 10, 10, 2, GsColor::yellow, _w, _h );
+         _proftexttime = t;
+       }
+      _proftext.draw ();
+    }
+   # endif
 
    // Swap buffers and draw:
    glFlush();         // flush the pipeline (usually not necessary)
-   glutSwapBuffers(); // we were drawing to the back buffer, now bring it to the front
+   { PROFILE_PASS(_prof, "swap");
+     glutSwapBuffers(); } // we were drawing to the back buffer, now bring it to the front
 }
 
 void AppWindow::glutIdle() 
 {
-	double curtime = gs_time();
-	//Wing animation
-	if (curtime - lasttime > .01f && animate) {
-		if (_wingsflyR >= 45 || _wingsflyR <= -45) {
-			_animinc *= -1;
-		}
-		//front wings
-		_wingsflyR += _animinc;
-		_wingsflyL += _animinc;
-		//back wings
-		_backR += _animinc;
-		_backL += _animinc;
-		lasttime = curtime;
-		//wait until wings are back to zero to end animation
-		if (resetanim == true) {
-			if (_wingsflyR == 0) {
-				animate = false;
-			}
-		}
-		//std::cout << "_wingsfly: " << _wingsflyR << std::endl;
-	}
-	//Sun animation
-	if (curtime - lasttime2 > .1f && sunanim) {
-		sunxc += .1;
-		sunxz += .1;
-		lasttime2 = curtime;
-		if (sunxc == 360) {
-			sunxc = 0;
-			sunxz = 0;
-		}
-	}
-	//curving
-	//std::cout << curvepoints << std::endl;
-	if (curtime - lasttime3 > 0.001f && curving) {
-		//std::cout << curvepoints[ccount + 1] << " " << curvepoints[ccount] << std::endl;
-		cdiff = curvepoints[ccount + 1] - curvepoints[ccount];
-		ctangent = cdiff; ctangent.normalize();
-		
-		ptrns = curvepoints[ccount] + ((float)ccount / (float)curvepoints.size())*ctangent;
-
-		cbitangent = cross(cdiff, curvepoints[ccount] + curvepoints[ccount + 1]); cbitangent.normalize();
-		cnormal = cross(cbitangent, ctangent); cnormal.normalize();
-
-		//Draw tangent, normal, and bitangent lines
-		_tan.capacity(0); _tan.push() = curvepoints[ccount]; _tan.push() = ctangent + curvepoints[ccount];
-		_norm.capacity(0); _norm.push() = curvepoints[ccount]; _norm.push() = curvepoints[ccount] + cnormal;
-		_bit.capacity(0); _bit.push() = curvepoints[ccount]; _bit.push() = curvepoints[ccount] + cbitangent;
-
-		ccount++;
-		if (ccount == curvepoints.size()) {
-			std::cout << "end of curve\n";
-			ccount = 0;
-			curving = false;
-			curvepoints.capacity(0);
-		}
-		lasttime3 = curtime;
-	}
-
-
-
-	//Front flip Animation
-	if (frontfl && flcount <= 360) {
-		_turnud += 1;
-		flcount++;
-		std::cout << _turnud << std::endl;
-		if (flcount == 360) {
-			flcount = 0;
-			frontfl = false;
-		}
-	}
-
-	//Back flip Animation
-	if (backfl && flcount <= 360) {
-		_turnud -= 1;
-		flcount++;
-		std::cout << _turnud << std::endl;
-		if (flcount == 360) {
-			flcount = 0;
-			backfl = false;
-		}
-	}
-
-	//Barrell Roll Animation
-	if (barrellroll && brcount <= 360)
-	{
-		/*if (rotate >= 0 && rotate <= 360)
-			rotate += 2;*/
-		rotate++;
-		brcount++;
-		if (brcount == 360) {
-			brcount = 0;
-			barrellroll = false;
-		}
-	}
-
-	//Reverse Barrell Roll Animation
-	if (barrellrollr && brcount <= 360)
-	{
-		/*if (rotate >= -360 && rotate <= 0)
-			rotate -= 2;*/
-		rotate--;
-		brcount++;
-		if (brcount == 360) {
-			brcount = 0;
-			barrellrollr = false;
-		}
-	}
-
-	//Concatenation 1 - Back Flip + Barrell Roll
-	if (concatfl && flcount <= 720) {
-
-		if (concatch1 && flcount <= 720) {
-			_turnud += 0.5;
-			flcount++;
-
-			if (flcount == 720) {
-				flcount = 0;
-
-				concatch2 = true;
-				concatch1 = false;
-			}
-		}
-
-		if (concatch2 && brcount <= 360)
-		{
-			/*if (rotate >= 0 && rotate <= 360)
-				rotate += 2;*/
-			rotate++;
-			brcount++;
-			if (brcount == 360) {
-				brcount = 0;
-				concatch2 = false;
-				concatfl = false;
-			}
-		}
-	}
-
-	//Concatenation 2 - Front Flip + Reverse Barrell Roll
-	if (concatflr && flcount <= 720) {
-		if (concatch1 && flcount <= 720) {
-			_turnud -= 0.5;
-			flcount++;
-			//std::cout << flcount << std::endl;
-			if (flcount == 720) {
-				flcount = 0;
-
-				concatch2 = true;
-				concatch1 = false;
-			}
-		}
-
-		if (concatch2 && brcount <= 360)
-		{
-			/*if (rotate >= -360 && rotate <= 0)
-				rotate -= 2;*/
-			rotate--;
-			brcount++;
-			//std::cout << brcount << std::endl;
-			if (brcount == 360) {
-				brcount = 0;
-				concatch2 = false;
-				concatflr = false;
-			}
-		}
-
-	}
-
-	if (halfrollflip && curtime - lasttime4 > 0.01f) {
-		if (halfcount <= 180) {
-			_turnud++;
-			rotate++;
-		}
-		/*if (halfcount >= 180) {
-			rotate++;
-		}*/
-		if (halfcount == 180) {
-			halfcount = 0;
-			halfrollflip = false;
-		}
-		halfcount++;
-		lasttime4 = curtime;
-	}
-
-
-	redraw();
+	// The simulation advances in fixed steps by the time elapsed since the last
+	// call, and the scene is only drawn again when the simulation is changing:
+	double curtime = gs_seconds();
+	int steps = _sim.advance(curtime - _lasttime);
+	_lasttime = curtime;
+	if (steps > 0 && _sim.active()) redraw();
+	else gs_sleep(1);
 }
-
-
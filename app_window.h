@@ -6,17 +6,22 @@
 
 # include <gsim/gs_color.h>
 # include <gsim/gs_array.h>
+# include <gsim/gs_arena.h>
 # include <gsim/gs_light.h>
 # include <gsim/gs_vec.h>
 # include "ogl_tools.h"
 # include "glut_window.h"
 # include "so_axis.h"
 # include "so_model.h"
+# include "so_aircraft.h"
 # include "so_texture.h";
 # include "so_textured_tube.h"
 # include "so_capsule.h"
 # include "curve_eval.h"
 # include "so_curve.h"
+# include "flight_sim.h"
+# include "frame_profiler.h"
+# include "so_text.h"
 # include <cmath>
 
 // The functionality of your application should be implemented inside AppWindow
@@ -28,41 +33,41 @@ class AppWindow : public GlutWindow
 
     // My scene objects:
     SoAxis _axis;
-    SoModel _model, _model2, _model3, _model4, _model5, _model6, _city;
+    SoModel _city;
+    SoAircraft _aircraft; // the 6 parts of the 757
 	//SoTriangles _floor, _side1, _side2, _side3, _side4;
 	SoTexturedTube _side;
 	SoCapsule _sun;
 	SoCurve _curve, _normal, _tangent, _bitangent;
-	GsArray<GsVec> _norm, _tan, _bit;
 
     // Scene data:
-    bool  _viewaxis, animate, resetanim, camera, sunanim, frontfl, backfl, concatfl, concatflr, concatch1, concatch2, barrellroll, barrellrollr, halfrollflip;
-	int flcount, brcount, halfcount = 0;
+    bool  _viewaxis, camera;
+    FlightSim _sim;
     GsModel _gsm, _gsm2, _gsm3, _gsm4, _gsm5, _gsm6, _building;
     GsLight _light, _shadow;
 	GLuint *textures = new GLuint[2];
     
     // App data:
     enum MenuEv { evOption0, evOption1 };
-    float _rotx, _roty, _fovy, rotate, speed, xview, yview;
-	float _turnlr, _turnud = 0, _wingsflyR = 0, _wingsflyL = 0, _animinc = 1, _backL = 0, _backR = 0;
+    float _rotx, _roty, _fovy, xview, yview;
 	int _w, _h;
-	GsVec R, SR;
-	double lasttime = 0, lasttime2 = 0, lasttime3 = 0, lasttime4 = 0;
-	float sunx, suny, sunz, sunxc = 0, sunxz = 0;
+	double _lasttime; // time of the last simulation update
+	float sunx, suny, sunz;
 	//curve shit
 	float cx, cy, cz;
-	GsArray<GsVec> controlpoints;
-	GsArray<GsVec> curvepoints;
-	bool curvegen, curving, _showcurve, _shownorms, _exitcurve;
-	GsVec cdiff, ptrns, ctangent, cbitangent, cnormal;
-	GsMat oldtrans;
-	int ccount;
+	bool _showcurve, _shownorms;
+	int _curveid; // curve of the simulation built in _curve
+	FrameProfiler _prof; // times of the passes of glutDisplay(), see frame_profiler.h
+	SoText _proftext;    // overlay with the averages of _prof
+	bool _showprof;
+	double _proftexttime; // time the overlay text was last built
+	GsArena _frame;       // temporary data of glutDisplay(), released at each frame
 
    public :
     AppWindow ( const char* label, int x, int y, int w, int h );
     void initPrograms ();
     void loadModel ( int model );
+    void buildAircraft ();
     GsVec2 windowToScene ( const GsVec2& v );
 
    private : // functions derived from the base class
@@ -0,0 +1,82 @@
+
+# include <gsim/gs.h>
+# include <gsim/gs_parallel.h>
+# include "arc_length.h"
+
+void ArcLength::build ( int segsize )
+ {
+   int n = _pnts.size();
+   _dist.size ( n );
+   if ( n==0 ) return;
+   if ( segsize<1 ) segsize=n;
+   int nsegs = (n+segsize-1)/segsize;
+   int minsegs = GS_MAX ( 1, 4096/segsize ); // below it the threads cost more than they save
+
+   // distances inside each run, the first point of a run measured from the previous point:
+   gs_parallel_blocks ( nsegs, minsegs, [&] ( int b, int e )
+    { for ( int k=b; k<e; k++ )
+       { int i=k*segsize, end=GS_MIN(n,i+segsize);
+         double d = 0; // summed in double, only stored in float
+         for ( ; i<end; i++ )
+          { if ( i>0 ) d += dist(_pnts[i-1],_pnts[i]);
+            _dist[i] = float(d);
+          }
+       }
+    } );
+   if ( nsegs==1 ) return;
+
+   // each run is offset by the length of all runs before it (usually few runs,
+   // kept inside the array object):
+   GsSmallArray<double,16> offset ( nsegs );
+   offset[0] = 0;
+   for ( int k=1; k<nsegs; k++ ) offset[k] = offset[k-1] + _dist[k*segsize-1];
+   gs_parallel_blocks ( nsegs-1, minsegs, [&] ( int b, int e )
+    { for ( int k=b+1; k<=e; k++ )
+       { int end=GS_MIN(n,(k+1)*segsize);
+         for ( int i=k*segsize; i<end; i++ ) _dist[i] = float ( _dist[i]+offset[k] );
+       }
+    } );
+ }
+
+int ArcLength::edge ( float s ) const
+ {
+   int n = _dist.size();
+   if ( n<2 ) return -1;
+   // last point with distance not after s, limited to the last edge:
+   int a=0, b=n-1;
+   if ( s>=_dist[b] ) a=n-2;
+    else
+    { while ( b-a>1 )
+       { int m = (a+b)/2;
+         if ( _dist[m]<=s ) a=m; else b=m;
+       }
+    }
+   while ( a>0 && _dist[a+1]==_dist[a] ) a--; // null edges at the end
+   return a;
+ }
+
+int ArcLength::locate ( float s, float& f ) const
+ {
+   int i = edge ( s );
+   if ( i<0 ) { f=0; return i; }
+   float len = _dist[i+1]-_dist[i];
+   f = len>0? (s-_dist[i])/len : 0;
+   f = GS_BOUND ( f, 0.0f, 1.0f );
+   return i;
+ }
+
+int ArcLength::sample ( float s, GsVec& p, GsVec& t ) const
+ {
+   float f;
+   int i = locate ( s, f );
+   if ( i<0 )
+    { p = _pnts.size()>0? _pnts[0] : GsVec::null;
+      t = GsVec::null;
+      return i;
+    }
+   t = _pnts[i+1]-_pnts[i];
+   p = _pnts[i] + t*f;
+   float len = _dist[i+1]-_dist[i];
+   if ( len>0 ) t/=len;
+   return i;
+ }
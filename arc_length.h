@@ -0,0 +1,41 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef ARC_LENGTH_H
+#define ARC_LENGTH_H
+
+// Include needed header files
+# include <gsim/gs_vec.h>
+# include <gsim/gs_array.h>
+
+// Arc length parameterization of the points sampled from a curve, which are
+// joined by straight edges. The distance along the curve of each point is
+// computed once, then the point and tangent at any distance are found with a
+// binary search and a linear interpolation in the edge containing it, so that
+// the curve can be followed at constant speed without evaluating it again.
+class ArcLength
+ { private :
+    GsArray<GsVec> _pnts;
+    GsArray<float> _dist; // distance of each point from the first one
+   public :
+    // the points of the curve, to be set before calling build()
+    GsArray<GsVec>& points () { return _pnts; }
+    const GsArray<GsVec>& points () const { return _pnts; }
+    // computes the distances of all points; runs of segsize points, e.g. the
+    // samples of each curve segment, are measured in parallel when there are
+    // enough points, and then offset by the length of the runs before them
+    void build ( int segsize );
+    // removes the points and distances, keeping the memory for the next curve
+    void clear () { _pnts.clear(); _dist.clear(); }
+    float length () const { return _dist.size()>0? _dist.top():0; }
+    // the edge [i,i+1] containing distance s, which is clamped to [0,length];
+    // edges of null length are skipped, and -1 is returned if there are no edges
+    int edge ( float s ) const;
+    // the edge containing distance s and the fraction f of the edge at s
+    int locate ( float s, float& f ) const;
+    // the point and unit tangent at distance s, returning the edge index
+    int sample ( float s, GsVec& p, GsVec& t ) const;
+    GsVec point ( float s ) const { GsVec p, t; sample(s,p,t); return p; }
+    GsVec tangent ( float s ) const { GsVec p, t; sample(s,p,t); return t; }
+ };
+
+#endif // ARC_LENGTH_H
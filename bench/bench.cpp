@@ -0,0 +1,172 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <time.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_timer.h>
+# include <gsim/gs_parallel.h>
+# include "bench.h"
+
+# ifdef GS_WINDOWS
+# include <Windows.h>
+# else
+# include <dirent.h>
+# endif
+
+const char* bench_models_dir = "models/";
+double bench_min_time = 0.2;
+
+static FILE* OutFile=0;   // file of bench_output()
+static bool OutJson=false;
+static int OutCount=0;    // results saved in the file
+
+double bench_time ()
+ {
+   return gs_seconds();
+ }
+
+// writes s in the output file quoted for json (q=='"') or as a csv field
+// followed by character q, and then writes the string after
+static void put_string ( const char* s, char q, const char* after )
+ {
+   bool quote = q=='"' || strpbrk(s,",\"\n")!=0;
+   if ( quote ) fputc ( '"', OutFile );
+   for ( ; *s; s++ )
+    { if ( *s=='"' ) fputs ( q=='"'? "\\\"":"\"\"", OutFile );
+      else if ( *s=='\\' && q=='"' ) fputs ( "\\\\", OutFile );
+      else if ( (unsigned char)*s<32 ) fputc ( ' ', OutFile );
+      else fputc ( *s, OutFile );
+    }
+   if ( quote ) fputc ( '"', OutFile );
+   if ( q!='"' ) fputc ( q, OutFile );
+   fputs ( after, OutFile );
+ }
+
+void bench_report ( const char* group, const char* name, int reps, double secs, const char* extra )
+ {
+   if ( reps<1 ) reps=1;
+   printf ( "bench\t%s\t%s\t%d\t%.4f\t%s\n", group, name, reps, 1000.0*secs/double(reps), extra );
+   fflush ( stdout );
+   if ( !OutFile ) return;
+
+   if ( OutJson )
+    { GsString full;
+      full << group << '/' << name;
+      fprintf ( OutFile, "%s\n    { \"name\": ", OutCount>0? ",":"" );
+      put_string ( full, '"', ", \"group\": " );
+      put_string ( group, '"', ", \"case\": " ); put_string ( name, '"', ", " );
+      fprintf ( OutFile, "\"iterations\": %d, \"real_time\": %.6f, \"time_unit\": \"ms\", \"extra\": ",
+                reps, 1000.0*secs/double(reps) );
+      put_string ( extra, '"', " }" );
+    }
+   else
+    { put_string ( group, ',', "" ); put_string ( name, ',', "" );
+      fprintf ( OutFile, "%d,%.6f,", reps, 1000.0*secs/double(reps) );
+      put_string ( extra, '\n', "" );
+    }
+   OutCount++;
+ }
+
+bool bench_output ( const char* filename )
+ {
+   bench_output_close ();
+   OutFile = fopen ( filename, "w" );
+   if ( !OutFile ) return false;
+   const char* ext = gs_extension ( filename );
+   OutJson = ext && gs_compare(ext,"json")==0;
+   OutCount = 0;
+   if ( !OutJson ) { fprintf ( OutFile, "group,case,reps,ms_per_rep,extra\n" ); return true; }
+
+   // the context of the results is saved first, as in the output of Google Benchmark:
+   char date[64];
+   time_t t = time(0);
+   strftime ( date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&t) );
+   # if !defined(GS_NO_SSE) && ( defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=1) ) // as in gs_mat.cpp
+   const char* sse = "true";
+   # else
+   const char* sse = "false";
+   # endif
+   # if defined(__VERSION__)
+   const char* compiler = __VERSION__;
+   # else
+   const char* compiler = "";
+   # endif
+   fprintf ( OutFile, "{\n  \"context\": { \"date\": \"%s\", \"compiler\": ", date );
+   put_string ( compiler, '"', ", " );
+   fprintf ( OutFile, "\"threads\": %d, \"sse\": %s, \"tsc\": %s, \"min_time\": %g, \"models\": ",
+             gs_parallel_threads(), sse, gs_fast_ticks_tsc()? "true":"false", bench_min_time );
+   put_string ( bench_models_dir, '"', " },\n  \"benchmarks\": [" );
+   return true;
+ }
+
+void bench_output_close ()
+ {
+   if ( !OutFile ) return;
+   if ( OutJson ) fprintf ( OutFile, "\n  ]\n}\n" );
+   fclose ( OutFile );
+   OutFile = 0;
+ }
+
+void bench_list_files ( const char* dir, const char* ext, GsStrings& files )
+ {
+   GsString path(dir);
+   if ( path.len()>0 && path.lchar()!='/' && path.lchar()!='\\' ) path<<'/';
+   files.size(0);
+
+   # ifdef GS_WINDOWS
+   GsString pattern = path;
+   pattern << "*." << ext;
+   WIN32_FIND_DATAA fd;
+   HANDLE h = FindFirstFileA ( pattern, &fd );
+   if ( h==INVALID_HANDLE_VALUE ) return;
+   do { GsString f=path; f<<fd.cFileName; files.push(f);
+      } while ( FindNextFileA(h,&fd) );
+   FindClose ( h );
+   # else
+   DIR* d = opendir ( path );
+   if ( !d ) return;
+   struct dirent* e;
+   while ( (e=readdir(d)) )
+    { const char* fext = gs_extension ( e->d_name );
+      if ( !fext || gs_compare(fext,ext)!=0 ) continue;
+      GsString f=path; f<<e->d_name; files.push(f);
+    }
+   closedir ( d );
+   # endif
+
+   files.sort ();
+ }
+
+template <class X>
+static bool same_array ( const GsArray<X>& a, const GsArray<X>& b, const char* aname, GsString* msg )
+ {
+   if ( a.size()==b.size() && (a.size()==0 || memcmp(&a[0],&b[0],sizeof(X)*a.size())==0) ) return true;
+   if ( msg ) msg->setf ( "%s differs (%d/%d elements)", aname, a.size(), b.size() );
+   return false;
+ }
+
+bool bench_same_model ( const GsModel& a, const GsModel& b, GsString* msg )
+ {
+   if ( !same_array(a.V,b.V,"V",msg) ) return false;
+   if ( !same_array(a.N,b.N,"N",msg) ) return false;
+   if ( !same_array(a.T,b.T,"T",msg) ) return false;
+   if ( !same_array(a.F,b.F,"F",msg) ) return false;
+   if ( !same_array(a.Fn,b.Fn,"Fn",msg) ) return false;
+   if ( !same_array(a.Ft,b.Ft,"Ft",msg) ) return false;
+   if ( !same_array(a.Fm,b.Fm,"Fm",msg) ) return false;
+
+   int i;
+   bool ok = a.M.size()==b.M.size();
+   for ( i=0; ok && i<a.M.size(); i++ ) // field by field since GsMaterial has padding
+    { const GsMaterial& ma=a.M[i]; const GsMaterial& mb=b.M[i];
+      ok = ma.ambient==mb.ambient && ma.diffuse==mb.diffuse && ma.specular==mb.specular &&
+           ma.emission==mb.emission && ma.shininess==mb.shininess && ma.texid==mb.texid;
+    }
+   if ( !ok ) { if ( msg ) msg->set("M differs"); return false; }
+
+   ok = a.mtlnames.size()==b.mtlnames.size() && strcmp(a.name,b.name)==0 && a.textures.size()==b.textures.size();
+   for ( i=0; ok && i<a.mtlnames.size(); i++ ) ok = strcmp(a.mtlnames[i],b.mtlnames[i])==0;
+   for ( i=0; ok && i<a.textures.size(); i++ ) ok = strcmp(a.textures[i].fname,b.textures[i].fname)==0;
+   if ( !ok && msg ) msg->set ( "names or textures differ" );
+   return ok;
+ }
@@ -0,0 +1,106 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef BENCH_H
+#define BENCH_H
+
+// Small benchmark harness used by the gsbench executable (see makefile).
+// Results are printed one per line as tab separated fields so that they
+// can be easily collected by scripts:
+//    bench <group> <case> <reps> <ms_per_rep> <extra>
+// and they can also be saved in a json or csv file with bench_output().
+
+# include <gsim/gs.h>
+# include <gsim/gs_string.h>
+# include <gsim/gs_strings.h>
+
+class GsModel;
+
+/*! Returns the current time in seconds, with the best available resolution */
+double bench_time ();
+
+/*! Prints one result line; secs is the total time for reps repetitions */
+void bench_report ( const char* group, const char* name, int reps, double secs, const char* extra="" );
+
+/*! Also saves all following results in the given file, in json format if
+    its extension is json and in csv format otherwise. Returns false if the
+    file could not be created. */
+bool bench_output ( const char* filename );
+
+/*! Completes and closes the file of bench_output(), if any */
+void bench_output_close ();
+
+/*! Minimum total seconds measured by bench_repeat(), can be set from the command line */
+extern double bench_min_time;
+
+/*! Calls run() with an increasing number of repetitions until they take at
+    least bench_min_time seconds, and returns the number of repetitions of
+    the last try, with their total time in secs. */
+template <class R>
+int bench_repeat ( R run, double& secs )
+ {
+   int reps=1;
+   while ( true )
+    { double t0 = bench_time();
+      for ( int r=0; r<reps; r++ ) run();
+      secs = bench_time()-t0;
+      if ( secs>=bench_min_time || reps>=(1<<24) ) return reps;
+      // the next try aims at 1.4 times the minimum, with at most 10 times the repetitions:
+      double f = secs>0? 1.4*bench_min_time/secs : 10.0;
+      reps = f>10.0? reps*10 : int(double(reps)*f)+1;
+    }
+ }
+
+/*! Same as bench_repeat(run,secs), but calling setup() before each run(),
+    without measuring it, for operations which modify their input. Since the
+    setup may take much longer than a fast run(), a try also ends when the
+    calls take 10 times bench_min_time. */
+template <class S, class R>
+int bench_repeat ( S setup, R run, double& secs )
+ {
+   int reps=1;
+   double start = bench_time();
+   while ( true )
+    { secs = 0;
+      int r;
+      for ( r=0; r<reps; r++ )
+       { setup();
+         double t0 = bench_time();
+         run();
+         secs += bench_time()-t0;
+         if ( t0-start>10.0*bench_min_time ) { r++; break; }
+       }
+      if ( r<reps ) return r;
+      if ( secs>=bench_min_time || reps>=(1<<24) ) return reps;
+      double f = secs>0? 1.4*bench_min_time/secs : 10.0;
+      reps = f>10.0? reps*10 : int(double(reps)*f)+1;
+    }
+ }
+
+/*! Fills files with the full names of the files with the given extension
+    found in directory dir, sorted by name */
+void bench_list_files ( const char* dir, const char* ext, GsStrings& files );
+
+/*! Returns true if both models have exactly the same arrays, names and textures.
+    If they differ and msg is not null, a short description is placed in msg. */
+bool bench_same_model ( const GsModel& a, const GsModel& b, GsString* msg=0 );
+
+/*! Directory where the .obj models are searched, can be set from the command line */
+extern const char* bench_models_dir;
+
+// benchmark entry points:
+void bench_obj_load ();
+void bench_gsmb_load ();
+void bench_merge_vertices ();
+void bench_remove_normals ();
+void bench_smooth ();
+void bench_model_transform ();
+void bench_vertex_pack ();
+void bench_curve_eval ();
+void bench_mat ();
+void bench_model_ops ();
+void bench_quat ();
+void bench_image_load ();
+void bench_array ();
+void bench_tree ();
+
+#endif // BENCH_H
@@ -0,0 +1,228 @@
+
+# include <stdio.h>
+# include <math.h>
+# include <gsim/gs_array.h>
+# include <gsim/gs_mat.h>
+# include "curve_eval.h"
+# include "bench.h"
+
+// Previous curve evaluation, with the binomial coefficients computed from
+// factorials and pow() for every term, and one array allocated per sample:
+static int legacy_factorial ( int n )
+ {
+   return n<=1? 1 : n*legacy_factorial(n-1);
+ }
+
+static float legacy_binomial_coff ( float n, float k )
+ {
+   return float ( legacy_factorial(int(n)) / (legacy_factorial(int(k))*legacy_factorial(int(n-k))) );
+ }
+
+static GsVec legacy_eval_bezier ( float t, const GsArray<GsVec>& ctrlpnts )
+ {
+   GsVec P;
+   int size = ctrlpnts.size();
+   for ( int i=0; i<size; i++ )
+    { P.x = P.x + legacy_binomial_coff((float)(size-1),(float)i) * pow(t,(double)i) * pow((1-t),(size-1-i)) * ctrlpnts[i].x;
+      P.y = P.y + legacy_binomial_coff((float)(size-1),(float)i) * pow(t,(double)i) * pow((1-t),(size-1-i)) * ctrlpnts[i].y;
+      P.z = P.z + legacy_binomial_coff((float)(size-1),(float)i) * pow(t,(double)i) * pow((1-t),(size-1-i)) * ctrlpnts[i].z;
+    }
+   return P;
+ }
+
+static GsVec legacy_bospline ( float t, const GsArray<GsVec>& pnts )
+ {
+   GsVec bez[4];
+   bospline_controls ( pnts.pt(), bez );
+   GsArray<GsVec> a;
+   for ( int i=0; i<4; i++ ) a.push()=bez[i];
+   return legacy_eval_bezier ( t, a );
+ }
+
+// B-spline evaluated with the recursive N() for all points:
+static GsVec legacy_eval_bspline ( float t, int k, const GsArray<GsVec>& pnts )
+ {
+   GsVec P;
+   for ( int i=0; i<pnts.size(); i++ ) P += pnts[i] * N(i,k,t);
+   return P;
+ }
+
+static float max_error ( const GsArray<GsVec>& a, const GsArray<GsVec>& b )
+ {
+   float e=0;
+   for ( int i=0; i<a.size(); i++ ) GS_UPDMAX ( e, dist(a[i],b[i]) );
+   return e;
+ }
+
+static void report ( const char* name, int reps, double secs, int samples, double tlegacy, float err )
+ {
+   GsString extra;
+   double ns = secs*1.0e9/double(reps)/double(samples);
+   if ( tlegacy<0 )
+    extra.setf ( "samples=%d ns_per_sample=%.2f", samples, ns );
+   else
+    extra.setf ( "samples=%d ns_per_sample=%.2f speedup=%.2fx maxerr=%.2e", samples, ns,
+                 secs>0? tlegacy/secs:0.0, err );
+   bench_report ( "curve_eval", name, reps, secs, extra );
+ }
+
+// Times the sampling of Bezier curves of a few degrees and of the Bessel-Overhauser
+// segments used for the flight curves, with 301 samples per segment as
+// FlightSim::gen_curve() used to do, comparing the previous functions with the one point
+// Horner evaluation and with the precomputed basis. Also compares the recursive
+// B-spline evaluation with BSpline one parameter at a time and in lanes, and
+// times the tessellation of a path of 10000 control points. Finally compares the
+// number of points and the time of the fixed and adaptive tessellations of a
+// long random path, the adaptive one in world units and in pixels.
+void bench_curve_eval ()
+ {
+   const int segs=200, samples=301, reps=5;
+   int i, j, r;
+   double t0;
+
+   gs_rseed ( 1 );
+   GsArray<GsVec> ctrl ( segs+15 );
+   for ( i=0; i<ctrl.size(); i++ )
+    ctrl[i].set ( gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f), gs_random(-3.0f,16.0f) );
+
+   GsArray<GsVec> a(segs*samples), b(segs*samples), c(segs*samples);
+   GsString name, extra;
+   const int degrees[] = { 3, 7 };
+   for ( int d : degrees )
+    { int m = d+1;
+      GsArray<GsVec> pnts(m);
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       for ( j=0; j<segs; j++ )
+        { for ( i=0; i<m; i++ ) pnts[i]=ctrl[j+i];
+          for ( i=0; i<samples; i++ ) a[j*samples+i] = legacy_eval_bezier ( float(i)/float(samples-1), pnts );
+        }
+      double tlegacy = bench_time()-t0;
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       for ( j=0; j<segs; j++ )
+        for ( i=0; i<samples; i++ ) b[j*samples+i] = eval_bezier ( float(i)/float(samples-1), &ctrl[j], m );
+      double thorner = bench_time()-t0;
+
+      t0 = bench_time();
+      BezierBasis basis ( d, samples );
+      for ( r=0; r<reps; r++ )
+       for ( j=0; j<segs; j++ ) basis.eval ( &ctrl[j], &c[j*samples] );
+      double tbasis = bench_time()-t0;
+
+      name.setf ( "bezier%d:legacy", d ); report ( name, reps, tlegacy, segs*samples, -1, 0 );
+      name.setf ( "bezier%d:horner", d ); report ( name, reps, thorner, segs*samples, tlegacy, max_error(a,b) );
+      name.setf ( "bezier%d:basis", d ); report ( name, reps, tbasis, segs*samples, tlegacy, max_error(a,c) );
+    }
+
+   // Bessel-Overhauser segments:
+   GsArray<GsVec> pnts(4);
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( j=0; j<segs; j++ )
+     { for ( i=0; i<4; i++ ) pnts[i]=ctrl[j+i];
+       for ( i=0; i<samples; i++ ) a[j*samples+i] = legacy_bospline ( float(i)/float(samples-1), pnts );
+     }
+   double tlegacy = bench_time()-t0;
+
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( j=0; j<segs; j++ )
+     { for ( i=0; i<4; i++ ) pnts[i]=ctrl[j+i];
+       for ( i=0; i<samples; i++ ) b[j*samples+i] = bospline ( float(i)/float(samples-1), pnts );
+     }
+   double tpoint = bench_time()-t0;
+
+   t0 = bench_time();
+   BezierBasis basis ( 3, samples );
+   for ( r=0; r<reps; r++ )
+    for ( j=0; j<segs; j++ ) bospline_samples ( &ctrl[j], basis, &c[j*samples] );
+   double tbatch = bench_time()-t0;
+
+   report ( "bospline:legacy", reps, tlegacy, segs*samples, -1, 0 );
+   report ( "bospline:point", reps, tpoint, segs*samples, tlegacy, max_error(a,b) );
+   report ( "bospline:batch", reps, tbatch, segs*samples, tlegacy, max_error(a,c) );
+
+   // uniform B-splines of orders 4 and 6 with 20 samples per knot span:
+   const int bn=200, bsamples=20;
+   const int orders[] = { 4, 6 };
+   GsArray<GsVec> bpnts(bn);
+   for ( i=0; i<bn; i++ ) bpnts[i]=ctrl[i];
+   for ( int k : orders )
+    { BSpline bs ( k, bn );
+      int m = (bn-k+1)*bsamples;
+      GsArray<float> u(m);
+      for ( i=0; i<m; i++ ) u[i] = bs.start() + (bs.end()-bs.start())*float(i)/float(m); // end excluded
+      a.size(m); b.size(m); c.size(m);
+
+      t0 = bench_time();
+      for ( i=0; i<m; i++ ) a[i] = legacy_eval_bspline ( u[i], k, bpnts );
+      tlegacy = bench_time()-t0;
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       for ( i=0; i<m; i++ ) b[i] = bs.eval ( u[i], bpnts.pt() );
+      double tspan = bench_time()-t0;
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ ) bs.eval ( u.pt(), m, bpnts.pt(), c.pt() );
+      double tlanes = bench_time()-t0;
+
+      name.setf ( "bspline%d:legacy", k ); report ( name, 1, tlegacy, m, -1, 0 );
+      name.setf ( "bspline%d:span", k ); report ( name, reps, tspan, m, tlegacy, max_error(a,b) );
+      name.setf ( "bspline%d:lanes", k ); report ( name, reps, tlanes, m, tlegacy, max_error(a,c) );
+    }
+
+   // tessellation of a long path, as done each frame:
+   const int ln=10000;
+   GsArray<GsVec> lpnts(ln);
+   for ( i=0; i<ln; i++ ) lpnts[i]=ctrl[i%ctrl.size()];
+   BSpline bs ( 4, ln );
+   int m = (ln-3)*10;
+   c.size(m);
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ ) bs.tessellate ( lpnts.pt(), m, c.pt() );
+   report ( "bspline4:tessellate10k", reps, bench_time()-t0, m, -1, 0 );
+
+   // fixed and adaptive tessellations of a random path of 1000 segments:
+   const int an=1003;
+   GsArray<GsVec> apnts(an);
+   for ( i=0; i<an; i++ ) apnts[i].set ( gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f), gs_random(-3.0f,16.0f) );
+   GsMat view, persp, viewproj;
+   view.lookat ( GsVec(0,5,40), GsVec(0,0,5), GsVec::j );
+   persp.perspective ( GS_TORAD(60.0f), 1.0f, 0.1f, 500.0f );
+   viewproj = persp*view;
+
+   GsArray<GsVec> out;
+   out.size ( (an-3)*samples );
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( j=0; j<an-3; j++ ) bospline_samples ( &apnts[j], basis, &out[j*samples] );
+   double tfixed = bench_time()-t0;
+   extra.setf ( "points=%d upload_kb=%.1f", out.size(), float(out.size()*sizeof(GsVec))/1024.0f );
+   bench_report ( "curve_eval", "path:fixed301", reps, tfixed, extra );
+
+   const float tols[] = { 0.01f, 0.001f };
+   for ( float tol : tols )
+    { t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       { out.size(0);
+         for ( j=0; j<an-3; j++ ) bospline_adaptive ( &apnts[j], tol, out, j==an-4 );
+       }
+      double t = bench_time()-t0;
+      extra.setf ( "points=%d upload_kb=%.1f speedup=%.2fx", out.size(), float(out.size()*sizeof(GsVec))/1024.0f, t>0? tfixed/t:0.0 );
+      name.setf ( "path:adaptive%g", tol );
+      bench_report ( "curve_eval", name, reps, t, extra );
+    }
+
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    { out.size(0);
+      for ( j=0; j<an-3; j++ ) bospline_adaptive ( &apnts[j], 0.5f, viewproj, 1024.0f, 768.0f, out, j==an-4 );
+    }
+   double tpix = bench_time()-t0;
+   extra.setf ( "points=%d upload_kb=%.1f speedup=%.2fx", out.size(), float(out.size()*sizeof(GsVec))/1024.0f, tpix>0? tfixed/tpix:0.0 );
+   bench_report ( "curve_eval", "path:adaptive0.5px", reps, tpix, extra );
+ }
@@ -0,0 +1,61 @@
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+# include "bench.h"
+
+//==========================================================================
+// Benchmark driver:
+//    gsbench [-models <dir>] [-min_time <secs>] [-out <file>] [-list] [group1 group2 ...]
+// With no groups given all benchmarks are run, and the group suite runs the
+// benchmarks of the gsim hot paths which are meant to be tracked between
+// versions, saving the results with -out in a json or csv file.
+//==========================================================================
+
+struct BenchEntry { const char* name; void (*func)(); bool suite; };
+
+static const BenchEntry Benchmarks[] =
+ { { "obj_load", bench_obj_load, false },
+   { "gsmb_load", bench_gsmb_load, false },
+   { "merge_vertices", bench_merge_vertices, false },
+   { "remove_normals", bench_remove_normals, false },
+   { "smooth", bench_smooth, false },
+   { "model_transform", bench_model_transform, false },
+   { "vertex_pack", bench_vertex_pack, false },
+   { "curve_eval", bench_curve_eval, true },
+   { "mat", bench_mat, true },
+   { "model_ops", bench_model_ops, true },
+   { "quat", bench_quat, true },
+   { "image_load", bench_image_load, true },
+   { "array", bench_array, true },
+   { "tree", bench_tree, true },
+   { 0, 0, false }
+ };
+
+int main ( int argc, char** argv )
+ {
+   GsStrings groups;
+   const char* out=0;
+   int i;
+   for ( i=1; i<argc; i++ )
+    { if ( strcmp(argv[i],"-models")==0 && i+1<argc ) bench_models_dir=argv[++i];
+      else if ( strcmp(argv[i],"-min_time")==0 && i+1<argc ) bench_min_time=atof(argv[++i]);
+      else if ( strcmp(argv[i],"-out")==0 && i+1<argc ) out=argv[++i];
+      else if ( strcmp(argv[i],"-list")==0 )
+       { for ( const BenchEntry* b=Benchmarks; b->name; b++ ) printf ( "%s%s\n", b->name, b->suite? " (suite)":"" );
+         return 0;
+       }
+      else groups.push ( argv[i] );
+    }
+
+   if ( out && !bench_output(out) ) { printf ( "could not create %s\n", out ); return 1; }
+
+   bool suite = groups.lsearch("suite")>=0;
+   for ( const BenchEntry* b=Benchmarks; b->name; b++ )
+    { if ( groups.size()>0 && groups.lsearch(b->name)<0 && !(suite&&b->suite) ) continue;
+      b->func ();
+    }
+
+   bench_output_close ();
+   return 0;
+ }
@@ -0,0 +1,157 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <gsim/gs_mat.h>
+# include "bench.h"
+
+// Previous scalar GsMat code, allocating a temporary when the result is an operand:
+static void legacy_mult ( GsMat& r, const GsMat& m1, const GsMat& m2 )
+ {
+   GsMat* m = (&r==&m1||&r==&m2)? new GsMat(GsMat::NoInit) : &r;
+   for ( int i=0; i<16; i+=4 )
+    { const float* a = m1.e+i;
+      for ( int j=0; j<4; j++ )
+       m->e[i+j] = a[0]*m2.e[j] + a[1]*m2.e[4+j] + a[2]*m2.e[8+j] + a[3]*m2.e[12+j];
+    }
+   if ( m!=&r ) { r=*m; delete m; }
+ }
+
+static void legacy_inverse ( const GsMat& m, GsMat& inv )
+ {
+   float d = m.det();
+   if ( d==0.0 ) return;
+   d = 1.0f/d;
+   float m12 = m.e21*m.e32 - m.e22*m.e31;
+   float m13 = m.e21*m.e33 - m.e23*m.e31;
+   float m14 = m.e21*m.e34 - m.e24*m.e31;
+   float m23 = m.e22*m.e33 - m.e23*m.e32;
+   float m24 = m.e22*m.e34 - m.e24*m.e32;
+   float m34 = m.e23*m.e34 - m.e24*m.e33;
+   inv.e11 = (m.e42*m34 - m.e43*m24 + m.e44*m23) * d;
+   inv.e21 = (m.e43*m14 - m.e41*m34 - m.e44*m13) * d;
+   inv.e31 = (m.e41*m24 - m.e42*m14 + m.e44*m12) * d;
+   inv.e41 = (m.e42*m13 - m.e41*m23 - m.e43*m12) * d;
+   inv.e14 = (m.e13*m24 - m.e12*m34 - m.e14*m23) * d;
+   inv.e24 = (m.e11*m34 - m.e13*m14 + m.e14*m13) * d;
+   inv.e34 = (m.e12*m14 - m.e11*m24 - m.e14*m12) * d;
+   inv.e44 = (m.e11*m23 - m.e12*m13 + m.e13*m12) * d;
+   m12 = m.e11*m.e42 - m.e12*m.e41;
+   m13 = m.e11*m.e43 - m.e13*m.e41;
+   m14 = m.e11*m.e44 - m.e14*m.e41;
+   m23 = m.e12*m.e43 - m.e13*m.e42;
+   m24 = m.e12*m.e44 - m.e14*m.e42;
+   m34 = m.e13*m.e44 - m.e14*m.e43;
+   inv.e12 = (m.e32*m34 - m.e33*m24 + m.e34*m23) * d;
+   inv.e22 = (m.e33*m14 - m.e31*m34 - m.e34*m13) * d;
+   inv.e32 = (m.e31*m24 - m.e32*m14 + m.e34*m12) * d;
+   inv.e42 = (m.e32*m13 - m.e31*m23 - m.e33*m12) * d;
+   inv.e13 = (m.e23*m24 - m.e22*m34 - m.e24*m23) * d;
+   inv.e23 = (m.e21*m34 - m.e23*m14 + m.e24*m13) * d;
+   inv.e33 = (m.e22*m14 - m.e21*m24 - m.e24*m12) * d;
+   inv.e43 = (m.e21*m23 - m.e22*m13 + m.e23*m12) * d;
+ }
+
+static void legacy_transpose ( GsMat& m )
+ {
+   float tmp;
+   GS_SWAP ( m.e12, m.e21 ); GS_SWAP ( m.e13, m.e31 ); GS_SWAP ( m.e14, m.e41 );
+   GS_SWAP ( m.e23, m.e32 ); GS_SWAP ( m.e24, m.e42 ); GS_SWAP ( m.e34, m.e43 );
+ }
+
+static GsVec legacy_transform ( const GsMat& m, const GsVec& v )
+ {
+   GsVec r ( m.e11*v.x + m.e12*v.y + m.e13*v.z + m.e14,
+             m.e21*v.x + m.e22*v.y + m.e23*v.z + m.e24,
+             m.e31*v.x + m.e32*v.y + m.e33*v.z + m.e34 );
+   float w = m.e41*v.x + m.e42*v.y + m.e43*v.z + m.e44;
+   if ( w!=0.0 && w!=1.0 ) r/=w;
+   return r;
+ }
+
+static bool same ( const float* a, const float* b, int n )
+ {
+   return memcmp ( a, b, n*sizeof(float) )==0;
+ }
+
+static void report ( const char* name, int n, double tlegacy, double t, bool exact )
+ {
+   GsString extra;
+   extra.setf ( "ns_per_op=%.2f legacy_ns=%.2f speedup=%.2fx %s", t*1.0e9/double(n), tlegacy*1.0e9/double(n),
+                t>0? tlegacy/t:0.0, exact? "bit_exact":"DIFFERENT" );
+   bench_report ( "mat", name, 1, t, extra );
+ }
+
+// Times the GsMat products, inverse and transpose against the previous scalar
+// code on random transformations, as chained by AppWindow::glutDisplay(), and
+// checks that the results are the same bits.
+void bench_mat ()
+ {
+   const int n=1024, reps=2000;
+   int i, r;
+   gs_rseed ( 1 );
+   GsArray<GsMat> M(n), A(n), B(n);
+   GsArray<GsVec> V(n), va(n), vb(n);
+   for ( i=0; i<n; i++ )
+    { GsMat rot, tr;
+      rot.rot ( GsVec(gs_random(-1.0f,1.0f),gs_random(-1.0f,1.0f),gs_random(-1.0f,1.0f)), gs_random(-3.0f,3.0f) );
+      tr.translation ( gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f) );
+      M[i] = tr*rot;
+      M[i].e[0] *= gs_random(0.5f,2.0f);
+      V[i].set ( gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f), gs_random(-10.0f,10.0f) );
+    }
+   GsMat persp;
+   persp.perspective ( 1.0f, 1.3f, 0.1f, 100.0f );
+   M[0] = persp*M[1]; // one projective matrix
+
+   // chained products, accumulated in the result as in a *= m:
+   double t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) { A[i]=M[i]; legacy_mult ( A[i], A[i], M[(i+1)%n] ); }
+   double tlegacy = bench_time()-t0;
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) { B[i]=M[i]; B[i]*=M[(i+1)%n]; }
+   double t = bench_time()-t0;
+   report ( "mult:aliased", n*reps, tlegacy, t, same(A[0].e,B[0].e,16*n) );
+
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) legacy_mult ( A[i], M[i], M[(i+1)%n] );
+   tlegacy = bench_time()-t0;
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) B[i] = M[i]*M[(i+1)%n];
+   t = bench_time()-t0;
+   report ( "mult", n*reps, tlegacy, t, same(A[0].e,B[0].e,16*n) );
+
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) legacy_inverse ( M[i], A[i] );
+   tlegacy = bench_time()-t0;
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) M[i].inverse ( B[i] );
+   t = bench_time()-t0;
+   report ( "inverse", n*reps, tlegacy, t, same(A[0].e,B[0].e,16*n) );
+
+   for ( i=0; i<n; i++ ) { A[i]=M[i]; B[i]=M[i]; }
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) legacy_transpose ( A[i] );
+   tlegacy = bench_time()-t0;
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) B[i].transpose();
+   t = bench_time()-t0;
+   report ( "transpose", n*reps, tlegacy, t, same(A[0].e,B[0].e,16*n) );
+
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) va[i] = legacy_transform ( M[i], V[(i+r)%n] );
+   tlegacy = bench_time()-t0;
+   t0 = bench_time();
+   for ( r=0; r<reps; r++ )
+    for ( i=0; i<n; i++ ) vb[i] = M[i]*V[(i+r)%n];
+   t = bench_time()-t0;
+   report ( "transform", n*reps, tlegacy, t, same(&va[0].x,&vb[0].x,3*n) );
+ }
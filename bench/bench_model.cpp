@@ -0,0 +1,598 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_tree.h>
+# include <gsim/gs_quat.h>
+# include <gsim/gs_parallel.h>
+# include "bench.h"
+
+//========================= previous implementations =========================
+
+// quadratic version of GsModel::merge_redundant_vertices() before the hashed grid
+static void legacy_merge_redundant_vertices ( GsModel& m, float prec )
+ {
+   GsArray<GsVec>& V = m.V;
+   GsArray<GsModel::Face>& F = m.F;
+   prec = prec*prec;
+
+   int fsize = F.size();
+   int vsize = V.size();
+   int i, j;
+
+   GsArray<int> iarray;
+   iarray.size ( vsize );
+   for ( i=0; i<vsize; i++ ) iarray[i]=i;
+
+   for ( i=0; i<vsize; i++ )
+    for ( j=0; j<vsize; j++ )
+     { if ( i==j ) break; // keep i < j
+       if ( dist2(V[i],V[j])<prec ) iarray[j]=i;
+     }
+
+   for ( i=0; i<fsize; i++ )
+    { F[i].a = iarray[ F[i].a ];
+      F[i].b = iarray[ F[i].b ];
+      F[i].c = iarray[ F[i].c ];
+    }
+
+   int ind=0;
+   bool newv;
+   for ( i=0; i<vsize; i++ )
+    { newv = iarray[i]==i;
+      V[ind] = V[i];
+      iarray[i] = ind;
+      if ( newv ) ind++;
+    }
+   V.size ( ind );
+
+   for ( i=0; i<fsize; i++ )
+    { F[i].a = iarray[ F[i].a ];
+      F[i].b = iarray[ F[i].b ];
+      F[i].c = iarray[ F[i].c ];
+    }
+ }
+
+// quadratic version of GsModel::remove_redundant_normals() before the hashed grid
+static void legacy_remove_redundant_normals ( GsModel& m, float prec )
+ {
+   GsArray<GsVec>& N = m.N;
+   GsArray<GsModel::Face>& F = m.F;
+   GsArray<GsModel::Face>& Fn = m.Fn;
+   int i, j, k;
+   GsArray<int> iarray;
+
+   prec = prec*prec;
+
+   int fsize = F.size();
+   int nsize = N.size();
+
+   if ( nsize==0 || Fn.size()!=fsize )
+    { N.size(0); 
+      Fn.size(0);
+    }
+   else if ( nsize==1 )
+    { // nothing to test, only 1 normal
+    }
+   else
+    { // remove references to duplicated normals
+      iarray.size ( nsize );
+      iarray.setall ( -1 );
+      for ( i=0; i<nsize; i++ ) 
+       { for ( j=i+1; j<nsize; j++ ) 
+          { if ( iarray[j]>=0 ) continue;
+            if ( dist2(N[i],N[j])<prec )
+             { iarray[j]=i;
+               for ( k=0; k<fsize; k++ ) // replace references to j by i
+                { if ( Fn[k].a==j ) Fn[k].a=i;
+                  if ( Fn[k].b==j ) Fn[k].b=i;
+                  if ( Fn[k].c==j ) Fn[k].c=i;
+                }
+             }
+          }
+       }
+
+      int toadd = 0;
+      for ( i=0; i<iarray.size(); i++ ) 
+       { if ( iarray[i]>=0 )
+          { toadd++;
+            iarray[i]=-1; // unused mark is now -1
+          }
+         else
+          iarray[i] = toadd;
+       }
+
+      for ( i=0; i<fsize; i++ ) // update indices
+       { Fn[i].a -= iarray[Fn[i].a];
+         Fn[i].b -= iarray[Fn[i].b];
+         Fn[i].c -= iarray[Fn[i].c];
+       }
+
+      for ( i=0,j=0; i<iarray.size(); i++ ) // compress N
+       { if ( iarray[i]<0 )
+          { N.remove(j); }
+         else
+          { j++; }
+       }
+    }
+ }
+
+//v:current vtx, vi:vertices around v indicating the faces around v, vec:just a buffer
+static void legacy_gen_normal ( int v, GsArray<GsVec>& vec, GsArray<int>& vi, GsModel *self, float crease_angle )
+ {
+   int i, j, tmp;
+   float ang;
+
+   vec.size(vi.size());
+
+   //gsout<<"original:\n";
+   //for ( i=0; i<vi.size(); i++ ) gsout<<self->F[vi[i]].a<<","<<self->F[vi[i]].b<<","<<self->F[vi[i]].c<<gsnl;
+
+   // order faces around vertex (could use qsort in GsArray):
+   for ( i=0; i<vi.size(); i++ )
+    { for ( j=i+1; j<vi.size(); j++ )
+       { if ( self->common_vertices_of_faces(vi[i],vi[j])==2 ) // share an edge
+	      { GS_SWAP(vi[i+1],vi[j]);
+            break;
+	      }
+       }
+    }
+
+   // gen normals for each face around v:
+   for ( i=0; i<vi.size(); i++ ) 
+    { vec[i]= self->face_normal ( vi[i] ); }
+
+   // search for the first edge with a big angle and rearrange array, so
+   // that the array starts with a "crease angled edge":
+   bool angfound = false;
+   for ( i=0; i<vec.size(); i++ )
+    { ang = angle ( vec[i], vec[(i+1)%vec.size()]);
+      if ( ang>crease_angle ) 
+       { // (values are copied first: push() may reallocate the arrays being read)
+         for ( j=0; j<=i; j++ ) { GsVec x=vec[j]; int y=vi[j]; vec.push()=x; vi.push()=y; }
+	     vec.remove ( 0, i+1 );
+	     vi.remove ( 0, i+1 );
+         angfound = true;
+         break;
+       }
+    }
+   if ( !angfound ) return; // no crease angles in this face cluster
+
+   // Finally set the normals:
+   GsVec n;
+   float x=1.0f;
+   int init=0;
+   GsArray<GsVec>& N = self->N;
+   for ( i=0; i<vec.size(); i++ )
+    { ang = angle ( vec[i], vec[(i+1)%vec.size()]);
+
+      if ( ang>crease_angle )
+       { n = GsVec::null;
+         x = 0.0f;
+         for ( j=init; j<=i; j++ ) { n+=vec[j]; x=x+1.0f; }
+         n /= x; // n is the mean normal of the previous set of smoothed faces around v
+
+         for ( j=init; j<=i; j++ ) 
+          { GsModel::Face &fn=self->Fn[vi[j]];
+            /*if ( f.n<0 ) 
+              { f.n=N.size(); N.insert(N.size(),3); N[f.n]=N[f.a]; N[f.n+1]=N[f.b]; N[f.n+2]=N[f.c]; }
+            if ( v==f.a ) N[f.n]=n;
+	         else if ( v==f.b ) N[f.n+1]=n;
+	          else N[f.n+2]=n;
+            */
+            if ( v==fn.a ) fn.a = N.size();
+	         else if ( v==fn.b ) fn.b = N.size();
+	          else fn.c = N.size();
+            N.push() = n;
+          }
+
+         init = i+1;
+       }
+    } 
+ }
+
+struct VertexNode : public GsTreeNode // only internally used
+ { int v, i, f;
+   VertexNode ( int a, int b, int c ) : v(a), i(b), f(c) {}
+   VertexNode () { v=i=f=0; }
+   VertexNode ( const VertexNode& x ) : GsTreeNode(), v(x.v), i(x.i), f(x.f) {}
+  ~VertexNode () {}
+   friend GsOutput& operator<< ( GsOutput& out, const VertexNode& /*v*/ ) { return out; };
+   friend GsInput& operator>> ( GsInput& inp, VertexNode& /*v*/ ) { return inp; }
+   static inline int compare ( const VertexNode* v1, const VertexNode* v2 )
+    { return v1->v!=v2->v ? v1->v-v2->v   // vertices are different
+                          : v1->i-v2->i;  // vertices are equal: use index i
+    }
+ };
+
+static void insertv ( GsTree<VertexNode>& t, GsArray<int>& vi, int v, int f )
+ {
+   // array vi is only used to generated a suitable tree key sorting the vertices.
+   VertexNode *n = new VertexNode(v,++vi[v],f);
+   if ( !t.insert(n) ) printf("Wrong faces in legacy_smooth()!\n");
+ }
+
+// GsModel::smooth() before the vertex_faces() adjacency, the compared results
+// only differ in the normals of vertices without faces, which were not initialized
+static void legacy_smooth ( GsModel& m, float crease_angle )
+ {
+   GsArray<GsPnt>& V = m.V;
+   GsArray<GsVec>& N = m.N;
+   GsArray<GsModel::Face>& F = m.F;
+   GsArray<GsModel::Face>& Fn = m.Fn;
+   int v, i;
+   GsTree<VertexNode> t;
+   GsArray<int> vi;
+   GsArray<GsVec> vec; // this is just a buffer to be used in gen_normal()
+
+   if ( !V.size() || !F.size() ) return;
+
+   Fn.size ( F.size() );
+
+   vi.size(V.size());
+   for ( i=0; i<vi.size(); i++ ) vi[i]=0;
+
+   for ( i=0; i<F.size(); i++ )
+    { insertv ( t, vi, F[i].a, i );
+      insertv ( t, vi, F[i].b, i );
+      insertv ( t, vi, F[i].c, i );
+      Fn[i].a = F[i].a;
+      Fn[i].b = F[i].b;
+      Fn[i].c = F[i].c;
+    }
+
+   // first pass will interpolate face normals around each vertex:
+   N.size ( V.size() );
+   vi.size(0);
+   t.gofirst ();
+   while ( t.cur()!=GsTreeNode::null )
+    { v = t.cur()->v;
+      vi.push() = t.cur()->f;
+      t.gonext();
+      if ( t.cur()==GsTreeNode::null || v!=t.cur()->v )
+       { GsVec n = GsVec::null;
+         for ( i=0; i<vi.size(); i++ ) n += m.face_normal ( vi[i] );
+         N[v] = n / (float)vi.size();
+         vi.size(0);
+       }
+    }
+
+   if ( crease_angle<0 ) return; // only smooth everything
+
+   // second pass will solve crease angles:
+   vi.size(0);
+   t.gofirst();
+   while ( t.cur()!=GsTreeNode::null )
+    { v = t.cur()->v;
+      vi.push() = t.cur()->f;
+      t.gonext();
+      if ( t.cur()==GsTreeNode::null || v!=t.cur()->v )
+       { legacy_gen_normal ( v, vec, vi, &m, crease_angle );
+         vi.size(0);
+       }
+    }
+   m.remove_redundant_normals ();
+   m.compress ();
+ }
+
+//=============================== utilities ==================================
+
+// makes each face use its own 3 vertices, copies is the number of translated copies
+static void make_soup ( const GsModel& m, GsModel& soup, int copies=1 )
+ {
+   soup.init ();
+   GsArray<GsVec> fv;
+   m.get_face_vertices ( fv );
+   float dx = 0;
+   for ( int i=0; i<fv.size(); i++ ) if ( fv[i].x>dx ) dx=fv[i].x;
+   dx = dx*2.0f+1.0f;
+   for ( int c=0; c<copies; c++ )
+    { int base = soup.V.size();
+      for ( int i=0; i<fv.size(); i++ ) soup.V.push() = fv[i] + GsVec(dx*float(c),0,0);
+      for ( int i=0; i<m.F.size(); i++ ) soup.F.push().set ( base+3*i, base+3*i+1, base+3*i+2 );
+    }
+ }
+
+// copies only the vertices, faces and normals
+static void copy_mesh ( const GsModel& a, GsModel& b )
+ {
+   b.init ();
+   b.V = a.V;
+   b.F = a.F;
+   b.N = a.N;
+   b.Fn = a.Fn;
+ }
+
+// largest distance between the original and the welded position of face vertices
+static float weld_error ( const GsModel& orig, const GsModel& welded )
+ {
+   float err=0;
+   for ( int i=0; i<orig.F.size(); i++ )
+    { const GsModel::Face& a=orig.F[i];
+      const GsModel::Face& b=welded.F[i];
+      float d = dist(orig.V[a.a],welded.V[b.a]);
+      if ( dist(orig.V[a.b],welded.V[b.b])>d ) d=dist(orig.V[a.b],welded.V[b.b]);
+      if ( dist(orig.V[a.c],welded.V[b.c])>d ) d=dist(orig.V[a.c],welded.V[b.c]);
+      if ( d>err ) err=d;
+    }
+   return err;
+ }
+
+//=============================== benchmarks =================================
+
+// Welds the triangle soup of each model with the previous quadratic version
+// (skipped for large models), and the grid version in serial and parallel mode.
+void bench_merge_vertices ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   const float prec = gstiny;
+   const int maxlegacy = 40000; // the quadratic version becomes too slow after this
+   int i;
+
+   for ( i=0; i<=files.size(); i++ )
+    { GsModel m, soup, mold, mser, mpar;
+      GsString name;
+      if ( i<files.size() )
+       { m.load_obj ( files[i] );
+         make_soup ( m, soup );
+         name = gs_filename ( files[i] );
+       }
+      else // large synthetic case
+       { int k = 0;
+         for ( int j=1; j<files.size(); j++ ) if ( gs_size(files[j])>gs_size(files[k]) ) k=j;
+         m.load_obj ( files[k] );
+         make_soup ( m, soup, 6 );
+         name.setf ( "%s_x6", gs_filename(files[k]) );
+       }
+      if ( soup.V.size()==0 ) continue;
+
+      GsString case_name, extra;
+      double t0;
+      if ( soup.V.size()<=maxlegacy )
+       { copy_mesh ( soup, mold );
+         t0 = bench_time();
+         legacy_merge_redundant_vertices ( mold, prec );
+         double t = bench_time()-t0;
+         extra.setf ( "V=%d->%d err=%g", soup.V.size(), mold.V.size(), weld_error(soup,mold) );
+         case_name.setf ( "%s:quadratic", name.pt() );
+         bench_report ( "merge_vertices", case_name, 1, t, extra );
+       }
+
+      copy_mesh ( soup, mser );
+      t0 = bench_time();
+      mser.merge_redundant_vertices ( prec );
+      double tser = bench_time()-t0;
+      extra.setf ( "V=%d->%d err=%g", soup.V.size(), mser.V.size(), weld_error(soup,mser) );
+      case_name.setf ( "%s:grid", name.pt() );
+      bench_report ( "merge_vertices", case_name, 1, tser, extra );
+
+      copy_mesh ( soup, mpar );
+      t0 = bench_time();
+      mpar.merge_redundant_vertices ( prec, true );
+      double tpar = bench_time()-t0;
+      bool same = bench_same_model ( mser, mpar );
+      extra.setf ( "threads=%d V=%d->%d %s", gs_parallel_threads(), soup.V.size(), mpar.V.size(),
+                   same? "same_as_serial":"DIFFERENT" );
+      case_name.setf ( "%s:grid_parallel", name.pt() );
+      bench_report ( "merge_vertices", case_name, 1, tpar, extra );
+    }
+ }
+
+// gives each face corner its own copy of the face normal, as in a flat shaded model
+static void make_corner_normals ( GsModel& m )
+ {
+   m.N.size ( 0 );
+   m.Fn.size ( m.F.size() );
+   for ( int i=0; i<m.F.size(); i++ )
+    { GsVec n = m.face_normal ( i );
+      int base = m.N.size();
+      m.N.push()=n; m.N.push()=n; m.N.push()=n;
+      m.Fn[i].set ( base, base+1, base+2 );
+    }
+ }
+
+// largest distance between the original and the new normals of each face corner
+static float normal_error ( const GsModel& orig, const GsModel& m )
+ {
+   float err=0;
+   for ( int i=0; i<orig.Fn.size(); i++ )
+    { const GsModel::Face& a=orig.Fn[i];
+      const GsModel::Face& b=m.Fn[i];
+      float d = dist(orig.N[a.a],m.N[b.a]);
+      if ( dist(orig.N[a.b],m.N[b.b])>d ) d=dist(orig.N[a.b],m.N[b.b]);
+      if ( dist(orig.N[a.c],m.N[b.c])>d ) d=dist(orig.N[a.c],m.N[b.c]);
+      if ( d>err ) err=d;
+    }
+   return err;
+ }
+
+// Removes the duplicated corner normals of each model with the previous quadratic
+// version (skipped for large models) and the grid version, and times smooth().
+void bench_remove_normals ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   const float prec = gstiny;
+   const int maxlegacy = 40000;
+   int i;
+
+   for ( i=0; i<files.size(); i++ )
+    { GsModel m, mold, mnew;
+      m.load_obj ( files[i] );
+      if ( m.F.size()==0 ) continue;
+      make_corner_normals ( m );
+      const char* fname = gs_filename ( files[i] );
+
+      GsString case_name, extra;
+      double t0;
+      if ( m.N.size()<=maxlegacy )
+       { copy_mesh ( m, mold );
+         t0 = bench_time();
+         legacy_remove_redundant_normals ( mold, prec );
+         double t = bench_time()-t0;
+         extra.setf ( "N=%d->%d err=%g", m.N.size(), mold.N.size(), normal_error(m,mold) );
+         case_name.setf ( "%s:quadratic", fname );
+         bench_report ( "remove_normals", case_name, 1, t, extra );
+       }
+
+      copy_mesh ( m, mnew );
+      t0 = bench_time();
+      mnew.remove_redundant_normals ( prec );
+      double t = bench_time()-t0;
+      extra.setf ( "N=%d->%d err=%g", m.N.size(), mnew.N.size(), normal_error(m,mnew) );
+      case_name.setf ( "%s:grid", fname );
+      bench_report ( "remove_normals", case_name, 1, t, extra );
+
+      copy_mesh ( m, mnew );
+      mnew.N.size(0); mnew.Fn.size(0);
+      t0 = bench_time();
+      mnew.smooth ();
+      t = bench_time()-t0;
+      extra.setf ( "V=%d F=%d N=%d", mnew.V.size(), mnew.F.size(), mnew.N.size() );
+      case_name.setf ( "%s:smooth", fname );
+      bench_report ( "remove_normals", case_name, 1, t, extra );
+    }
+ }
+
+// largest distance between the normals used by each face corner of two models
+static float corner_normal_error ( const GsModel& a, const GsModel& b )
+ {
+   GsArray<GsVec> na, nb;
+   a.get_face_normals ( na );
+   b.get_face_normals ( nb );
+   float err=0;
+   for ( int i=0; i<na.size(); i++ ) { float d=dist(na[i],nb[i]); if ( d>err ) err=d; }
+   return err;
+ }
+
+// Compares smooth() with its previous GsTree based version, for each model
+void bench_smooth ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   const float crease = GS_TORAD(35.0f);
+   int i;
+
+   for ( i=0; i<files.size(); i++ )
+    { GsModel m, mold, mnew;
+      m.load_obj ( files[i] );
+      if ( m.F.size()==0 ) continue;
+      m.N.size(0); m.Fn.size(0);
+      const char* fname = gs_filename ( files[i] );
+
+      copy_mesh ( m, mold );
+      double t0 = bench_time();
+      legacy_smooth ( mold, crease );
+      double told = bench_time()-t0;
+
+      copy_mesh ( m, mnew );
+      t0 = bench_time();
+      mnew.smooth ( crease );
+      double tnew = bench_time()-t0;
+
+      GsString case_name, extra;
+      extra.setf ( "N=%d", mold.N.size() );
+      case_name.setf ( "%s:tree", fname );
+      bench_report ( "smooth", case_name, 1, told, extra );
+      extra.setf ( "threads=%d N=%d err=%g speedup=%.2fx", gs_parallel_threads(), mnew.N.size(),
+                   corner_normal_error(mold,mnew), tnew>0? told/tnew:0.0 );
+      case_name.setf ( "%s:adjacency", fname );
+      bench_report ( "smooth", case_name, 1, tnew, extra );
+    }
+ }
+
+// GsModel::transform() and rotate() before gs_transform.h, one vector at a time,
+// with the normals transformed by the 3x3 part of the matrix as documented:
+static void legacy_transform ( GsModel& m, const GsMat& mat )
+ {
+   int i;
+   for ( i=0; i<m.V.size(); i++ ) m.V[i] = mat * m.V[i];
+   GsMat r = mat;
+   r.setc4 ( 0, 0, 0, 1 );
+   r.setl4 ( 0, 0, 0, 1 );
+   for ( i=0; i<m.N.size(); i++ ) { m.N[i] = r*m.N[i]; m.N[i].normalize(); }
+ }
+
+static void legacy_rotate ( GsModel& m, const GsQuat& q )
+ {
+   int i;
+   for ( i=0; i<m.V.size(); i++ ) m.V[i] = q.apply(m.V[i]);
+   for ( i=0; i<m.N.size(); i++ ) m.N[i] = q.apply(m.N[i]);
+ }
+
+static float max_error ( const GsArray<GsVec>& a, const GsArray<GsVec>& b, bool& exact )
+ {
+   float e = 0;
+   exact = a.size()==b.size() && (a.size()==0 || memcmp(a.pt(),b.pt(),a.size()*sizeof(GsVec))==0);
+   for ( int i=0; i<a.size() && i<b.size(); i++ ) e = GS_MAX ( e, dist(a[i],b[i]) );
+   return e;
+ }
+
+// Transforms all models joined in one scene, as AppWindow::loadModel() scales
+// the 757 parts, with the previous loops and with the batch kernels on one
+// and on all threads.
+void bench_model_transform ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   GsModel scene;
+   for ( int i=0; i<files.size(); i++ )
+    { GsModel m;
+      m.load_obj ( files[i] );
+      scene.V.push ( m.V ); // (appends the array)
+      scene.N.push ( m.N );
+    }
+   if ( scene.V.size()==0 ) return;
+
+   GsMat mat, rot, tr;
+   rot.rot ( GsVec(1,2,3), 0.7f );
+   tr.translation ( 1.0f, -2.0f, 0.5f );
+   mat = tr*rot;
+   mat.e11 *= 1.5f; // not rigid, so the normals need renormalization
+   GsQuat q ( GsVec(1,2,3), 0.7f );
+   const int reps = 10;
+   int threads = gs_parallel_threads();
+
+   for ( int c=0; c<4; c++ )
+    { const char* name = c==0? "scale" : c==1? "translate" : c==2? "transform" : "rotate";
+      GsModel a, b;
+      a.V=scene.V; a.N=scene.N;
+      double t0 = bench_time();
+      for ( int r=0; r<reps; r++ )
+       { if ( c==0 ) { for ( int i=0; i<a.V.size(); i++ ) a.V[i]*=1.001f; }
+         else if ( c==1 ) { for ( int i=0; i<a.V.size(); i++ ) a.V[i]+=GsVec(0.1f,0.2f,0.3f); }
+         else if ( c==2 ) legacy_transform ( a, mat );
+         else legacy_rotate ( a, q );
+       }
+      double told = bench_time()-t0;
+      GsString case_name, extra;
+      extra.setf ( "V=%d N=%d", a.V.size(), a.N.size() );
+      case_name.setf ( "%s:loop", name );
+      bench_report ( "model_transform", case_name, reps, told, extra );
+
+      for ( int k=0; k<2; k++ )
+       { gs_parallel_threads ( k==0? 1:0 );
+         b.V=scene.V; b.N=scene.N;
+         t0 = bench_time();
+         for ( int r=0; r<reps; r++ )
+          { if ( c==0 ) b.scale ( 1.001f );
+            else if ( c==1 ) b.translate ( GsVec(0.1f,0.2f,0.3f) );
+            else if ( c==2 ) b.transform ( mat );
+            else b.rotate ( q );
+          }
+         double t = bench_time()-t0;
+         bool vexact, nexact;
+         float verr = max_error ( a.V, b.V, vexact );
+         float nerr = max_error ( a.N, b.N, nexact );
+         GsString verrs, nerrs;
+         if ( vexact ) verrs="bit_exact"; else verrs.setf ( "err=%g", verr );
+         if ( nexact ) nerrs="bit_exact"; else nerrs.setf ( "err=%g", nerr );
+         extra.setf ( "threads=%d speedup=%.2fx V:%s N:%s", gs_parallel_threads(), t>0? told/t:0.0,
+                      (const char*)verrs, (const char*)nerrs );
+         case_name.setf ( "%s:batch", name );
+         bench_report ( "model_transform", case_name, reps, t, extra );
+       }
+      gs_parallel_threads ( threads );
+    }
+ }
@@ -0,0 +1,98 @@
+
+# include <stdio.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_parallel.h>
+# include "bench.h"
+
+// Compares the mapped .obj loader (serial and chunked) with the original GsInput
+// based loader for every .obj file in the models directory. All must give
+// identical models.
+void bench_obj_load ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   if ( files.size()==0 ) { printf ( "no .obj files found in %s\n", bench_models_dir ); return; }
+
+   const int reps = 3;
+   double totold=0, totnew=0, totpar=0;
+   int i, r;
+   for ( i=0; i<files.size(); i++ )
+    { GsModel mold, mnew, mpar;
+      const char* fname = gs_filename ( files[i] );
+
+      double t0 = bench_time();
+      for ( r=0; r<reps; r++ ) mold.load_obj_gsinput ( files[i] );
+      double told = bench_time()-t0;
+
+      gs_parallel_threads ( 1 ); // load_obj() will be serial
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ ) mnew.load_obj ( files[i] );
+      double tnew = bench_time()-t0;
+      gs_parallel_threads ( 0 );
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ ) mpar.load_obj_parallel ( files[i] );
+      double tpar = bench_time()-t0;
+
+      GsString msg, extra;
+      bool same = bench_same_model ( mold, mnew, &msg );
+      extra.setf ( "V=%d F=%d speedup=%.2fx %s", mnew.V.size(), mnew.F.size(),
+                   tnew>0? told/tnew:0.0, same? "identical":msg.pt() );
+
+      GsString name;
+      name.setf ( "%s:gsinput", fname ); bench_report ( "obj_load", name, reps, told );
+      name.setf ( "%s:mapped", fname );  bench_report ( "obj_load", name, reps, tnew, extra );
+
+      same = bench_same_model ( mold, mpar, &msg );
+      extra.setf ( "threads=%d speedup=%.2fx %s", gs_parallel_threads(),
+                   tpar>0? tnew/tpar:0.0, same? "identical":msg.pt() );
+      name.setf ( "%s:chunked", fname ); bench_report ( "obj_load", name, reps, tpar, extra );
+      totold+=told; totnew+=tnew; totpar+=tpar;
+    }
+
+   GsString extra;
+   extra.setf ( "speedup=%.2fx", totnew>0? totold/totnew:0.0 );
+   bench_report ( "obj_load", "all:gsinput", reps, totold );
+   bench_report ( "obj_load", "all:mapped", reps, totnew, extra );
+   extra.setf ( "threads=%d speedup=%.2fx", gs_parallel_threads(), totpar>0? totnew/totpar:0.0 );
+   bench_report ( "obj_load", "all:chunked", reps, totpar, extra );
+ }
+
+// Compares text loading with loading from the binary .gsmb cache format
+void bench_gsmb_load ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   const char* tmpfile = "gsbench_tmp.gsmb";
+
+   const int reps = 5;
+   double totobj=0, totbin=0;
+   int i, r;
+   for ( i=0; i<files.size(); i++ )
+    { GsModel mobj, mbin;
+      const char* fname = gs_filename ( files[i] );
+
+      double t0 = bench_time();
+      for ( r=0; r<reps; r++ ) mobj.load_obj ( files[i] );
+      double tobj = bench_time()-t0;
+
+      if ( !mobj.save_gsmb(tmpfile) ) { printf ( "could not write %s\n", tmpfile ); return; }
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ ) mbin.load_gsmb ( tmpfile );
+      double tbin = bench_time()-t0;
+
+      GsString msg, extra, name;
+      bool same = bench_same_model ( mobj, mbin, &msg );
+      extra.setf ( "bytes=%u speedup=%.2fx %s", gs_size(tmpfile), tbin>0? tobj/tbin:0.0, same? "identical":msg.pt() );
+      name.setf ( "%s:obj", fname );  bench_report ( "gsmb_load", name, reps, tobj );
+      name.setf ( "%s:gsmb", fname ); bench_report ( "gsmb_load", name, reps, tbin, extra );
+      totobj+=tobj; totbin+=tbin;
+    }
+   remove ( tmpfile );
+
+   GsString extra;
+   extra.setf ( "speedup=%.2fx", totbin>0? totobj/totbin:0.0 );
+   bench_report ( "gsmb_load", "all:obj", reps, totobj );
+   bench_report ( "gsmb_load", "all:gsmb", reps, totbin, extra );
+ }
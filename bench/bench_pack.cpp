@@ -0,0 +1,85 @@
+
+# include <stdio.h>
+# include <math.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_pack.h>
+# include "bench.h"
+
+// Times the packing of positions in half floats relative to the bounds and of
+// normals in the 10:10:10:2 format, as done by SoModel for its interleaved
+// formats, with one call per value and with the batch functions. Also gives
+// the precision of the packed values with respect to the float data.
+void bench_vertex_pack ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+
+   const int reps = 20;
+   int i, r;
+   for ( i=0; i<files.size(); i++ )
+    { GsModel m;
+      m.load_obj ( files[i] );
+      if ( m.F.size()==0 ) continue;
+      const char* fname = gs_filename ( files[i] );
+
+      GsArray<GsVec> P, N;
+      m.get_face_vertices ( P );
+      m.get_face_normals ( N );
+      int n = P.size();
+
+      // positions relative to the bounds, as in SoModel:
+      GsVec a=P[0], b=P[0];
+      for ( int k=1; k<n; k++ )
+       { GS_UPDMIN(a.x,P[k].x); GS_UPDMAX(b.x,P[k].x);
+         GS_UPDMIN(a.y,P[k].y); GS_UPDMAX(b.y,P[k].y);
+         GS_UPDMIN(a.z,P[k].z); GS_UPDMAX(b.z,P[k].z);
+       }
+      GsVec c = (a+b)/2.0f;
+      float radius = GS_MAX3 ( b.x-c.x, b.y-c.y, b.z-c.z );
+      if ( radius<=0 ) radius=1.0f;
+      GsArray<float> rel ( 3*n );
+      for ( int k=0; k<n; k++ )
+       { GsVec v = (P[k]-c)/radius;
+         rel[3*k]=v.x; rel[3*k+1]=v.y; rel[3*k+2]=v.z;
+       }
+
+      GsArray<gsuint16> h1(3*n), h2(3*n);
+      GsArray<gsuint32> n1(n), n2(n);
+
+      double t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       { for ( int k=0; k<3*n; k++ ) h1[k] = gs_float_to_half ( rel[k] );
+         for ( int k=0; k<n; k++ ) n1[k] = gs_pack_normal ( N[k] );
+       }
+      double tscalar = bench_time()-t0;
+
+      t0 = bench_time();
+      for ( r=0; r<reps; r++ )
+       { gs_floats_to_halfs ( rel.pt(), h2.pt(), 3*n );
+         gs_pack_normals ( N.pt(), n2.pt(), n );
+       }
+      double tbatch = bench_time()-t0;
+
+      // precision of the decoded values:
+      bool same = true;
+      float perr=0, nerr=0;
+      for ( int k=0; k<n; k++ )
+       { if ( n1[k]!=n2[k] || h1[3*k]!=h2[3*k] || h1[3*k+1]!=h2[3*k+1] || h1[3*k+2]!=h2[3*k+2] ) same=false;
+         GsVec p ( gs_half_to_float(h2[3*k]), gs_half_to_float(h2[3*k+1]), gs_half_to_float(h2[3*k+2]) );
+         GS_UPDMAX ( perr, dist(p*radius+c,P[k])/radius );
+         GsVec u = gs_unpack_normal ( n2[k] );
+         float len = N[k].len();
+         if ( len>0 ) GS_UPDMAX ( nerr, angle(u,N[k]) );
+       }
+
+      GsString name, extra;
+      extra.setf ( "V=%d ns_per_vertex=%.2f", n, tscalar*1.0e9/double(reps)/double(n) );
+      name.setf ( "%s:scalar", fname );
+      bench_report ( "vertex_pack", name, reps, tscalar, extra );
+      extra.setf ( "V=%d ns_per_vertex=%.2f speedup=%.2fx poserr=%.2e*radius normalerr=%.3fdeg %s", n,
+                   tbatch*1.0e9/double(reps)/double(n), tbatch>0? tscalar/tbatch:0.0, perr,
+                   GS_TODEG(nerr), same? "same_as_scalar":"DIFFERENT" );
+      name.setf ( "%s:batch", fname );
+      bench_report ( "vertex_pack", name, reps, tbatch, extra );
+    }
+ }
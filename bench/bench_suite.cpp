@@ -0,0 +1,224 @@
+
+# include <stdio.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_quat.h>
+# include <gsim/gs_image.h>
+# include <gsim/gs_strings.h>
+# include <gsim/gs_tree.h>
+# include "bench.h"
+
+// Benchmarks of the gsim hot paths run by "gsbench suite" together with the
+// mat and curve_eval groups. They have no previous implementation to compare
+// with: each case is repeated with bench_repeat() over the same fixture so
+// that its time per repetition can be tracked between versions.
+
+// copies only the arrays used by the operations below, with the material
+// names since remove_redundant_materials() keeps them matching M
+static void copy_model ( const GsModel& a, GsModel& b )
+ {
+   b.init ();
+   b.V = a.V;
+   b.F = a.F;
+   b.N = a.N;
+   b.Fn = a.Fn;
+   b.M = a.M;
+   b.Fm = a.Fm;
+   b.mtlnames = a.mtlnames;
+ }
+
+// Loading and clean up operations of GsModel over the models directory
+void bench_model_ops ()
+ {
+   GsStrings files;
+   bench_list_files ( bench_models_dir, "obj", files );
+   if ( files.size()==0 ) { printf ( "no .obj files found in %s\n", bench_models_dir ); return; }
+
+   GsString name, extra;
+   for ( int i=0; i<files.size(); i++ )
+    { GsModel fixture, m;
+      const char* fname = gs_filename ( files[i] );
+      fixture.load_obj ( files[i] );
+      if ( fixture.F.size()==0 ) continue;
+      double secs;
+      int reps;
+
+      reps = bench_repeat ( [&] { m.load_obj(files[i]); }, secs );
+      extra.setf ( "V=%d F=%d", fixture.V.size(), fixture.F.size() );
+      name.setf ( "%s:load_obj", fname ); bench_report ( "model_ops", name, reps, secs, extra );
+
+      reps = bench_repeat ( [&] { copy_model(fixture,m); m.N.size(0); m.Fn.size(0); }, [&] { m.smooth(); }, secs );
+      extra.setf ( "N=%d", m.N.size() );
+      name.setf ( "%s:smooth", fname ); bench_report ( "model_ops", name, reps, secs, extra );
+
+      reps = bench_repeat ( [&] { copy_model(fixture,m); }, [&] { m.merge_redundant_vertices(); }, secs );
+      extra.setf ( "V=%d->%d", fixture.V.size(), m.V.size() );
+      name.setf ( "%s:merge_vertices", fname ); bench_report ( "model_ops", name, reps, secs, extra );
+
+      if ( fixture.N.size()>0 )
+       { reps = bench_repeat ( [&] { copy_model(fixture,m); }, [&] { m.remove_redundant_normals(); }, secs );
+         extra.setf ( "N=%d->%d", fixture.N.size(), m.N.size() );
+         name.setf ( "%s:remove_normals", fname ); bench_report ( "model_ops", name, reps, secs, extra );
+       }
+
+      if ( fixture.M.size()>0 )
+       { reps = bench_repeat ( [&] { copy_model(fixture,m); }, [&] { m.remove_redundant_materials(); }, secs );
+         extra.setf ( "M=%d->%d", fixture.M.size(), m.M.size() );
+         name.setf ( "%s:remove_materials", fname ); bench_report ( "model_ops", name, reps, secs, extra );
+       }
+    }
+ }
+
+// Quaternion interpolation between random orientations, which uses the
+// spherical factors, and between close ones, which uses the linear factors
+void bench_quat ()
+ {
+   const int n=1024, steps=16;
+   int i;
+   gs_rseed ( 1 );
+   GsArray<GsQuat> A(n), B(n), C(n), R(n);
+   for ( i=0; i<n; i++ )
+    { A[i].random(); B[i].random();
+      C[i] = A[i] * GsQuat ( GsVec(gs_random(-1.0f,1.0f),gs_random(-1.0f,1.0f),1.0f), gs_random(-0.1f,0.1f) );
+    }
+
+   GsString extra;
+   double secs;
+   const GsArray<GsQuat>* targets[] = { &B, &C };
+   const char* names[] = { "slerp:random", "slerp:near" };
+   for ( int c=0; c<2; c++ )
+    { const GsArray<GsQuat>& T = *targets[c];
+      int reps = bench_repeat ( [&]
+       { for ( int s=0; s<steps; s++ )
+          { float t = float(s)/float(steps-1);
+            for ( int k=0; k<n; k++ ) gslerp ( A[k].e, T[k].e, t, R[k].e );
+          }
+       }, secs );
+      extra.setf ( "ns_per_op=%.2f", secs*1.0e9/(double(reps)*n*steps) );
+      bench_report ( "quat", names[c], reps, secs, extra );
+    }
+ }
+
+// Loads the bmp images of the texture folder and a generated image
+void bench_image_load ()
+ {
+   GsStrings files;
+   bench_list_files ( "texture/", "bmp", files );
+
+   const char* tmpfile = "gsbench_tmp.bmp";
+   GsImage img;
+   img.init ( 1023, 767 ); // width not multiple of 4 to have padded lines
+   for ( int l=0; l<img.h(); l++ )
+    for ( int c=0; c<img.w(); c++ ) img(l,c).set ( l%256, c%256, (l+c)%256 );
+   if ( img.save(tmpfile) ) files.push ( tmpfile );
+
+   GsString extra;
+   for ( int i=0; i<files.size(); i++ )
+    { double secs;
+      int reps = bench_repeat ( [&] { img.load(files[i]); }, secs );
+      double mb = double(gs_size(files[i]))/(1024.0*1024.0);
+      extra.setf ( "%dx%d MB_per_s=%.1f", img.w(), img.h(), secs>0? mb*reps/secs:0.0 );
+      bench_report ( "image_load", gs_filename(files[i]), reps, secs, extra );
+    }
+   remove ( tmpfile );
+ }
+
+// The GsArray and GsStrings paths which move or reallocate data
+void bench_array ()
+ {
+   const int n=1<<20, ni=20000, nsort=1<<17, nstr=1<<16;
+   int i;
+   gs_rseed ( 1 );
+   GsArray<int> keys(n);
+   for ( i=0; i<n; i++ ) keys[i]=gs_random(0,n);
+
+   GsArray<int> a;
+   GsString extra;
+   double secs;
+   int reps;
+
+   reps = bench_repeat ( [&] { a.capacity(0); for ( int k=0; k<n; k++ ) a.push()=k; }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f", n, secs*1.0e9/(double(reps)*n) );
+   bench_report ( "array", "push", reps, secs, extra );
+
+   reps = bench_repeat ( [&] { a.size(0); for ( int k=0; k<n; k++ ) a.push()=k; }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f", n, secs*1.0e9/(double(reps)*n) );
+   bench_report ( "array", "push:reserved", reps, secs, extra );
+
+   reps = bench_repeat ( [&] { a.capacity(0); for ( int k=0; k<ni; k++ ) a.insert(k/2)=k; }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f", ni, secs*1.0e9/(double(reps)*ni) );
+   bench_report ( "array", "insert:middle", reps, secs, extra );
+
+   reps = bench_repeat ( [&] { a.capacity(0); for ( int k=0; k<ni; k++ ) a.insort(keys[k],gs_compare); }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f", ni, secs*1.0e9/(double(reps)*ni) );
+   bench_report ( "array", "insort", reps, secs, extra );
+
+   reps = bench_repeat ( [&] { a.size(nsort); for ( int k=0; k<nsort; k++ ) a[k]=keys[k]; }, [&] { a.sort(gs_compare); }, secs );
+   extra.setf ( "n=%d ns_per_elem=%.2f", nsort, secs*1.0e9/(double(reps)*nsort) );
+   bench_report ( "array", "sort", reps, secs, extra );
+
+   int found=0;
+   reps = bench_repeat ( [&] { found=0; for ( int k=0; k<nsort; k++ ) if ( a.bsearch(keys[n-1-k],gs_compare)>=0 ) found++; }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f found=%d", nsort, secs*1.0e9/(double(reps)*nsort), found );
+   bench_report ( "array", "bsearch", reps, secs, extra );
+
+   // strings are moved, not copied, when the array grows:
+   GsStrings strings;
+   reps = bench_repeat ( [&] { strings.capacity(0); for ( int k=0; k<nstr; k++ ) strings.push("material"); }, secs );
+   extra.setf ( "n=%d ns_per_op=%.2f", nstr, secs*1.0e9/(double(reps)*nstr) );
+   bench_report ( "array", "strings:push", reps, secs, extra );
+ }
+
+struct KeyNode : public GsTreeNode
+ { int key;
+   KeyNode ( int k=0 ) : key(k) {}
+   friend GsOutput& operator<< ( GsOutput& o, const KeyNode& n ) { return o<<n.key; }
+   friend GsInput& operator>> ( GsInput& i, KeyNode& n ) { return i>>n.key; }
+   static int compare ( const KeyNode* a, const KeyNode* b ) { return a->key-b->key; }
+ };
+
+// Inserts, iterates and destroys a GsTree of n nodes with the default
+// manager, which allocates each node with new, and with GsPoolManager
+void bench_tree ()
+ {
+   const int n=1<<18;
+   int i;
+   gs_rseed ( 1 );
+   GsArray<int> keys(n);
+   for ( i=0; i<n; i++ ) keys[i]=i;
+   for ( i=n-1; i>0; i-- ) { int j=gs_random(0,i); int k=keys[i]; keys[i]=keys[j]; keys[j]=k; }
+
+   GsPoolManager<KeyNode> pool;
+   GsTree<KeyNode> newtree, pooltree(&pool);
+   const char* names[] = { "new", "pool" };
+   double ns[2][3];
+   GsString name, extra;
+   double secs;
+   int reps;
+
+   for ( int c=0; c<2; c++ )
+    { GsTree<KeyNode>& t = c==0? newtree : pooltree;
+      auto build = [&]
+       { for ( int k=0; k<n; k++ ) t.insert ( c==0? new KeyNode(keys[k]) : pool.create(keys[k]) ); };
+
+      reps = bench_repeat ( [&] { t.init(); }, build, secs );
+      ns[c][0] = secs*1.0e9/(double(reps)*n);
+      name.setf ( "insert:%s", names[c] );
+      extra.setf ( "n=%d ns_per_node=%.2f", n, ns[c][0] );
+      bench_report ( "tree", name, reps, secs, extra );
+
+      gsuint64 sum=0;
+      reps = bench_repeat ( [&] { sum=0; for ( t.gofirst(); t.cur()!=GsTreeNode::null; t.gonext() ) sum+=t.cur()->key; }, secs );
+      ns[c][1] = secs*1.0e9/(double(reps)*n);
+      name.setf ( "iterate:%s", names[c] );
+      extra.setf ( "n=%d ns_per_node=%.2f sum=%llu", n, ns[c][1], (unsigned long long)sum );
+      bench_report ( "tree", name, reps, secs, extra );
+
+      reps = bench_repeat ( [&] { t.init(); build(); }, [&] { t.init(); }, secs );
+      ns[c][2] = secs*1.0e9/(double(reps)*n);
+      name.setf ( "destroy:%s", names[c] );
+      if ( c==0 ) extra.setf ( "n=%d ns_per_node=%.2f", n, ns[c][2] );
+       else extra.setf ( "n=%d ns_per_node=%.2f speedup=%.2fx/%.2fx/%.2fx blocks=%d", n, ns[c][2],
+                         ns[0][0]/ns[1][0], ns[0][1]/ns[1][1], ns[0][2]/ns[1][2], int(pool.allocations()) );
+      bench_report ( "tree", name, reps, secs, extra );
+    }
+ }
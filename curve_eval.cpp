@@ -1,3 +1,4 @@
+# include <gsim/gs_mat.h>
 # include "curve_eval.h"
 
 int factorial(int n)
@@ -16,17 +17,76 @@ float binomial_coff(float n, float k)
 	return ans;
 }
 
+// C(n,k) from C(n,k-1), exact for the degrees of the table
+static constexpr float binomial(int n, int k) {
+	return k < 0 || k > n ? 0.0f : k == 0 ? 1.0f : binomial(n, k - 1)*float(n - k + 1) / float(k);
+}
+
+# define BINOMIAL_ROW(n) { binomial(n,0), binomial(n,1), binomial(n,2), binomial(n,3), \
+	binomial(n,4), binomial(n,5), binomial(n,6), binomial(n,7), binomial(n,8), binomial(n,9), \
+	binomial(n,10), binomial(n,11), binomial(n,12), binomial(n,13), binomial(n,14), binomial(n,15) }
+
+static constexpr float Binomials[BezierMaxDegree + 1][BezierMaxDegree + 1] = {
+	BINOMIAL_ROW(0), BINOMIAL_ROW(1), BINOMIAL_ROW(2), BINOMIAL_ROW(3),
+	BINOMIAL_ROW(4), BINOMIAL_ROW(5), BINOMIAL_ROW(6), BINOMIAL_ROW(7),
+	BINOMIAL_ROW(8), BINOMIAL_ROW(9), BINOMIAL_ROW(10), BINOMIAL_ROW(11),
+	BINOMIAL_ROW(12), BINOMIAL_ROW(13), BINOMIAL_ROW(14), BINOMIAL_ROW(15)
+};
+
+# undef BINOMIAL_ROW
+
 GsVec eval_bezier(float t, const GsArray<GsVec>& ctrlpnts) {
-	GsVec P;
-	P.x = 0; P.y = 0; P.z = 0;
-	int size = ctrlpnts.size();
-	for (int i = 0; i<size; i++)
-	{
-		P.x = P.x + binomial_coff((float)(size-1), (float)i) * pow(t, (double)i) * pow((1 - t), (size-1 - i)) * ctrlpnts[i].x;
-		P.y = P.y + binomial_coff((float)(size-1), (float)i) * pow(t, (double)i) * pow((1 - t), (size-1 - i)) * ctrlpnts[i].y;
-		P.z = P.z + binomial_coff((float)(size - 1), (float)i) * pow(t, (double)i) * pow((1 - t), (size - 1 - i)) * ctrlpnts[i].z;
+	return eval_bezier(t, ctrlpnts.pt(), ctrlpnts.size());
+}
+
+GsVec eval_bezier(float t, const GsVec* ctrlpnts, int n) {
+	if (n <= 0) return GsVec::null;
+	int d = n - 1;
+
+	// sum of C(d,i) s^i (1-s)^(d-i) Q[i] as (1-s)^d times a polynomial in r=s/(1-s),
+	// where s is the smallest of t and 1-t so that r<=1, and Q is reversed when s=1-t:
+	bool rev = t > 0.5f;
+	float s = rev ? 1.0f - t : t;
+	float r = s / (1.0f - s);
+	const float* c = d <= BezierMaxDegree ? Binomials[d] : 0;
+	float cj = 1.0f;
+	GsVec P = ctrlpnts[rev ? 0 : d];
+	for (int j = d - 1; j >= 0; j--) {
+		cj = c ? c[j] : cj*float(j + 1) / float(d - j); // C(d,j) from C(d,j+1) above the table
+		P = P*r + cj*ctrlpnts[rev ? d - j : j];
+	}
+	float f = 1.0f;
+	for (int i = 0; i < d; i++) f *= 1.0f - s;
+	return P*f;
+}
+
+void BezierBasis::set(int degree, int samples) {
+	_degree = degree;
+	_samples = samples;
+	int m = degree + 1;
+	_w.size(m*samples);
+	for (int j = 0; j < samples; j++) {
+		double t = samples > 1 ? double(j) / double(samples - 1) : 0.0;
+		double c = 1.0; // C(degree,i)
+		for (int i = 0; i < m; i++) {
+			_w[j*m + i] = float(c*pow(t, i)*pow(1.0 - t, degree - i));
+			c = c*double(degree - i) / double(i + 1);
+		}
+	}
+}
+
+void BezierBasis::eval(const GsVec* p, GsVec* out) const {
+	int m = _degree + 1;
+	const float* w = _w.pt();
+	for (int j = 0; j < _samples; j++, w += m) {
+		float x = 0, y = 0, z = 0;
+		for (int i = 0; i < m; i++) {
+			x += w[i] * p[i].x;
+			y += w[i] * p[i].y;
+			z += w[i] * p[i].z;
+		}
+		out[j].set(x, y, z);
 	}
-	return P;
 }
 
 GsVec eval_lagrange(float t, const GsArray<GsVec>& ctrlpntsn) {
@@ -48,10 +108,34 @@ GsVec eval_lagrange(float t, const GsArray<GsVec>& ctrlpntsn) {
 	return P;
 }
 
+// the k basis functions not null in a span of uniform knots, at the fraction f
+// of the span, which multiply points s-k+1,...,s for the span [s,s+1); all the
+// knot differences in the denominators of the recurrence are equal to j
+static void uniform_basis(float f, int k, float* N) {
+	N[0] = 1.0f;
+	for (int j = 1; j < k; j++) {
+		float inv = 1.0f / float(j), saved = 0;
+		for (int r = 0; r < j; r++) {
+			float temp = N[r] * inv;
+			N[r] = saved + (float(r + 1) - f)*temp;
+			saved = (f + float(j - r - 1))*temp;
+		}
+		N[j] = saved;
+	}
+}
+
+// same result as the sum of N(i,k,t) for all points, for any t
 GsVec eval_bspline(float t, int k, const GsArray<GsVec>& pnts) {
 	GsVec P;
-	for (int i = 0; i < pnts.size(); i++) {
-		P += pnts[i] * N(i, k, t);
+	int n = pnts.size();
+	if (k < 1 || !(t >= 0) || t >= float(n + k - 1)) return P;
+	float buf[16]; GsArray<float> heap;
+	float* Nk = k <= 16 ? buf : (heap.size(k), heap.pt());
+	int s = int(t);
+	uniform_basis(t - float(s), k, Nk);
+	for (int r = 0; r < k; r++) {
+		int i = s - k + 1 + r;
+		if (i >= 0 && i < n) P += pnts[i] * Nk[r];
 	}
 	return P;
 }
@@ -64,30 +148,235 @@ float N(int i, int k, float u) {
 		return ((u - ui) / (k - 1))*N(i, k - 1, u) + ((ui + k - u) / (k - 1)) * N(i + 1, k - 1, u);
 }
 
-GsVec crspline(float t, const const GsArray<GsVec>& pnts) {
+GsVec crspline(float t, const GsArray<GsVec>& pnts) {
 	GsVec P = 0.5*((2 * pnts[1]) + (-pnts[0] + pnts[2])*t + (2 * pnts[0] - 5 * pnts[1] + 4 * pnts[2] - pnts[3])*t*t + (-pnts[0] + 3 * pnts[1] - 3 * pnts[2] + pnts[3])*t*t*t);
 	return P;
 }
 
 GsVec bospline(float t, const GsArray<GsVec>& pnts) {
-	//GsVec P;
+	GsVec bez[4];
+	bospline_controls(pnts.pt(), bez);
+	return eval_bezier(t, bez, 4);
+}
+
+void bospline_controls(const GsVec* pnts, GsVec* bez) {
 	//Calculate two points for point 1
+	//(coincident points have null directions instead of divisions by zero)
 	float d1 = dist(pnts[1], pnts[0]);
 	float d2 = dist(pnts[2], pnts[1]);
-	GsVec v1 = (pnts[1] - pnts[0]) / d1;
-	GsVec v2 = (pnts[2] - pnts[1]) / d2;
-	GsVec vi = (d2*v1 + d1*v2) / (d1 + d2);
+	GsVec v1 = d1 > 0 ? (pnts[1] - pnts[0]) / d1 : GsVec::null;
+	GsVec v2 = d2 > 0 ? (pnts[2] - pnts[1]) / d2 : GsVec::null;
+	GsVec vi = d1 + d2 > 0 ? (d2*v1 + d1*v2) / (d1 + d2) : GsVec::null;
 
 	//GsVec P1 = pnts[1] - (1.0f / 3.0f)*d1*vi;
 	GsVec P2 = pnts[1] + (1.0f / 3.0f)*d2*vi;
 
 	//Calculate two points for point 2
 	float d3 = dist(pnts[3], pnts[2]);
-	GsVec v3 = (pnts[3] - pnts[2]) / d3;
-	GsVec vi2 = (d3*v2 + d2*v3) / (d2 + d3);
+	GsVec v3 = d3 > 0 ? (pnts[3] - pnts[2]) / d3 : GsVec::null;
+	GsVec vi2 = d2 + d3 > 0 ? (d3*v2 + d2*v3) / (d2 + d3) : GsVec::null;
 	GsVec P3 = pnts[2] - (1.0f / 3.0f)*d2*vi2;
 	//GsVec P4 = pnts[2] + (1.0f / 3.0f)*d3*vi2;
 
-	GsArray<GsVec> bez; bez.push() = pnts[1]; bez.push() = P2; bez.push() = P3; bez.push() = pnts[2];
-	return eval_bezier(t, bez);
-}
\ No newline at end of file
+	bez[0] = pnts[1]; bez[1] = P2; bez[2] = P3; bez[3] = pnts[2];
+}
+
+void bospline_samples(const GsVec* pnts, const BezierBasis& basis, GsVec* out) {
+	GsVec bez[4];
+	bospline_controls(pnts, bez);
+	basis.eval(bez, out);
+}
+
+// recursive subdivision of bospline_adaptive(), with the deviation measured
+// in world units, or in pixels when proj is not null
+struct AdaptiveSegment {
+	GsVec bez[4];
+	float maxdev;
+	const GsMat* proj;
+	float w, h;
+	int maxdepth;
+	GsArray<GsVec>* out;
+
+	// position in pixels, or false if behind the viewer
+	bool screen(const GsVec& p, GsVec& s) const {
+		const GsMat& m = *proj;
+		float cw = m.e41*p.x + m.e42*p.y + m.e43*p.z + m.e44;
+		if (cw <= 0) return false;
+		s = m*p;
+		s.set((s.x + 1.0f)*0.5f*w, (s.y + 1.0f)*0.5f*h, 0);
+		return true;
+	}
+
+	// distance of p to the segment [a,b]
+	static float deviation(const GsVec& p, const GsVec& a, const GsVec& b) {
+		GsVec ab = b - a;
+		float l2 = dot(ab, ab);
+		float t = l2 > 0 ? dot(p - a, ab) / l2 : 0;
+		t = GS_BOUND(t, 0.0f, 1.0f);
+		return dist(p, a + ab*t);
+	}
+
+	bool flat(const GsVec& p0, const GsVec& pm, const GsVec& p1) const {
+		if (!proj) return deviation(pm, p0, p1) <= maxdev;
+		GsVec s0, sm, s1;
+		if (!screen(p0, s0) || !screen(pm, sm) || !screen(p1, s1)) return true;
+		return deviation(sm, s0, s1) <= maxdev;
+	}
+
+	// appends the samples in [t0,t1), p0 being the point at t0
+	void split(float t0, const GsVec& p0, float t1, const GsVec& p1, int depth) {
+		float tm = (t0 + t1)*0.5f;
+		GsVec pm = eval_bezier(tm, bez, 4);
+		if (depth >= maxdepth || (depth >= 2 && flat(p0, pm, p1))) { out->push() = p0; return; }
+		split(t0, p0, tm, pm, depth + 1);
+		split(tm, pm, t1, p1, depth + 1);
+	}
+
+	int tessellate(const GsVec* pnts, bool last) {
+		int n = out->size();
+		bospline_controls(pnts, bez);
+		split(0, bez[0], 1.0f, bez[3], 0);
+		if (last) out->push() = bez[3];
+		return out->size() - n;
+	}
+};
+
+int bospline_adaptive(const GsVec* pnts, float maxdev, GsArray<GsVec>& out, bool last, int maxdepth) {
+	AdaptiveSegment a;
+	a.maxdev = maxdev; a.proj = 0; a.w = a.h = 0; a.maxdepth = maxdepth; a.out = &out;
+	return a.tessellate(pnts, last);
+}
+
+int bospline_adaptive(const GsVec* pnts, float maxpixels, const GsMat& viewproj, float w, float h,
+	GsArray<GsVec>& out, bool last, int maxdepth) {
+	AdaptiveSegment a;
+	a.maxdev = maxpixels; a.proj = &viewproj; a.w = w; a.h = h; a.maxdepth = maxdepth; a.out = &out;
+	return a.tessellate(pnts, last);
+}
+
+void BSpline::uniform(int order, int n) {
+	_order = order;
+	_n = n;
+	_uniform = true;
+	_knots.size(n + order);
+	for (int i = 0; i < _knots.size(); i++) _knots[i] = float(i);
+}
+
+void BSpline::knots(int order, int n, const float* u) {
+	_order = order;
+	_n = n;
+	_uniform = false;
+	_knots.size(n + order);
+	for (int i = 0; i < _knots.size(); i++) _knots[i] = u[i];
+}
+
+int BSpline::span(float u) const {
+	int a = _order - 1, b = _n - 1;
+	if (_uniform) {
+		int s = GS_FLOOR(u);
+		return s < a ? a : s > b ? b : s;
+	}
+	// binary search of the last knot in [a,b] not after u:
+	if (u >= _knots[b]) return b;
+	while (b - a > 1) {
+		int m = (a + b) / 2;
+		if (_knots[m] <= u) a = m; else b = m;
+	}
+	return a;
+}
+
+void BSpline::basis(int s, float u, float* N) const {
+	if (_uniform) { uniform_basis(u - float(s), _order, N); return; }
+	const float* U = _knots.pt();
+	N[0] = 1.0f;
+	for (int j = 1; j < _order; j++) {
+		float saved = 0;
+		for (int r = 0; r < j; r++) {
+			float right = U[s + r + 1] - u, left = u - U[s + 1 - j + r];
+			float temp = right + left > 0 ? N[r] / (right + left) : 0; // repeated knots
+			N[r] = saved + right*temp;
+			saved = left*temp;
+		}
+		N[j] = saved;
+	}
+}
+
+GsVec BSpline::eval(float u, const GsVec* pnts) const {
+	GsVec P;
+	if (_n < _order || _order < 1) return P;
+	float buf[16]; GsArray<float> heap;
+	float* N = _order <= 16 ? buf : (heap.size(_order), heap.pt());
+	u = GS_BOUND(u, start(), end());
+	int s = span(u);
+	basis(s, u, N);
+	pnts += s - _order + 1;
+	for (int r = 0; r < _order; r++) P += pnts[r] * N[r];
+	return P;
+}
+
+void BSpline::eval(const float* u, int m, const GsVec* pnts, GsVec* out) const {
+	const int W = Lanes;
+	const int k = _order;
+	if (_n < k || k < 1) { for (int i = 0; i < m; i++) out[i] = GsVec::null; return; }
+	float buf[16 * W]; GsArray<float> heap;
+	float* N = k <= 16 ? buf : (heap.size(k*W), heap.pt()); // basis r of lane l in N[r*W+l]
+	const float* U = _knots.pt();
+	float a = start(), b = end();
+	float v[W], f[W], saved[W];
+	int s[W];
+
+	for (int i = 0; i < m; i += W) {
+		int w = GS_MIN(W, m - i);
+		for (int l = 0; l < W; l++) {
+			v[l] = l < w ? u[i + l] : a; // unused lanes evaluate the start
+			v[l] = GS_BOUND(v[l], a, b);
+			s[l] = span(v[l]);
+		}
+
+		// the recurrence of basis() for all lanes at once:
+		for (int l = 0; l < W; l++) { N[l] = 1.0f; f[l] = v[l] - float(s[l]); }
+		for (int j = 1; j < k; j++) {
+			for (int l = 0; l < W; l++) saved[l] = 0;
+			for (int r = 0; r < j; r++) {
+				float* Nr = N + r*W;
+				if (_uniform) {
+					float inv = 1.0f / float(j), cr = float(r + 1), cl = float(j - r - 1);
+					for (int l = 0; l < W; l++) {
+						float temp = Nr[l] * inv;
+						Nr[l] = saved[l] + (cr - f[l])*temp;
+						saved[l] = (f[l] + cl)*temp;
+					}
+				} else {
+					for (int l = 0; l < W; l++) {
+						float right = U[s[l] + r + 1] - v[l], left = v[l] - U[s[l] + 1 - j + r];
+						float temp = right + left > 0 ? Nr[l] / (right + left) : 0;
+						Nr[l] = saved[l] + right*temp;
+						saved[l] = left*temp;
+					}
+				}
+			}
+			for (int l = 0; l < W; l++) N[j*W + l] = saved[l];
+		}
+
+		for (int l = 0; l < w; l++) {
+			const GsVec* P = pnts + s[l] - k + 1;
+			float x = 0, y = 0, z = 0;
+			for (int r = 0; r < k; r++) {
+				float c = N[r*W + l];
+				x += c*P[r].x; y += c*P[r].y; z += c*P[r].z;
+			}
+			out[i + l].set(x, y, z);
+		}
+	}
+}
+
+void BSpline::tessellate(const GsVec* pnts, int m, GsVec* out) const {
+	if (_n < _order || _order < 1) { for (int i = 0; i < m; i++) out[i] = GsVec::null; return; }
+	float u[Lanes];
+	float a = start(), d = m > 1 ? (end() - a) / float(m - 1) : 0;
+	for (int i = 0; i < m; i += Lanes) {
+		int w = GS_MIN(Lanes, m - i);
+		for (int l = 0; l < w; l++) u[l] = a + d*float(i + l);
+		eval(u, w, pnts, out + i);
+	}
+}
@@ -6,10 +6,11 @@
 # include <gsim/gs_color.h>
 # include <gsim/gs_array.h>
 # include <gsim/gs_vec.h>
-# include "ogl_tools.h"
 # include <math.h>
 # include <vector>
 
+class GsMat;
+
 
 int factorial(int n);
 float binomial_coff(float n, float k);
@@ -18,7 +19,83 @@ GsVec eval_lagrange(float t, const GsArray<GsVec>& ctrlpnts);
 double lagrange(int n, double t);
 GsVec eval_bspline(float t, int k, const GsArray<GsVec>& pnts);
 float N(int i, int k, float u);
-GsVec crspline(float t, const const GsArray<GsVec>& pnts);
+GsVec crspline(float t, const GsArray<GsVec>& pnts);
 GsVec bospline(float t, const GsArray<GsVec>& pnts);
 
+// Bezier evaluation without allocations: the binomial coefficients up to
+// BezierMaxDegree are taken from a table built at compile time, and the
+// Bernstein polynomials are evaluated with Horner's rule
+const int BezierMaxDegree = 15;
+GsVec eval_bezier(float t, const GsVec* ctrlpnts, int n);
+
+// Bernstein weights of a degree at samples equally spaced values of t in [0,1].
+// They are computed once and shared by all segments sampled the same way, so
+// that each sample only costs a weighted sum of the control points
+class BezierBasis {
+	GsArray<float> _w; // degree+1 weights per sample
+	int _degree, _samples;
+public:
+	BezierBasis() { _degree = _samples = 0; }
+	BezierBasis(int degree, int samples) { set(degree, samples); }
+	void set(int degree, int samples);
+	int degree() const { return _degree; }
+	int samples() const { return _samples; }
+	// fills out with the samples of the curve with the degree+1 control points p
+	void eval(const GsVec* p, GsVec* out) const;
+};
+
+// the 4 Bezier control points of the Bessel-Overhauser segment between pnts[1] and pnts[2]
+void bospline_controls(const GsVec* pnts, GsVec* bez);
+// fills out with the samples of the segment defined by the 4 points pnts, the basis must be cubic
+void bospline_samples(const GsVec* pnts, const BezierBasis& basis, GsVec* out);
+
+// Adaptive tessellation of the Bessel-Overhauser segment defined by the 4 points
+// pnts. The parameter range is split in 4 intervals, which are halved until the
+// curve point at the middle of each interval is within maxdev of the chord of
+// the interval, for at most maxdepth levels. The samples are appended to out,
+// except for the last one when last is false, so that segments can be chained.
+// Returns the number of samples appended.
+int bospline_adaptive(const GsVec* pnts, float maxdev, GsArray<GsVec>& out, bool last = true, int maxdepth = 10);
+// The same with the deviation measured in pixels, after projecting the points
+// with viewproj to a viewport of w x h pixels; intervals behind the viewer
+// are not split
+int bospline_adaptive(const GsVec* pnts, float maxpixels, const GsMat& viewproj, float w, float h,
+	GsArray<GsVec>& out, bool last = true, int maxdepth = 10);
+
+// B-spline of a given order k (degree k-1) over n control points, with its n+k
+// knots cached. Only the k basis functions not null in the knot span of a
+// parameter are evaluated, iteratively. The curve is defined in the parameter
+// range [knot(k-1),knot(n)], and parameters outside it are clamped.
+// With uniform knots 0,1,2,... the basis only depends on the fraction of the
+// parameter, and the batch evaluation is done in blocks of Lanes
+// parameters with loops over the block, which the compiler vectorizes.
+class BSpline {
+	GsArray<float> _knots;
+	int _order, _n;
+	bool _uniform;
+public:
+	static const int Lanes = 8;
+	BSpline() { _order = _n = 0; _uniform = true; }
+	BSpline(int order, int n) { uniform(order, n); }
+	// uniform knots 0,1,...,n+order-1, as used by N()
+	void uniform(int order, int n);
+	// the given n+order non decreasing knots
+	void knots(int order, int n, const float* u);
+	int order() const { return _order; }
+	int points() const { return _n; }
+	bool uniform() const { return _uniform; }
+	const GsArray<float>& knots() const { return _knots; }
+	float start() const { return _knots[_order - 1]; }
+	float end() const { return _knots[_n]; }
+	// index s of the knot span [knot(s),knot(s+1)) of u, in [k-1,n-1]
+	int span(float u) const;
+	// the k basis functions not null in span s, which multiply points s-k+1,...,s
+	void basis(int s, float u, float* N) const;
+	GsVec eval(float u, const GsVec* pnts) const;
+	// evaluates the m parameters u
+	void eval(const float* u, int m, const GsVec* pnts, GsVec* out) const;
+	// fills out with m samples equally spaced in the parameter range
+	void tessellate(const GsVec* pnts, int m, GsVec* out) const;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+
+# include <gsim/gs.h>
+# include "curve_frames.h"
+
+// unit tangent at point i from its neighbors, or null if they are all equal
+static GsVec point_tangent ( const GsVec* p, int n, int i )
+ {
+   GsVec t = p[i<n-1? i+1:i] - p[i>0? i-1:i];
+   float len = t.len();
+   return len>0? t/len : GsVec::null;
+ }
+
+void CurveFrames::build ( const GsVec* p, int n, const GsVec& up )
+ {
+   _t.size(n); _n.size(n); _b.size(n);
+   if ( n==0 ) return;
+
+   // first frame:
+   GsVec t = point_tangent ( p, n, 0 );
+   if ( t==GsVec::null ) t=GsVec::k;
+   GsVec r = up - t*dot(up,t);
+   if ( r.len()<1.0e-4f ) { r = GsVec::i - t*dot(GsVec::i,t); } // up is parallel to t
+   r.normalize();
+   _t[0]=t; _n[0]=r; _b[0]=cross(t,r);
+
+   // each frame is the previous one reflected by the plane bisecting the edge
+   // between the points, then by the plane bisecting the tangents:
+   for ( int i=0; i<n-1; i++ )
+    { GsVec ti = point_tangent ( p, n, i+1 );
+      if ( ti==GsVec::null ) ti=t;
+      GsVec v1 = p[i+1]-p[i];
+      float c1 = dot(v1,v1);
+      GsVec rl=r, tl=t;
+      if ( c1>0 )
+       { rl = r - v1*(2.0f*dot(v1,r)/c1);
+         tl = t - v1*(2.0f*dot(v1,t)/c1);
+       }
+      GsVec v2 = ti-tl;
+      float c2 = dot(v2,v2);
+      r = c2>0? rl - v2*(2.0f*dot(v2,rl)/c2) : rl;
+      t = ti;
+      r -= t*dot(r,t); // removes the accumulated error
+      r.normalize();
+      _t[i+1]=t; _n[i+1]=r; _b[i+1]=cross(t,r);
+    }
+ }
+
+void CurveFrames::frame ( int i, float f, GsVec& t, GsVec& n, GsVec& b ) const
+ {
+   int j = i+1<_t.size()? i+1:i;
+   t = _t[i] + (_t[j]-_t[i])*f;
+   n = _n[i] + (_n[j]-_n[i])*f;
+   t.normalize();
+   n -= t*dot(n,t);
+   n.normalize();
+   b = cross(t,n);
+ }
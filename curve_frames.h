@@ -0,0 +1,34 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef CURVE_FRAMES_H
+#define CURVE_FRAMES_H
+
+// Include needed header files
+# include <gsim/gs_vec.h>
+# include <gsim/gs_array.h>
+
+// Rotation minimizing frames at the points of a curve, computed in a single
+// pass with the double reflection method of Wang et al. (2008). Unlike Frenet
+// frames they do not flip at inflection points or become undefined on straight
+// parts. The tangents, normals and bitangents are kept in separate arrays
+// indexed as the points, so that reading a frame needs no computation.
+class CurveFrames
+ { private :
+    GsArray<GsVec> _t, _n, _b;
+   public :
+    // computes the frames of the n points p; the first normal is the direction
+    // closest to up which is orthogonal to the first tangent
+    void build ( const GsVec* p, int n, const GsVec& up=GsVec::j );
+    void build ( const GsArray<GsVec>& p, const GsVec& up=GsVec::j ) { build(p.pt(),p.size(),up); }
+    // removes the frames, keeping the memory for the next curve
+    void clear () { _t.clear(); _n.clear(); _b.clear(); }
+    int size () const { return _t.size(); }
+    const GsArray<GsVec>& tangents () const { return _t; }
+    const GsArray<GsVec>& normals () const { return _n; }
+    const GsArray<GsVec>& bitangents () const { return _b; }
+    // the frame at fraction f of the edge [i,i+1], interpolated and made
+    // orthonormal again; the bitangent is cross(t,n) and the normal cross(b,t)
+    void frame ( int i, float f, GsVec& t, GsVec& n, GsVec& b ) const;
+ };
+
+#endif // CURVE_FRAMES_H
@@ -0,0 +1,265 @@
+
+# include <gsim/gs.h>
+# include <gsim/gs_mat.h>
+# include "flight_sim.h"
+# include "curve_eval.h"
+
+const float FlightSim::SurfacesRate = 100.0f;
+const float FlightSim::SunRate = 1.0f;
+const float FlightSim::ManeuverRate = 100.0f;
+const float FlightSim::CurveSpeed = 40.0f;
+const float FlightSim::CurveTolerance = 0.001f;
+
+// The maneuvers are made of up to two segments rotating the airplane, each one
+// with a fraction of ManeuverRate as speed; a null speed ends the maneuver:
+struct ManeuverSegment { float pitch, roll, speed; };
+static const ManeuverSegment Maneuvers[][2] =
+ { { {    0,    0, 0    }, { 0,    0, 0 } }, // NoManeuver
+   { {  360,    0, 1.0f }, { 0,    0, 0 } }, // FrontFlip
+   { { -360,    0, 1.0f }, { 0,    0, 0 } }, // BackFlip
+   { {    0,  360, 1.0f }, { 0,    0, 0 } }, // BarrelRoll
+   { {    0, -360, 1.0f }, { 0,    0, 0 } }, // ReverseBarrelRoll
+   { {  360,    0, 0.5f }, { 0,  360, 1.0f } }, // FlipRoll
+   { { -360,    0, 0.5f }, { 0, -360, 1.0f } }, // ReverseFlipRoll
+   { {  180,  180, 1.0f }, { 0,    0, 0 } }  // HalfRollFlip
+ };
+
+FlightSim::FlightSim ( double dt )
+ {
+   _dt = dt;
+   _rseed = 1;
+   init ();
+ }
+
+void FlightSim::init ()
+ {
+   State& s = _cur;
+   s.pos = GsVec::null;
+   s.shadowpos = GsVec::null;
+   s.roll = s.pitch = s.yaw = 0;
+   s.wingr = s.wingl = s.backr = s.backl = 0;
+   s.sun = 0;
+   s.curving = false;
+   s.cpoint = GsVec::null;
+   s.cpos = GsVec::null;
+   s.ctangent = GsVec::k;
+   s.cnormal = GsVec::j;
+   s.cbitangent = GsVec::i;
+   _prev = _cur;
+
+   _acc = 0;
+   _time = 0;
+   _speed = 0;
+   _animsun = true;
+   _animsurf = _resetsurf = false;
+   _surfdir = 1.0f;
+   _maneuver = NoManeuver;
+   _segment = 0;
+   _segtime = 0;
+   _curve.clear();
+   _frames.clear();
+   _cdist = 0;
+   _curveid = 0;
+ }
+
+// integer in {min,...,max} from a linear congruential generator
+int FlightSim::random ( int min, int max )
+ {
+   _rseed = _rseed*1664525u + 1013904223u;
+   return min + int ( (_rseed>>8)%gsuint(max-min+1) );
+ }
+
+GsVec FlightSim::direction ( float roll, float pitch, float yaw )
+ {
+   GsMat leftright, updown, barrelroll;
+   leftright.roty ( GS_TORAD(yaw) );
+   updown.rotx ( GS_TORAD(pitch) );
+   barrelroll.rotz ( GS_TORAD(roll) );
+   return leftright*updown*barrelroll*GsVec::k;
+ }
+
+void FlightSim::step ( double dt )
+ {
+   float fdt = float(dt);
+   _prev = _cur;
+   State& s = _cur;
+
+   if ( _animsurf ) step_surfaces ( fdt );
+   if ( _animsun ) s.sun += SunRate*fdt;
+   if ( _maneuver!=NoManeuver ) step_maneuver ( fdt );
+
+   // the airplane follows the curve or flies forward:
+   if ( s.curving )
+    { _cdist += dt*double(CurveSpeed);
+      step_curve ();
+    }
+   else
+    { s.pos += direction(s.roll,s.pitch,s.yaw) * (_speed*fdt);
+    }
+
+   // the shadow only follows the heading:
+   s.shadowpos += direction(0,0,s.yaw) * (_speed*fdt);
+
+   _time += dt;
+ }
+
+int FlightSim::advance ( double elapsed )
+ {
+   if ( elapsed>0.25 ) elapsed=0.25; // long pauses are not recovered
+   if ( elapsed>0 ) _acc+=elapsed;
+   int n=0;
+   while ( _acc>=_dt ) { step(_dt); _acc-=_dt; n++; }
+   return n;
+ }
+
+FlightSim::State FlightSim::interpolate ( const State& a, const State& b, float t )
+ {
+   if ( a.curving!=b.curving ) return b;
+   State s = b;
+   s.pos = a.pos + (b.pos-a.pos)*t;
+   s.shadowpos = a.shadowpos + (b.shadowpos-a.shadowpos)*t;
+   s.roll = a.roll + (b.roll-a.roll)*t;
+   s.pitch = a.pitch + (b.pitch-a.pitch)*t;
+   s.yaw = a.yaw + (b.yaw-a.yaw)*t;
+   s.wingr = a.wingr + (b.wingr-a.wingr)*t;
+   s.wingl = a.wingl + (b.wingl-a.wingl)*t;
+   s.backr = a.backr + (b.backr-a.backr)*t;
+   s.backl = a.backl + (b.backl-a.backl)*t;
+   s.sun = a.sun + (b.sun-a.sun)*t;
+   if ( s.curving )
+    { s.cpoint = a.cpoint + (b.cpoint-a.cpoint)*t;
+      s.cpos = a.cpos + (b.cpos-a.cpos)*t;
+      s.ctangent = a.ctangent + (b.ctangent-a.ctangent)*t; s.ctangent.normalize();
+      s.cnormal = a.cnormal + (b.cnormal-a.cnormal)*t; s.cnormal.normalize();
+      s.cbitangent = a.cbitangent + (b.cbitangent-a.cbitangent)*t; s.cbitangent.normalize();
+    }
+   return s;
+ }
+
+bool FlightSim::active () const
+ {
+   return _speed!=0 || _animsun || _animsurf || _maneuver!=NoManeuver || _cur.curving;
+ }
+
+//================================ controls ================================
+
+// changes are applied to both states so that they are not interpolated
+void FlightSim::turn ( float droll, float dpitch, float dyaw )
+ {
+   _cur.roll+=droll; _cur.pitch+=dpitch; _cur.yaw+=dyaw;
+   _prev.roll+=droll; _prev.pitch+=dpitch; _prev.yaw+=dyaw;
+   if ( _cur.curving && (dpitch!=0 || dyaw!=0) ) exit_curve ();
+ }
+
+void FlightSim::move_surfaces ( float dwingr, float dwingl, float dbackr, float dbackl )
+ {
+   _cur.wingr+=dwingr; _cur.wingl+=dwingl; _cur.backr+=dbackr; _cur.backl+=dbackl;
+   _prev.wingr+=dwingr; _prev.wingl+=dwingl; _prev.backr+=dbackr; _prev.backl+=dbackl;
+ }
+
+void FlightSim::animate_surfaces ()
+ {
+   if ( !_animsurf ) { _animsurf=true; _resetsurf=false; }
+    else _resetsurf=true;
+ }
+
+void FlightSim::maneuver ( Maneuver m )
+ {
+   _maneuver = _maneuver==m? NoManeuver:m;
+   _segment = 0;
+   _segtime = 0;
+ }
+
+void FlightSim::gen_curve ()
+ {
+   GsVec start = _cur.curving? _cur.cpos : _cur.pos;
+
+   // control points: a random point, the current position and a point ahead,
+   // 10 random points, and the first 4 points again to close the curve:
+   GsSmallArray<GsVec,16> ctrl; // (no memory is allocated for these 15 points)
+   ctrl.push() = GsVec ( float(random(-10,9)), float(random(-10,9)), float(random(-3,16)) );
+   ctrl.push() = start;
+   ctrl.push() = GsVec ( start.x, start.y, start.z-0.5f );
+   for ( int i=0; i<10; i++ )
+    ctrl.push() = GsVec ( float(random(-10,9)), float(random(-10,9)), float(random(-3,16)) );
+   ctrl.push() = start;
+   GsVec p = ctrl[3]; // (push may reallocate the array)
+   ctrl.push() = p;
+
+   // the segments are sampled more densely where they bend:
+   int segs = ctrl.size()-3;
+   GsArray<GsVec>& pnts = _curve.points();
+   pnts.size ( 0 );
+   for ( int j=0; j<segs; j++ ) bospline_adaptive ( &ctrl[j], CurveTolerance, pnts, j==segs-1 );
+   _curve.build ( 1024 );
+   // the airplane is drawn with its up axis along the bitangent cross(t,n),
+   // which is closest to the vertical when n is closest to cross(j,t):
+   _frames.build ( pnts, cross(GsVec::j,pnts[1]-pnts[0]) );
+
+   _cdist = 0;
+   _curveid++;
+   _cur.curving = true;
+   step_curve ();
+ }
+
+void FlightSim::exit_curve ()
+ {
+   if ( !_cur.curving ) return;
+   _cur.curving = false;
+   _cur.pos = _cur.cpos;
+   _prev = _cur;
+   _curve.clear();
+   _frames.clear();
+ }
+
+//================================= steps ==================================
+
+void FlightSim::step_surfaces ( float dt )
+ {
+   State& s = _cur;
+   if ( (s.wingr>=45.0f && _surfdir>0) || (s.wingr<=-45.0f && _surfdir<0) ) _surfdir=-_surfdir;
+   float before = s.wingr;
+   float d = _surfdir*SurfacesRate*dt;
+   s.wingr+=d; s.wingl+=d; s.backr+=d; s.backl+=d;
+
+   // when asked to end, wait until the surfaces pass by zero:
+   if ( _resetsurf && before!=0 && before*s.wingr<=0 )
+    { float over = s.wingr;
+      s.wingr-=over; s.wingl-=over; s.backr-=over; s.backl-=over;
+      _animsurf = false;
+    }
+ }
+
+void FlightSim::step_maneuver ( float dt )
+ {
+   const ManeuverSegment& g = Maneuvers[_maneuver][_segment];
+   float duration = GS_MAX(GS_ABS(g.pitch),GS_ABS(g.roll)) / (ManeuverRate*g.speed);
+   float t0 = _segtime;
+   _segtime = GS_MIN ( _segtime+dt, duration );
+   float f = (_segtime-t0)/duration;
+   _cur.pitch += g.pitch*f;
+   _cur.roll += g.roll*f;
+
+   if ( _segtime>=duration )
+    { _segtime = 0;
+      _segment++;
+      if ( _segment==2 || Maneuvers[_maneuver][_segment].speed==0 ) { _maneuver=NoManeuver; _segment=0; }
+    }
+ }
+
+// updates the position and frame at the distance flown on the curve, which
+// is followed at constant speed independently of the spacing of its points;
+// the frame is interpolated from the precomputed ones of the edge
+void FlightSim::step_curve ()
+ {
+   State& s = _cur;
+   if ( !(_cdist<_curve.length()) ) { exit_curve(); return; } // (also if not a number)
+
+   float f;
+   int c = _curve.locate ( float(_cdist), f );
+   if ( c<0 ) { exit_curve(); return; }
+   const GsArray<GsVec>& pnts = _curve.points();
+   s.cpos = pnts[c] + (pnts[c+1]-pnts[c])*f;
+   s.cpoint = s.cpos;
+   _frames.frame ( c, f, s.ctangent, s.cnormal, s.cbitangent );
+ }
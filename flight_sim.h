@@ -0,0 +1,110 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef FLIGHT_SIM_H
+#define FLIGHT_SIM_H
+
+// Include needed header files
+# include <gsim/gs_vec.h>
+# include <gsim/gs_array.h>
+# include "arc_length.h"
+# include "curve_frames.h"
+
+// The state of the airplane and of its animations, advanced with a fixed time
+// step independently of the rendering. There are no OpenGL or glut dependencies
+// so that it can also run without a window. Angles are in degrees.
+class FlightSim
+ { public :
+    // all values needed to draw a frame, which can be interpolated:
+    struct State
+     { GsVec pos;                       // position of the airplane when not following a curve
+       GsVec shadowpos;                 // position of the shadow
+       float roll, pitch, yaw;          // orientation of the airplane
+       float wingr, wingl, backr, backl; // front and back control surfaces
+       float sun;                       // angle of the sun
+       bool  curving;                   // true when following the curve
+       GsVec cpoint;                    // current curve point
+       GsVec cpos, ctangent, cnormal, cbitangent; // position and frame on the curve
+     };
+    enum Maneuver { NoManeuver, FrontFlip, BackFlip, BarrelRoll, ReverseBarrelRoll,
+                    FlipRoll, ReverseFlipRoll, HalfRollFlip };
+   private :
+    State _prev, _cur;   // the last two states
+    double _dt;          // fixed time step
+    double _acc;         // time accumulated and not yet simulated
+    double _time;        // simulated time
+    float _speed;        // units per second
+    bool _animsun;
+    bool _animsurf, _resetsurf; // control surfaces animation and its end request
+    float _surfdir;      // direction of the control surfaces animation
+    Maneuver _maneuver;  // maneuver being performed
+    int _segment;        // segment of the maneuver being performed
+    float _segtime;      // time already spent in the segment
+    ArcLength _curve;    // points of the curve to follow, parameterized by arc length
+    CurveFrames _frames; // frames at the points of the curve
+    double _cdist;       // distance already flown on the curve
+    int _curveid;        // incremented each time a new curve is generated
+    gsuint _rseed;       // state of the random generator of the curves
+   public :
+    static const float SurfacesRate; // degrees per second of the control surfaces animation
+    static const float SunRate;      // degrees per second of the sun
+    static const float ManeuverRate; // degrees per second of the flips and rolls
+    static const float CurveSpeed;   // units per second when following a curve
+    static const float CurveTolerance; // maximum distance between a curve and its samples
+
+    FlightSim ( double dt=0.001 );
+    void init ();
+
+    // seeds the random generator of the curves; each simulation has its own
+    // so that several ones can run in parallel with reproducible results
+    void seed ( gsuint s ) { _rseed=s; }
+
+    // the fixed time step used by advance(), 1 ms by default
+    void timestep ( double dt ) { _dt=dt; }
+    double timestep () const { return _dt; }
+    double time () const { return _time; }
+
+    // simulates one step of dt seconds
+    void step ( double dt );
+    // accumulates elapsed seconds and simulates as many fixed steps as they contain,
+    // returning the number of steps done; at most 0.25 seconds are simulated per call
+    int advance ( double elapsed );
+    // the fraction of a step left in the accumulator, for interpolating the states
+    float alpha () const { return float(_acc/_dt); }
+    const State& state () const { return _cur; }
+    State interpolated () const { return interpolate(_prev,_cur,alpha()); }
+    static State interpolate ( const State& a, const State& b, float t );
+    // true if the state changes over time
+    bool active () const;
+
+    // controls:
+    void turn ( float droll, float dpitch, float dyaw );
+    void accelerate ( float dv ) { _speed+=dv; }
+    float speed () const { return _speed; }
+    void move_surfaces ( float dwingr, float dwingl, float dbackr, float dbackl );
+    // starts the control surfaces animation, or ends it once the surfaces are back to zero
+    void animate_surfaces ();
+    bool animating_surfaces () const { return _animsurf; }
+    void animate_sun ( bool b ) { _animsun=b; }
+    bool animating_sun () const { return _animsun; }
+    // starts maneuver m, or stops it if it is being performed
+    void maneuver ( Maneuver m );
+    Maneuver maneuver () const { return _maneuver; }
+
+    // generates a random closed curve from the current position and starts following it
+    void gen_curve ();
+    void exit_curve ();
+    const GsArray<GsVec>& curve () const { return _curve.points(); }
+    const ArcLength& path () const { return _curve; }
+    const CurveFrames& frames () const { return _frames; }
+    int curve_id () const { return _curveid; }
+
+    // direction of the airplane with the given orientation
+    static GsVec direction ( float roll, float pitch, float yaw );
+   private :
+    void step_surfaces ( float dt );
+    void step_maneuver ( float dt );
+    void step_curve ();
+    int random ( int min, int max );
+ };
+
+#endif // FLIGHT_SIM_H
@@ -0,0 +1,210 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <stdarg.h>
+# include <gsim/gs_timer.h>
+# include "frame_profiler.h"
+
+// seconds of the monotonic clock, read from the processor counter when possible
+static double now ()
+ {
+   return double(gs_fast_ticks())*1.0E-9;
+ }
+
+FrameProfiler::FrameProfiler ()
+ {
+   _npasses = 0;
+   _frameno = 0;
+   _inframe = false;
+   _framestart = 0;
+   _gpu = false;
+   for ( int s=0; s<Latency; s++ ) _nq[s]=-1;
+ }
+
+FrameProfiler::~FrameProfiler ()
+ {
+   if ( _gpu ) glDeleteQueries ( Latency*MaxQueries, &_queries[0][0] );
+ }
+
+void FrameProfiler::init ( int frames, bool gpu )
+ {
+   _frames.size ( GS_MAX(frames,Latency) );
+   _frameno = 0;
+   if ( _gpu ) glDeleteQueries ( Latency*MaxQueries, &_queries[0][0] );
+   _gpu = false;
+   if ( gpu )
+    { GLint bits=0;
+      glGetQueryiv ( GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits );
+      _gpu = bits>0;
+    }
+   if ( _gpu ) glGenQueries ( Latency*MaxQueries, &_queries[0][0] );
+   for ( int s=0; s<Latency; s++ ) _nq[s]=-1;
+ }
+
+int FrameProfiler::pass ( const char* name )
+ {
+   int i;
+   for ( i=0; i<_npasses; i++ ) if ( _names[i]==name ) return i;
+   for ( i=0; i<_npasses; i++ ) if ( strcmp(_names[i],name)==0 ) return i;
+   if ( _npasses==MaxPasses ) return MaxPasses-1; // the last one gets all extra passes
+   _names[_npasses] = name;
+   return _npasses++;
+ }
+
+void FrameProfiler::begin_frame ()
+ {
+   if ( _frames.size()==0 ) init ( 240, false );
+   int slot = _frameno%Latency;
+
+   // the queries of the frame which used this slot are read before being issued again:
+   if ( _nq[slot]>0 && _frameno>=Latency )
+    { Frame& f = _frames[(_frameno-Latency)%_frames.size()];
+      GLint avail=1; // all queries read below must be available, or the frame is skipped
+      for ( int k=0; avail && k<2*_nq[slot]; k++ )
+       glGetQueryObjectiv ( _queries[slot][k], GL_QUERY_RESULT_AVAILABLE, &avail );
+      for ( int k=0; avail && k<_nq[slot]; k++ )
+       { GLuint64 a, b;
+         glGetQueryObjectui64v ( _queries[slot][2*k], GL_QUERY_RESULT, &a );
+         glGetQueryObjectui64v ( _queries[slot][2*k+1], GL_QUERY_RESULT, &b );
+         float ms = float ( double(b-a)*1.0e-6 );
+         int i = _qpass[slot][k];
+         if ( i<0 ) f.gpuframe=ms; else f.gpu[i]+=ms;
+       }
+    }
+
+   Frame& f = _frames[_frameno%_frames.size()];
+   for ( int i=0; i<MaxPasses; i++ ) f.cpu[i]=f.gpu[i]=0;
+   f.cpuframe = 0;
+   f.gpuframe = -1;
+   _inframe = true;
+   _nq[slot] = 0;
+   if ( _gpu )
+    { _qpass[slot][0] = -1;
+      glQueryCounter ( _queries[slot][0], GL_TIMESTAMP );
+      _nq[slot] = 1;
+    }
+   _framestart = now();
+ }
+
+void FrameProfiler::end_frame ()
+ {
+   if ( !_inframe ) return;
+   Frame& f = _frames[_frameno%_frames.size()];
+   f.cpuframe = float ( (now()-_framestart)*1000.0 );
+   int slot = _frameno%Latency;
+   if ( _gpu ) glQueryCounter ( _queries[slot][1], GL_TIMESTAMP );
+   _inframe = false;
+   _frameno++;
+ }
+
+double FrameProfiler::begin ( int i )
+ {
+   int slot = _frameno%Latency;
+   if ( _inframe && _gpu && _nq[slot]<=MaxPasses )
+    { _qpass[slot][_nq[slot]] = i;
+      glQueryCounter ( _queries[slot][2*_nq[slot]], GL_TIMESTAMP );
+    }
+   return now();
+ }
+
+void FrameProfiler::end ( int i, double start )
+ {
+   if ( !_inframe ) return;
+   _frames[_frameno%_frames.size()].cpu[i] += float ( (now()-start)*1000.0 );
+   int slot = _frameno%Latency;
+   if ( _gpu && _nq[slot]<=MaxPasses )
+    { glQueryCounter ( _queries[slot][2*_nq[slot]+1], GL_TIMESTAMP );
+      _nq[slot]++;
+    }
+ }
+
+void FrameProfiler::average ( int i, float& cpu, float& gpu ) const
+ {
+   double c=0, g=0;
+   int n=frames(), ng=0;
+   for ( int k=0; k<n; k++ )
+    { const Frame& f = frame(k);
+      c += i<0? f.cpuframe : f.cpu[i];
+      if ( f.gpuframe<0 ) continue; // not yet read
+      g += i<0? f.gpuframe : f.gpu[i];
+      ng++;
+    }
+   cpu = n>0? float(c/n) : 0;
+   gpu = ng>0? float(g/ng) : -1.0f;
+ }
+
+// appends a formatted line to s, lines are at most 63 characters
+static void append ( GsArenaArray<char>& s, const char* fmt, ... )
+ {
+   char line[64];
+   va_list args;
+   va_start ( args, fmt );
+   int n = vsnprintf ( line, sizeof(line), fmt, args );
+   va_end ( args );
+   s.push ( line, GS_BOUND(n,0,int(sizeof(line))-1) );
+ }
+
+const char* FrameProfiler::text ( GsArena& a ) const
+ {
+   GsArenaArray<char> s ( a );
+   s.reserve ( 32*(_npasses+2) );
+   float cpu, gpu;
+   average ( -1, cpu, gpu );
+   append ( s, "%-14s %7s %7s\n", "ms", "cpu", gpu<0? "":"gpu" );
+   for ( int i=-1; i<_npasses; i++ )
+    { average ( i, cpu, gpu );
+      if ( gpu<0 ) append ( s, "%-14s %7.3f\n", i<0? "frame":_names[i], cpu );
+       else append ( s, "%-14s %7.3f %7.3f\n", i<0? "frame":_names[i], cpu, gpu );
+    }
+   s.push() = 0;
+   return s.pt();
+ }
+
+bool FrameProfiler::save_csv ( const char* filename ) const
+ {
+   FILE* fp = fopen ( filename, "w" );
+   if ( !fp ) return false;
+   fprintf ( fp, "frame,pass,cpu_ms,gpu_ms\n" );
+   int first = _frameno-frames();
+   for ( int k=0; k<frames(); k++ )
+    { const Frame& f = frame(k);
+      fprintf ( fp, "%d,frame,%g,", first+k, f.cpuframe );
+      if ( f.gpuframe>=0 ) fprintf ( fp, "%g", f.gpuframe );
+      fprintf ( fp, "\n" );
+      for ( int i=0; i<_npasses; i++ )
+       { fprintf ( fp, "%d,%s,%g,", first+k, _names[i], f.cpu[i] );
+         if ( f.gpuframe>=0 ) fprintf ( fp, "%g", f.gpu[i] );
+         fprintf ( fp, "\n" );
+       }
+    }
+   fclose ( fp );
+   return true;
+ }
+
+bool FrameProfiler::save_json ( const char* filename ) const
+ {
+   FILE* fp = fopen ( filename, "w" );
+   if ( !fp ) return false;
+   int i, first = _frameno-frames();
+   fprintf ( fp, "{ \"passes\": [" );
+   for ( i=0; i<_npasses; i++ ) fprintf ( fp, "%s\"%s\"", i>0? ", ":"", _names[i] );
+   fprintf ( fp, "],\n  \"frames\": [\n" );
+   for ( int k=0; k<frames(); k++ )
+    { const Frame& f = frame(k);
+      fprintf ( fp, "    { \"frame\": %d, \"cpu_ms\": %g, \"gpu_ms\": ", first+k, f.cpuframe );
+      if ( f.gpuframe>=0 ) fprintf ( fp, "%g", f.gpuframe ); else fprintf ( fp, "null" );
+      fprintf ( fp, ",\n      \"cpu\": [" );
+      for ( i=0; i<_npasses; i++ ) fprintf ( fp, "%s%g", i>0? ", ":"", f.cpu[i] );
+      fprintf ( fp, "], \"gpu\": " );
+      if ( f.gpuframe<0 ) fprintf ( fp, "null" );
+       else
+       { fprintf ( fp, "[" );
+         for ( i=0; i<_npasses; i++ ) fprintf ( fp, "%s%g", i>0? ", ":"", f.gpu[i] );
+         fprintf ( fp, "]" );
+       }
+      fprintf ( fp, " }%s\n", k+1<frames()? ",":"" );
+    }
+   fprintf ( fp, "  ]\n}\n" );
+   fclose ( fp );
+   return true;
+ }
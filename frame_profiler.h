@@ -0,0 +1,94 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+// Include needed header files
+# include <gsim/gs_array.h>
+# include <gsim/gs_arena.h>
+# include "ogl_tools.h"
+
+// Measures the time of the passes of each frame on the CPU, with a monotonic
+// clock, and on the GPU, with timestamp queries which are read a few frames
+// later so that the pipeline is never stalled. The times of the last frames
+// are kept in a ring buffer, from which the overlay text and the CSV and JSON
+// files are produced. Passes are identified by their names, which must be
+// string literals or strings which outlive the profiler, and must not be
+// nested, as the GPU time of a pass is taken between two timestamps.
+//
+// The PROFILE_FRAME and PROFILE_PASS macros below time the rest of the
+// enclosing block, and are empty unless FRAME_PROFILER is defined (see the
+// makefile), so that the instrumentation costs nothing when compiled out.
+class FrameProfiler
+ { public :
+    static const int MaxPasses = 16;
+    struct Frame
+     { float cpu[MaxPasses], gpu[MaxPasses]; // milliseconds of each pass
+       float cpuframe, gpuframe;             // whole frame, gpuframe<0 if not measured
+     };
+   private :
+    static const int Latency = 4;            // frames until the queries of a frame are read
+    static const int MaxQueries = 2*MaxPasses+2;
+    const char* _names[MaxPasses];
+    int _npasses;
+    GsArray<Frame> _frames; // ring buffer indexed by frame number
+    int _frameno;           // number of the current frame, counting from 0
+    bool _inframe;
+    double _framestart;
+    bool _gpu;              // false if timestamp queries are not supported
+    GLuint _queries[Latency][MaxQueries];
+    int _qpass[Latency][MaxPasses+1]; // pass of each query pair, -1 for the frame
+    int _nq[Latency];                 // query pairs issued in each slot, -1 if none
+   public :
+    FrameProfiler ();
+   ~FrameProfiler ();
+    // keeps the last frames, and creates the GL queries if an OpenGL context is current
+    void init ( int frames=240, bool gpu=true );
+    bool gpu () const { return _gpu; }
+    // returns the index of the pass with the given name, adding it if needed
+    int pass ( const char* name );
+    const char* pass_name ( int i ) const { return _names[i]; }
+    int passes () const { return _npasses; }
+    // frames recorded, at most the size of the ring buffer
+    int frames () const { return GS_MIN(_frameno,_frames.size()); }
+    // the i-th oldest recorded frame; the gpu times of the last frames are not yet known
+    const Frame& frame ( int i ) const { return _frames[(_frameno-frames()+i)%_frames.size()]; }
+    void begin_frame ();
+    void end_frame ();
+    // starts pass i, returning the start time to be given to end()
+    double begin ( int i );
+    void end ( int i, double start );
+    // average milliseconds of pass i (or of the frame if i<0) over the recorded
+    // frames, gpu is -1 if not measured
+    void average ( int i, float& cpu, float& gpu ) const;
+    // lines with the averages of the frame and of each pass, in memory of the
+    // arena which is valid until it is reset
+    const char* text ( GsArena& a ) const;
+    // all recorded frames, one line per frame and pass, or as one json object
+    bool save_csv ( const char* filename ) const;
+    bool save_json ( const char* filename ) const;
+
+    // times the enclosing block as a frame or as one of its passes:
+    struct FrameScope
+     { FrameProfiler& p;
+       FrameScope ( FrameProfiler& fp ) : p(fp) { p.begin_frame(); }
+      ~FrameScope () { p.end_frame(); }
+     };
+    struct PassScope
+     { FrameProfiler& p; int i; double start;
+       PassScope ( FrameProfiler& fp, const char* name ) : p(fp) { i=p.pass(name); start=p.begin(i); }
+      ~PassScope () { p.end(i,start); }
+     };
+ };
+
+# if defined(FRAME_PROFILER)
+# define PROFILE_CONCAT2(a,b) a##b
+# define PROFILE_CONCAT(a,b) PROFILE_CONCAT2(a,b)
+# define PROFILE_FRAME(p) FrameProfiler::FrameScope PROFILE_CONCAT(_profframe,__LINE__) ( p )
+# define PROFILE_PASS(p,name) FrameProfiler::PassScope PROFILE_CONCAT(_profpass,__LINE__) ( p, name )
+# else
+# define PROFILE_FRAME(p)
+# define PROFILE_PASS(p,name)
+# endif
+
+#endif // FRAME_PROFILER_H
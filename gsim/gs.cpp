@@ -13,6 +13,7 @@
 # include <iostream>
 
 # include <gsim/gs.h>
+# include <gsim/gs_timer.h>
 
 # ifdef GS_WINDOWS
 # include <Windows.h>
@@ -445,15 +446,11 @@ const char* gs_extension (  const char* fname )
  }
 
 static struct stat _lstat;
-static char *_lstatname = 0;
-static bool _lsresult = false;
 
+// the result is not reused between calls since files may be created or modified
 static bool fill_stat ( const char *name )
  {
-  if ( _lstatname && strcmp(_lstatname,name)==0 ) return _lsresult;
-  gs_string_set ( _lstatname, name );
-  _lsresult = ( stat(name,&_lstat)==0 );
-  return _lsresult;
+  return stat(name,&_lstat)==0;
 }
 
 bool gs_exist ( const char* name )
@@ -503,53 +500,27 @@ void gs_sleep ( int milisecs )
 
 // ================================= Timer ==================================
 
-double gs_time ()
+// system time in seconds, which may jump when it is adjusted:
+static double utc_time ()
  {
-   static bool first=true;
-   #ifdef GS_WINDOWS
-   static double _perf_freq = 0.0;
-   static double _utc_origin = 0.0;
-   #endif
-
-   if ( first )
-    { first = false;
-      # ifdef GS_WINDOWS
-      LARGE_INTEGER lpFrequency;
-      LARGE_INTEGER lpPerformanceCount;
-      struct _timeb tbuf;
-      if ( QueryPerformanceFrequency(&lpFrequency)==false )
-       { std::cout << "GsTimer: WIN32 High Resolution Performance Counter not supported.\n"; }
-      else
-       { _perf_freq = (double)lpFrequency.QuadPart;
-         QueryPerformanceCounter ( &lpPerformanceCount );
-         _ftime( &tbuf ); // get UTC time in seconds from Jan 1, 1970
-         double hrcTime = double(lpPerformanceCount.QuadPart) / double(lpFrequency.QuadPart);
-         double utcTime = double(tbuf.time) + double(tbuf.millitm)*1.0E-3;
-         _utc_origin = utcTime - hrcTime;
-       }
-      # endif
-    }
-
    # ifdef GS_WINDOWS
-   if ( _perf_freq==0 ) // not available
-    { _timeb tp;
-      _ftime(&tp);
-      return 0.001*(double)tp.millitm + (double)tp.time;
-    }
-   else
-    { LARGE_INTEGER lpPerformanceCount;
-      QueryPerformanceCounter (&lpPerformanceCount);
-      return _utc_origin + double(lpPerformanceCount.QuadPart) / _perf_freq;
-    }
-   # endif
-
-   # ifdef GS_LINUX
+   _timeb tp;
+   _ftime ( &tp );
+   return 0.001*(double)tp.millitm + (double)tp.time;
+   # else
    timeval tp;
    if ( gettimeofday(&tp,0)==-1 ) return 0;
    return 0.000001*(double)tp.tv_usec + (double)tp.tv_sec;
    # endif
  }
 
+double gs_time ()
+ {
+   // the origin of the monotonic clock in UTC time, taken in the first call:
+   static const double origin = utc_time() - gs_seconds();
+   return origin + gs_seconds();
+ }
+
 // =============================== Random Methods ==================================
 
 // The docs say: rand function returns a pseudorandom integer in the range 0 to RAND_MAX,
@@ -88,6 +88,7 @@ typedef uint16_t     gsuint16; //!< 2 bytes unsigned int, from 0 to 65,535
 typedef int16_t      gsint16;  //!< 2 bytes integer, from -32,768 to 32,767
 typedef uint32_t     gsuint32; //!< 4 bytes unsigned int, from 0 to 4294967295
 typedef int32_t      gsint32;  //!< 4 bytes signed integer, from -2147483648 to 2147483647
+typedef uint64_t     gsuint64; //!< 8 bytes unsigned int, from 0 to 18446744073709551615
 typedef unsigned int gsuint;   //!< 4 or 8 bytes unsigned int, depending on the compiler
 typedef int          gsint;    //!< 4 or 8 bytes int, depending on the compiler
 
@@ -324,8 +325,10 @@ void gs_sleep ( int milisecs );
 // ================================= Timer ==================================
 
 /*! Returns the time in seconds since midnight (00:00:00) of
-    January 1, 1970, coordinated universal time (UTC). 
-    This function uses the high performance counter in windows */
+    January 1, 1970, coordinated universal time (UTC), as read in the first
+    call and then advanced by the monotonic clock of gs_ticks() (see
+    gs_timer.h), so that later adjustments of the system time do not
+    change the intervals measured with it. */
 double gs_time ();
 
 // ============================== Random Numbers ==================================
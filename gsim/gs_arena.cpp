@@ -0,0 +1,67 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <stdlib.h>
+# include <gsim/gs_arena.h>
+
+//================================ GsArena ==================================
+
+GsArena::GsArena ( size_t blocksize )
+ {
+   _blocks = 0;
+   _used = 0;
+   _blocksize = blocksize;
+   _total = 0;
+   _peak = 0;
+   _allocations = 0;
+ }
+
+GsArena::~GsArena ()
+ {
+   free_blocks ();
+ }
+
+void GsArena::free_blocks ()
+ {
+   while ( _blocks )
+    { Block* b = _blocks;
+      _blocks = b->next;
+      free ( b );
+    }
+ }
+
+// the block in use is full: a new one becomes the first of the list
+void* GsArena::alloc_block ( size_t n )
+ {
+   size_t size = GS_MAX ( _blocksize, n );
+   Block* b = (Block*) malloc ( sizeof(Block)+size ); // (aligned to 16 as the memory of malloc)
+   if ( !b ) return 0;
+   _allocations++;
+   if ( _blocks ) _total += _blocks->size-_used; // the rest of the old block is not used
+   b->next = _blocks;
+   b->size = size;
+   _blocks = b;
+   _used = n;
+   _total += n;
+   return b+1;
+ }
+
+void GsArena::reset ()
+ {
+   if ( _total>_peak ) _peak=_total;
+   if ( _blocks && _blocks->next ) // replaced by a single block for the next frames
+    { size_t size = 0;
+      for ( Block* b=_blocks; b; b=b->next ) size += b->size;
+      free_blocks ();
+      _blocksize = GS_MAX ( _blocksize, size );
+      alloc_block ( 0 );
+    }
+   _used = 0;
+   _total = 0;
+ }
+
+//============================== end of file ===============================
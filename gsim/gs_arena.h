@@ -0,0 +1,144 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_ARENA_H
+# define GS_ARENA_H
+
+/** \file gs_arena.h
+ * linear allocator for temporary data */
+
+# include <string.h>
+# include <type_traits>
+# include <gsim/gs.h>
+
+/*! \class GsArena gs_arena.h
+    \brief Linear allocator for temporary data
+
+    GsArena hands out memory from large blocks by advancing an offset, and
+    releases all of it at once with reset(). It is meant for the temporary
+    data of a frame: the arena is reset once per frame, and the data
+    allocated during the frame is valid until then. When a block is full
+    another one is allocated, and reset() replaces all blocks by a single
+    one with their total size, so that after the first frames a frame
+    allocates no memory at all. Constructors and destructors are not
+    called, and GsArena is not thread safe. */
+class GsArena
+ { private :
+    struct alignas(16) Block { Block* next; size_t size; }; // followed by the memory of the block
+    Block* _blocks;        // the block in use, first in the list
+    size_t _used;          // bytes used in the block in use
+    size_t _blocksize;     // minimum size of a new block
+    size_t _total;         // bytes used in all blocks, including the ends of the full ones
+    size_t _peak;          // largest total since the arena was created
+    gsuint64 _allocations; // number of blocks allocated
+    void* alloc_block ( size_t n );
+    void free_blocks ();
+
+   public :
+    /*! Constructs an empty arena; the first block is allocated by the
+        first call to alloc() with at least blocksize bytes */
+    GsArena ( size_t blocksize=64*1024 );
+
+    /*! Frees all blocks */
+   ~GsArena ();
+
+    /*! Returns n bytes aligned to align, which must be a power of 2 not
+        larger than 16 */
+    void* alloc ( size_t n, size_t align=16 )
+     { if ( _blocks )
+        { size_t a = (_used+align-1) & ~(align-1);
+          if ( a+n<=_blocks->size ) { _total+=a+n-_used; _used=a+n; return (char*)(_blocks+1)+a; }
+        }
+       return alloc_block ( n );
+     }
+
+    /*! Returns uninitialized memory for n elements of type X, which must
+        not need a destructor since it will not be called */
+    template <typename X>
+    X* alloc ( int n )
+     { static_assert ( std::is_trivially_destructible<X>::value, "GsArena does not call destructors" );
+       static_assert ( alignof(X)<=16, "GsArena aligns to at most 16 bytes" );
+       return (X*) alloc ( sizeof(X)*size_t(n), 16 );
+     }
+
+    /*! Releases all the allocated memory to be used again; if more than
+        one block was used they are replaced by one with their total size */
+    void reset ();
+
+    /*! Frees all blocks */
+    void clear () { free_blocks(); _used=_total=0; }
+
+    /*! Bytes allocated since the last reset(), including alignment */
+    size_t used () const { return _total; }
+
+    /*! Largest number of bytes used between resets */
+    size_t peak () const { return GS_MAX(_peak,_total); }
+
+    /*! Number of blocks allocated with malloc() since the arena was created */
+    gsuint64 allocations () const { return _allocations; }
+ };
+
+/*! \class GsArenaArray gs_arena.h
+    \brief Resizeable array in a GsArena
+
+    GsArenaArray has the basic interface of GsArray for temporary arrays of
+    a frame. Its memory comes from a GsArena, so it is valid only until the
+    arena is reset, and it is never freed by the array: when it grows the
+    elements are copied to new memory of the arena and the old one is only
+    released by reset(). As in GsArray, constructors and destructors of X
+    are not called. */
+template <typename X>
+class GsArenaArray
+ { private :
+    GsArena* _arena;
+    X* _data;
+    int _size, _capacity;
+
+   public :
+    /*! Constructs an empty array taking memory from arena a */
+    GsArenaArray ( GsArena& a, int s=0 ) { _arena=&a; _data=0; _size=_capacity=0; size(s); }
+
+    bool empty () const { return _size==0; }
+    int size () const { return _size; }
+    int capacity () const { return _capacity; }
+
+    /*! Changes the capacity, keeping the elements which fit in it */
+    void capacity ( int nc )
+     { if ( nc==_capacity ) return;
+       X* d = nc>0? _arena->alloc<X>(nc) : 0;
+       if ( nc<_size ) _size=nc;
+       if ( _size>0 ) memcpy ( (void*)d, (const void*)_data, sizeof(X)*_size );
+       _data=d; _capacity=nc;
+     }
+
+    /*! Ensures the capacity is at least c */
+    void reserve ( int c ) { if ( _capacity<c ) capacity(c); }
+
+    /*! Changes the size, doubling the capacity when it is not enough */
+    void size ( int ns ) { if ( ns>_capacity ) capacity ( GS_MAX(ns,2*_capacity) ); _size=ns; }
+
+    void clear () { _size=0; }
+
+    X& operator[] ( int i ) const { return _data[i]; }
+    X* pt () const { return _data; }
+    X& top () const { return _data[_size-1]; }
+    X& pop () { return _data[--_size]; }
+
+    /*! Appends one position and returns it */
+    X& push () { if ( _size==_capacity ) capacity ( GS_MAX(8,2*_capacity) ); return _data[_size++]; }
+
+    /*! Appends a copy of x */
+    void push ( const X& x ) { X c=x; push()=c; } // (x may be in the array)
+
+    /*! Appends n elements copied from pt */
+    void push ( const X* pt, int n )
+     { int s=_size; size(_size+n); memcpy ( (void*)(_data+s), (const void*)pt, sizeof(X)*n ); }
+ };
+
+//============================== end of file ===============================
+
+# endif // GS_ARENA_H
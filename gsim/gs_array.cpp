@@ -7,6 +7,7 @@
  
 # include <stdlib.h>
 # include <string.h>
+# include <atomic>
 
 # include <gsim/gs_array.h>
 
@@ -16,21 +17,37 @@
 
 //================================= methods =======================================================
 
-GsArrayBase::GsArrayBase ( unsigned sizeofx, int s, int c ) 
-            : _size(s), _capacity(c)
+static std::atomic<gsuint64> Allocations(0); // see allocations()
+
+const GsArrayBase::Alloc GsArrayBase::Alloc::def = { 200, 0, 0, 0 };
+
+gsuint64 GsArrayBase::allocations ()
+ {
+   return Allocations.load ( std::memory_order_relaxed );
+ }
+
+// growth percent of n, not less than n
+static int grow ( int n, int growth )
+ {
+   long long c = (long long)n*growth/100;
+   if ( c<n ) c=n;
+   return c>0x7fffffff? 0x7fffffff : int(c);
+ }
+
+GsArrayBase::GsArrayBase ( unsigned sizeofx, int s, int c, const Alloc& a ) 
+            : _data(a.buf), _size(0), _capacity(a.bufcap)
  { 
-   if ( _capacity<_size ) _capacity=_size;
-   _data = _capacity>0? malloc(sizeofx*_capacity) : 0;
+   if ( c<s ) c=s;
+   if ( c>_capacity ) realloc_data ( sizeofx, c, a );
+   _size = s;
  }
 
-GsArrayBase::GsArrayBase ( unsigned sizeofx, const GsArrayBase& a ) 
-            : _size(a._size), _capacity(a._size)
+GsArrayBase::GsArrayBase ( unsigned sizeofx, const GsArrayBase& a, const Alloc& al ) 
+            : _data(al.buf), _size(0), _capacity(al.bufcap)
  { 
-   if ( _capacity>0 ) 
-    { _data = malloc ( sizeofx*_capacity );
-      if ( _size>0 ) memcpy ( _data, a._data, sizeofx*_size );
-    }
-   else _data = 0;
+   if ( a._size>_capacity ) realloc_data ( sizeofx, a._size, al );
+   _size = a._size;
+   if ( _size>0 ) memcpy ( _data, a._data, sizeofx*_size );
  }
 
 GsArrayBase::GsArrayBase ( void* pt, int s, int c ) 
@@ -38,70 +55,91 @@ GsArrayBase::GsArrayBase ( void* pt, int s, int c )
  {
  }
 
-void GsArrayBase::free_data ()
+void GsArrayBase::free_data ( const Alloc& a )
  { 
-   if (_data) free(_data); 
+   if ( _data && _data!=a.buf ) free(_data); 
  }
 
-void GsArrayBase::size ( unsigned sizeofx, int ns )
+void GsArrayBase::realloc_data ( unsigned sizeofx, int nc, const Alloc& a )
  {
-   _size = ns;
+   if ( nc<a.bufcap ) nc=a.bufcap;
+   if ( nc==_capacity ) return;
 
-   if ( _size>_capacity )
-    { _capacity = _size;
-      _data = realloc ( _data, sizeofx*_capacity ); // if _data==0, realloc reacts as malloc.
+   if ( a.buf && nc==a.bufcap ) // back to the inline buffer
+    { if ( _size>0 ) memcpy ( a.buf, _data, sizeofx*_size );
+      free ( _data );
+      _data = a.buf;
     }
+   else if ( nc==0 )
+    { free ( _data );
+      _data = 0;
+    }
+   else if ( a.buf && _data==a.buf ) // from the inline buffer, which realloc cannot move
+    { void* data = malloc ( sizeofx*nc );
+      if ( _size>0 ) memcpy ( data, _data, sizeofx*_size );
+      _data = data;
+      Allocations++;
+    }
+   else
+    { _data = realloc ( _data, sizeofx*nc ); // if _data==0, realloc reacts as malloc.
+      Allocations++;
+    }
+   _capacity = nc;
  }
 
-void GsArrayBase::capacity ( unsigned sizeofx, int nc )
+void GsArrayBase::shrink ( unsigned sizeofx, const Alloc& a )
  {
-   if ( nc==_capacity ) return;
-   if ( nc<=0 ) { if(_data)free(_data); _data=0; _capacity=_size=0; return; }
-
-   _capacity = nc;
-   if ( _size>_capacity ) _size=_capacity;
-
-   _data = realloc ( _data, sizeofx*_capacity ); // if _data==0, realloc reacts as malloc.
+   if ( a.shrink<=0 || _capacity<=a.bufcap || (long long)_size*a.shrink>_capacity ) return;
+   realloc_data ( sizeofx, grow(_size,a.growth), a );
  }
 
-void GsArrayBase::compress ( unsigned sizeofx )
+void GsArrayBase::size ( unsigned sizeofx, int ns, const Alloc& a )
  {
-   if ( _size==_capacity ) return;
+   if ( ns>_capacity )
+    { int c = grow ( _capacity, a.growth );
+      realloc_data ( sizeofx, c>ns? c:ns, a );
+      _size = ns;
+    }
+   else
+    { _size = ns;
+      shrink ( sizeofx, a );
+    }
+ }
 
-   if ( !_size ) { free ( _data ); _data=0; }
-    else _data = realloc ( _data, sizeofx*_size );
+void GsArrayBase::capacity ( unsigned sizeofx, int nc, const Alloc& a )
+ {
+   if ( nc<0 ) nc=0;
+   if ( _size>nc ) _size=nc;
+   realloc_data ( sizeofx, nc, a );
+ }
 
-   _capacity = _size;
+void GsArrayBase::compress ( unsigned sizeofx, const Alloc& a )
+ {
+   realloc_data ( sizeofx, _size, a );
  }
 
-void GsArrayBase::remove ( unsigned sizeofx, int i, int n )
+void GsArrayBase::remove ( unsigned sizeofx, int i, int n, const Alloc& a )
  { 
    if ( _size==0 ) return;
    if ( i<_size-n ) memmove ( DATA(i), DATA(i+n), sizeofx*(_size-(i+n)) );
    _size-=n;
+   shrink ( sizeofx, a );
  }
 
-void GsArrayBase::insert ( unsigned sizeofx, int i, int n )
+void GsArrayBase::insert ( unsigned sizeofx, int i, int n, const Alloc& a )
  { 
+   if ( _size+n>_capacity ) realloc_data ( sizeofx, grow(_size+n,a.growth), a );
    _size += n;
 
-   if ( _size>_capacity ) 
-    { _capacity = _size*2; 
-      _data = realloc ( _data, sizeofx*_capacity );
-    }
-
    if ( i<_size-n )
     { memmove ( DATA(i+n), DATA(i), sizeofx*(_size-n-i) ); // ok with overlap
     }
  }
 
-void GsArrayBase::push ( unsigned sizeofx )
+void GsArrayBase::push ( unsigned sizeofx, const Alloc& a )
  { 
+   if ( _size+1>_capacity ) realloc_data ( sizeofx, grow(_size+1,a.growth), a );
    _size++;
-   if ( _size>_capacity ) 
-    { _capacity = _size*2; 
-      _data = realloc ( _data, sizeofx*_capacity );
-    }
  }
 
 void GsArrayBase::copy ( unsigned sizeofx, int dest, int src, int n )
@@ -151,56 +189,69 @@ int GsArrayBase::bsearch ( unsigned sizeofx, const void *x, gscompare cmp, int *
    return comp==0? p : -1;
  }
 
-int GsArrayBase::insort ( unsigned sizeofx, const void *x, gscompare cmp )
+int GsArrayBase::insort ( unsigned sizeofx, const void *x, gscompare cmp, const Alloc& a )
  { 
    int pos;
    bsearch ( sizeofx, x, cmp, &pos );
-   insert ( sizeofx, pos, 1 );
+   insert ( sizeofx, pos, 1, a );
    return pos;
  }
 
-int GsArrayBase::uniqinsort ( unsigned sizeofx, const void *x, gscompare cmp )
+int GsArrayBase::uniqinsort ( unsigned sizeofx, const void *x, gscompare cmp, const Alloc& a )
  { 
    int pos;
    if ( bsearch(sizeofx,x,cmp,&pos)>=0 ) return -1; // already there
-   insert ( sizeofx, pos, 1 );
+   insert ( sizeofx, pos, 1, a );
    return pos;
  }
 
-void GsArrayBase::copyfrom ( unsigned sizeofx, const GsArrayBase& a )
+void GsArrayBase::copyfrom ( unsigned sizeofx, const GsArrayBase& a, const Alloc& al )
  { 
    if ( _data==a._data ) return;
    if ( _capacity<a._size  )
-    { _capacity = a._size;
-      _data = realloc ( _data, sizeofx*_capacity );
+    { _size = 0; // (nothing to keep)
+      realloc_data ( sizeofx, a._size, al );
     }
    _size = a._size;
    if ( _size>0 ) memcpy ( _data, a._data, sizeofx*_size );
  }
 
-void* GsArrayBase::abandon ()
+void* GsArrayBase::abandon ( unsigned sizeofx, const Alloc& a )
  {
    void *pt = _data;     
-   _data=0;
+   if ( a.buf && _data==a.buf ) // the inline buffer cannot be given
+    { pt = 0;
+      if ( _size>0 )
+       { pt = malloc ( sizeofx*_size );
+         memcpy ( pt, _data, sizeofx*_size );
+         Allocations++;
+       }
+    }
+   _data=a.buf;
    _size=0;
-   _capacity=0;
+   _capacity=a.bufcap;
    return pt;
  }
 
-void GsArrayBase::adopt ( GsArrayBase& a )
+void GsArrayBase::adopt ( unsigned sizeofx, GsArrayBase& x, const Alloc& al, const Alloc& ax )
  {
-   if ( _data ) free ( _data );
-   _data     = a._data;     a._data=0;
-   _size     = a._size;     a._size=0;
-   _capacity = a._capacity; a._capacity=0;
+   if ( ax.buf && x._data==ax.buf ) // the inline buffer of x cannot be taken
+    { copyfrom ( sizeofx, x, al );
+      x._size = 0;
+      return;
+    }
+   free_data ( al );
+   if ( x._data ) { _data=x._data; _capacity=x._capacity; }
+    else { _data=al.buf; _capacity=al.bufcap; }
+   _size = x._size;
+   x._data=ax.buf; x._size=0; x._capacity=ax.bufcap;
  }
 
-void GsArrayBase::adopt ( void* pt, int s, int c )
+void GsArrayBase::adopt ( void* pt, int s, int c, const Alloc& a )
  {
-   if ( _data ) free ( _data );
-   _data     = pt;
-   _size     = s;
-   _capacity = c;
+   free_data ( a );
+   if ( pt ) { _data=pt; _size=s; _capacity=c; }
+    else { _data=a.buf; _size=0; _capacity=a.bufcap; }
  }
 
 //============================== end of file ===============================
@@ -22,9 +22,25 @@
     written using quick memory block trasfer functions, and malloc() and free()
     functions are used. So that void pointers are used to refer to user's data.
     Most methods need to know the size of each element which is the parameter 
-    sizeofx appearing several times. */
+    sizeofx appearing several times, and the methods which allocate memory
+    follow the allocation parameters given by the policy of the GsArray. */
 class GsArrayBase
- { protected :
+ { public :
+    /*! Allocation parameters of a GsArray, see GsArrayPolicy */
+    struct Alloc
+     { int growth;  //!< percentage of the needed size to grow to
+       int shrink;  //!< the capacity is reduced when it is shrink times the size, 0 for never
+       void* buf;   //!< inline buffer of the array, or null
+       int bufcap;  //!< capacity of the inline buffer
+       static const Alloc def; //!< parameters of the default policy
+     };
+
+    /*! Returns the number of times memory was allocated or reallocated by
+        all arrays since the program started. It is meant for tests, and is
+        updated in a thread safe way. */
+    static gsuint64 allocations ();
+
+   protected :
     void* _data;     //!< Array pointer used for storage
     int   _size;     //!< Number of elements being used in array
     int   _capacity; //!< Number of allocated elements (>=size)
@@ -33,10 +49,10 @@ class GsArrayBase
 
     /*! Init with the sizeof of each element, size, and capacity. If the given
         capacity is smaller than the size, capacity is set to be equal to size */
-    GsArrayBase ( unsigned sizeofx, int s, int c );
+    GsArrayBase ( unsigned sizeofx, int s, int c, const Alloc& a=Alloc::def );
 
     /*! Copy constructor. Allocates and copies size elements. */
-    GsArrayBase ( unsigned sizeofx, const GsArrayBase& a );
+    GsArrayBase ( unsigned sizeofx, const GsArrayBase& a, const Alloc& al=Alloc::def );
 
     /*! Constructor from a given buffer. No checkings are done, 
         its the user responsibility to give consistent parameters. */
@@ -45,38 +61,48 @@ class GsArrayBase
     /*! Will free the internal buffer if needed. The internal size and capacity 
         are not adjusted, so that this method should be called only by the 
         destructor of the derived class, as GsArrayBase has not a destructor. */
-    void free_data ();
+    void free_data ( const Alloc& a=Alloc::def );
+
+    /*! Changes the capacity to nc, which is at least the size and at least
+        the inline capacity. All allocations are done here. */
+    void realloc_data ( unsigned sizeofx, int nc, const Alloc& a );
+
+    /*! Reduces the capacity if the policy of a shrinks it at the current size */
+    void shrink ( unsigned sizeofx, const Alloc& a );
 
     /*! Changes the size of the array. Reallocation is done only when the size 
-        requested is greater than the current capacity, and in this case,
-        capacity becomes equal to the size. */
-    void size ( unsigned sizeofx, int ns );
+        requested is greater than the current capacity, and in this case, the
+        capacity grows to the size or to growth percent of the capacity, the
+        largest, so that growing with size() also takes amortized constant
+        time. With a shrink policy the capacity is reduced when it becomes
+        shrink times the new size. */
+    void size ( unsigned sizeofx, int ns, const Alloc& a=Alloc::def );
 
     /*! Changes the capacity of the array. Reallocation is done whenever a new
         capacity is requested. internal memory is freed in case of 0 capacity.
         The size is always kept inside [0,nc]. Parameter nc is considered 0
         if it is negative. */
-    void capacity ( unsigned sizeofx, int nc );
+    void capacity ( unsigned sizeofx, int nc, const Alloc& a=Alloc::def );
 
     /*! Makes size==capacity, freeing all extra capacity if any. */
-    void compress ( unsigned sizeofx );
+    void compress ( unsigned sizeofx, const Alloc& a=Alloc::def );
 
     /*! Removes n positions starting with position index i, moving all data
         correctly. Parameters i and n must be correct as they are not checked.
-        In any case, no reallocation is done; only the size is decreased. */
-    void remove ( unsigned sizeofx, int i, int n );
+        No reallocation is done, unless the policy shrinks the capacity. */
+    void remove ( unsigned sizeofx, int i, int n, const Alloc& a=Alloc::def );
 
     /*! Inserts n positions, starting at pos i, moving all data correctly. 
         Parameter i can be in [0,size()], if i==size(), n positions are 
         appended. Parameters i and n must be correct as they are not checked.
-        If reallocation is needed, the new capacity will be the double of
-        the new size (size after insertion). */
-    void insert ( unsigned sizeofx, int i, int n );
+        If reallocation is needed, the new capacity will be growth percent
+        of the new size (size after insertion), by default the double. */
+    void insert ( unsigned sizeofx, int i, int n, const Alloc& a=Alloc::def );
 
     /*! Inserts 1 position at the end of the array. If reallocation is
-        needed, the array capacity is reallocated to contain two times
-        the new size (current size+1). */
-    void push ( unsigned sizeofx );
+        needed, the array capacity is reallocated to contain growth percent
+        of the new size (current size+1), by default the double. */
+    void push ( unsigned sizeofx, const Alloc& a=Alloc::def );
 
     /*! Copies n entries from src position to dest position. Regions are
         allowed to overlap. Uses the C function memmove.
@@ -103,31 +129,62 @@ class GsArrayBase
         created (with insert) and the index of the position is returned,
         but the contents of x are not moved to the inserted position.
         That way, x can be only a key to the data stored in the array. */
-    int insort ( unsigned sizeofx, const void *x, gscompare cmp );
+    int insort ( unsigned sizeofx, const void *x, gscompare cmp, const Alloc& a=Alloc::def );
 
     /*! Same as insort(), but will not insert x in case there is already an
         element in the array equal to x. Returns the position of the insertion,
         or -1 if x was not inserted. */
-    int uniqinsort ( unsigned sizeofx, const void *x, gscompare cmp );
+    int uniqinsort ( unsigned sizeofx, const void *x, gscompare cmp, const Alloc& a=Alloc::def );
 
     /*! Copy from another array. GsArrayBase will be a copy of the given array,
         but will reallocate only if needed in order to hold a.size elements. */
-    void copyfrom ( unsigned sizeofx, const GsArrayBase& a );
+    void copyfrom ( unsigned sizeofx, const GsArrayBase& a, const Alloc& al=Alloc::def );
 
     /*! Returns the internal buffer pointer and makes GsArrayBase an empty 
         and valid array. The returned pointer will be null or will contain
-        allocated data with malloc(). The user will then be responsible to
-        free this memory with free() when needed. */
-    void* abandon ();
+        allocated data with malloc(), also when the data was in the inline
+        buffer. The user will then be responsible to free this memory with
+        free() when needed. */
+    void* abandon ( unsigned sizeofx, const Alloc& a=Alloc::def );
 
     /*! Adopts the data of the given array a, and lets a become an empty array.
         GsArrayBase will have the same data that a had before. This is done 
-        without reallocation. */
-    void adopt ( GsArrayBase& a );
+        without reallocation, unless the data of a is in its inline buffer
+        (given in aa), in which case it is copied. */
+    void adopt ( unsigned sizeofx, GsArrayBase& a, const Alloc& al=Alloc::def, const Alloc& aa=Alloc::def );
 
     /*! Frees the current data of GsArrayBase, and then makes GsArrayBase to control
         the given buffer pt, with size and capacity as given.  */
-    void adopt (  void* pt, int s, int c );
+    void adopt (  void* pt, int s, int c, const Alloc& a=Alloc::def );
+ };
+
+/*! \class GsArrayPolicy gs_array.h
+    \brief Allocation policy of GsArray
+
+    When more capacity is needed the array grows to Growth percent of the
+    needed size; the default doubles it, as GsArray always did. With Shrink>0
+    the capacity is reduced to Growth percent of the size when size() or
+    remove() make the capacity Shrink times the size, and since Shrink should
+    be larger than Growth/100 arrays oscillating around a size are not
+    reallocated. With Inline>0 the first Inline elements are stored inside
+    the array object, so that small arrays do not allocate memory at all;
+    arrays with inline storage must then not be moved with memcpy, as done
+    when they are elements of another GsArray. */
+template <int Growth=200, int Shrink=0, int Inline=0>
+struct GsArrayPolicy
+ { enum { growth=Growth, shrink=Shrink, inlinecap=Inline };
+ };
+
+/*! Inline storage of GsArray, empty when no inline capacity is used */
+template <typename X, int N>
+struct GsArrayInline
+ { alignas(X) char _buf[N*sizeof(X)]; // (raw memory since constructors are not called)
+   void* inlinebuf () const { return (void*)_buf; }
+ };
+
+template <typename X>
+struct GsArrayInline<X,0>
+ { void* inlinebuf () const { return 0; }
  };
 
 /*! \class GsArray gs_array.h
@@ -139,33 +196,44 @@ class GsArrayBase
     allocated data, as GsArray will not respect them when resizing. internally, 
     malloc(), realloc() and free() functions are used throught GsArrayBase methods. 
     Note that the array size is automatically reallocated when needed (with a double
-    size strategy), and so take care to not reference internal memory of GsArray
-    that can be reallocated. For example, the following code is wrong: a.push()=a[x],
-    because a[x] references a memory position that can be reallocated by push() */
-template <typename X>
-class GsArray : protected GsArrayBase
- { public:
+    size strategy by default, see GsArrayPolicy), and so take care to not reference
+    internal memory of GsArray that can be reallocated. For example, the following
+    code is wrong: a.push()=a[x], because a[x] references a memory position that
+    can be reallocated by push() */
+template <typename X, class P=GsArrayPolicy<> >
+class GsArray : private GsArrayInline<X,P::inlinecap>, protected GsArrayBase
+ { private:
+    // allocation parameters of the policy, with the inline buffer of this array
+    GsArrayBase::Alloc alloc () const
+     { GsArrayBase::Alloc a = { P::growth, P::shrink, GsArrayInline<X,P::inlinecap>::inlinebuf(), P::inlinecap };
+       return a;
+     }
+
+   public:
 
     /*! Constructs with the given size and capacity. If the given capacity 
         is smaller than the size, capacity is set to be equal to size. */
-    GsArray ( int s=0, int c=0 ) : GsArrayBase ( sizeof(X), s, c ) {}
+    GsArray ( int s=0, int c=0 ) : GsArrayBase ( sizeof(X), s, c, alloc() ) {}
 
     /*! Copy constructor. GsArray will be an exact copy of the given array, 
         but allocating as capacity only the size of a. 
         Attention: the operator= that X might have is not called ! */
-    GsArray ( const GsArray& a ) : GsArrayBase ( sizeof(X), a ) {}
+    GsArray ( const GsArray& a ) : GsArrayBase ( sizeof(X), a, alloc() ) {}
+
+    /*! Move constructor, taking the data of a as done by adopt() */
+    GsArray ( GsArray&& a ) : GsArrayBase ( sizeof(X), 0, 0, alloc() ) { adopt(a); }
 
     /*! Constructor from a given buffer. No checkings are done, its the user 
         responsibility to give consistent parameters. */
-    GsArray ( X* pt, int s, int c ) : GsArrayBase ( sizeof(X), s, c ) {}
+    GsArray ( X* pt, int s, int c ) : GsArrayBase ( sizeof(X), s, c, alloc() ) {}
 
     /*! Constructor from a string with values to initialize the array. */
-    GsArray ( const char* values, int s=0, int c=0 ) : GsArrayBase ( sizeof(X), s, c )
+    GsArray ( const char* values, int s=0, int c=0 ) : GsArrayBase ( sizeof(X), s, c, alloc() )
      { GsInput inp; inp.init(values); inp>>*this; }
 
     /*! Destructor frees the array calling the base class free_data() method.
         Attention: elements' destructors are not called ! */
-   ~GsArray () { GsArrayBase::free_data(); }
+   ~GsArray () { GsArrayBase::free_data(alloc()); }
 
     /*! Returns true if the array has no elements, ie, size()==0; and false otherwise. */
     bool empty () const { return _size==0? true:false; }
@@ -180,13 +248,21 @@ class GsArray : protected GsArrayBase
 
     /*! Changes the size of the array. Reallocation is done only when the size 
         requested is greater than the current capacity, and in this case, capacity
-        becomes equal to the size. */
-    void size ( int ns ) { GsArrayBase::size(sizeof(X),ns); }
+        becomes equal to the size, or to growth percent of the current capacity if
+        larger. With a shrink policy the capacity may also be reduced. */
+    void size ( int ns )
+     { if ( ns<=_capacity && (P::shrink==0||ns>=_size) ) _size=ns;
+        else GsArrayBase::size(sizeof(X),ns,alloc());
+     }
+
+    /*! Sets the size to 0 keeping the capacity, whatever the policy is, so
+        that arrays filled again and again are not reallocated. */
+    void clear () { _size=0; }
 
     /*! Changes the capacity of the array. Reallocation is done whenever a new
         capacity is requested. Internal memory is freed in case of 0 capacity.
         The size is always kept inside [0,nc]. */
-    void capacity ( int nc ) { GsArrayBase::capacity(sizeof(X),nc); }
+    void capacity ( int nc ) { GsArrayBase::capacity(sizeof(X),nc,alloc()); }
 
     /*! Defines a minimum capacity to use, ie, sets the capacity to be c
         only if the current capacity is lower than c */
@@ -197,7 +273,7 @@ class GsArray : protected GsArrayBase
         { int i; for ( i=0; i<_size; i++ ) ((X*)_data)[i]=x; }
 
     /*! Makes capacity to be equal to size, freeing all extra capacity if any. */
-    void compress () { GsArrayBase::compress ( sizeof(X) ); }
+    void compress () { GsArrayBase::compress ( sizeof(X), alloc() ); }
 
     /*! Returns a valid index from an index that may be out of bounds by assuming it
         refers to a circular mapping, ie, it returns index%size() for positive numbers;
@@ -262,7 +338,7 @@ class GsArray : protected GsArrayBase
     /*! Method to append positions. If reallocation is needed, capacity is set
         to two times the new size. The first new element appended is returned
         as a reference. */
-    X& push () { if(_size<_capacity) return ((X*)_data)[_size++]; GsArrayBase::push(sizeof(X)); return top(); }
+    X& push () { if(_size<_capacity) return ((X*)_data)[_size++]; GsArrayBase::push(sizeof(X),alloc()); return top(); }
 
     /*! Pushes one position at the end of the array using the insert() method, and
         then copies the content of x using operator=(). */
@@ -276,11 +352,11 @@ class GsArray : protected GsArrayBase
         appended. If reallocation is required, capacity is set to two times the
         new size. The first new element inserted (i) is returned as a reference. 
         The quantity of appended positions (n) has a default value of 1. */
-    X& insert ( int i, int n=1 ) { GsArrayBase::insert(sizeof(X),i,n); return ((X*)_data)[i]; }
+    X& insert ( int i, int n=1 ) { GsArrayBase::insert(sizeof(X),i,n,alloc()); return ((X*)_data)[i]; }
 
     /*! Removes n positions starting from pos i, moving all data correctly;
         n has a default value of 1. Attention: elements' destructors are not called! */
-    void remove ( int i, int n=1 ) { GsArrayBase::remove(sizeof(X),i,n); }
+    void remove ( int i, int n=1 ) { GsArrayBase::remove(sizeof(X),i,n,alloc()); }
 
     /*! Copies n entries from src position to dest position. Regions are
         allowed to overlap. Uses the C function memmove.
@@ -288,18 +364,21 @@ class GsArray : protected GsArrayBase
     void copy ( int dest, int src, int n ) { GsArrayBase::copy(sizeof(X),dest,src,n); }
 
     /*! Copies n entries from src position to dest position at desta array. */
-    void copyto ( GsArray<X>& desta, int dest, int src, int n ) const
+    void copyto ( GsArray& desta, int dest, int src, int n ) const
      { GsArrayBase::copyto(sizeof(X),desta,dest,src,n); }
 
     /*! Appends a copy of array a. */
-    void push ( const GsArray<X>& a )
+    void push ( const GsArray& a )
      { int n=size(); insert(n,a.size()); a.copyto(*this,n,0,a.size()); }
 
     /*! Copies all internal data of a to GsArray, with fast memcpy() functions,
         so that the operator=() that X might have is not used. This method has
         no effect if a "self copy" is called. */
-    void operator = ( const GsArray<X>& a )
-     { GsArrayBase::copyfrom ( sizeof(X), a ); }
+    void operator = ( const GsArray& a )
+     { GsArrayBase::copyfrom ( sizeof(X), a, alloc() ); }
+
+    /*! Move operator, same as adopt() */
+    void operator = ( GsArray&& a ) { if ( this!=&a ) adopt(a); }
 
     /*! Reverses the order of the elements in the array. Copy operator of X is used. */
     void reverse ()
@@ -319,7 +398,7 @@ class GsArray : protected GsArrayBase
         X's copy operator. A compare function int gs_compare(const X*,const X*)
         is required as argument.*/
     int insort ( const X& x, GS_COMPARE_FUNC )
-     { int pos = GsArrayBase::insort ( sizeof(X), (void*)&x, (gscompare)cmpfunc );
+     { int pos = GsArrayBase::insort ( sizeof(X), (void*)&x, (gscompare)cmpfunc, alloc() );
        get(pos)=x;
        return pos;
      }
@@ -328,7 +407,7 @@ class GsArray : protected GsArrayBase
         element in the array equal to x. Returns the position of the insertion,
         or -1 if x was not inserted. */
     int uniqinsort ( const X& x, GS_COMPARE_FUNC )
-     { int pos = GsArrayBase::uniqinsort ( sizeof(X), (void*)&x, (gscompare)cmpfunc );
+     { int pos = GsArrayBase::uniqinsort ( sizeof(X), (void*)&x, (gscompare)cmpfunc, alloc() );
        if ( pos>=0 ) get(pos)=x;
        return pos;
      }
@@ -356,23 +435,23 @@ class GsArray : protected GsArrayBase
         returnsthe internal buffer pointer of the array without deallocating it.
         After this call the array will become an empty valid array and the user
         will then be responsible to free this allocated memory with free(). */
-    X* abandon () { return (X*) GsArrayBase::abandon(); }
+    X* abandon () { return (X*) GsArrayBase::abandon(sizeof(X),alloc()); }
 
     /*! Frees the data of GsArray, and then makes GsArray be the given array a.
         After this, a is set to be a valid empty array. The data is moved without
         reallocation. */
-    void adopt ( GsArray<X>& a ) { GsArrayBase::adopt ( (GsArrayBase&)a ); }
+    void adopt ( GsArray& a ) { GsArrayBase::adopt ( sizeof(X), (GsArrayBase&)a, alloc(), a.alloc() ); }
 
     /*! Frees the data of GsArray, and then makes GsArray to control the given 
         buffer pt, with size and capacity as given. Its the user reponsibility to
         pass correct values. Note also that the memory menagement of GsArray is
         done with malloc/realloc/free functions. */
-    void adopt (  X* pt, int s, int c ) { GsArrayBase::adopt ( pt, s, c ); }
+    void adopt (  X* pt, int s, int c ) { GsArrayBase::adopt ( pt, s, c, alloc() ); }
 
     /*! Output all elements of the array.
         Element type X must have its ouput operator << available.
         The output format is [e0 e1 ... en] */
-    friend GsOutput& operator<< ( GsOutput& o, const GsArray<X>& a )
+    friend GsOutput& operator<< ( GsOutput& o, const GsArray& a )
      { int i, m=a.size();
        o << '[';
        for ( i=0; i<m; i++ ) o  << ' ' << a[i];
@@ -380,6 +459,11 @@ class GsArray : protected GsArrayBase
      }
  };
 
+/*! GsArray keeping up to N elements inside the array object, without
+    allocating memory; see GsArrayPolicy for its restrictions */
+template <typename X, int N>
+using GsSmallArray = GsArray< X, GsArrayPolicy<200,0,N> >;
+
 /*! \class GsArrayPt gs_array.h
     \brief GsArray extension for pointers
 
@@ -0,0 +1,290 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_CLASS_ARRAY_H
+# define GS_CLASS_ARRAY_H
+
+/** \file gs_class_array.h
+ * resizeable array of classes */
+
+# include <stdlib.h>
+# include <string.h>
+# include <new>
+# include <utility>
+# include <algorithm>
+# include <type_traits>
+# include <gsim/gs.h>
+
+/*! \class GsClassArray gs_class_array.h
+    \brief Resizeable array respecting constructors and destructors
+
+    GsClassArray is the companion of GsArray for elements which own memory
+    or other resources, as GsString. Elements are constructed when they are
+    added and destroyed when they are removed, and when the array grows or
+    elements are shifted by insert() and remove() they are moved with the
+    move constructor of X and the moved-from elements are destroyed. Only
+    when X is trivially copyable the elements are moved with memcpy() and
+    memmove(), as done by GsArray. Copies of the array copy each element
+    with the copy constructor or operator of X. As with GsArray, references
+    to elements are not valid after calls which may reallocate the array. */
+template <typename X>
+class GsClassArray
+ { private :
+    X*  _data;
+    int _size;
+    int _capacity;
+    enum { Trivial = std::is_trivially_copyable<X>::value };
+
+    // size needed when growing, doubled as done by GsArray
+    static int grow ( int n ) { return n<4? 4 : 2*n; }
+
+    // moves n elements from src to the uninitialized memory at dest, in
+    // another buffer or in the same one at a lower position
+    static void relocate ( X* dest, X* src, int n )
+     { if ( n<=0 ) return;
+       if ( Trivial ) { memmove ( (void*)dest, (const void*)src, sizeof(X)*n ); return; }
+       for ( int i=0; i<n; i++ ) { new (dest+i) X ( std::move(src[i]) ); src[i].~X(); }
+     }
+
+    // same as relocate() to a higher position of the same buffer
+    static void relocate_back ( X* dest, X* src, int n )
+     { if ( n<=0 ) return;
+       if ( Trivial ) { memmove ( (void*)dest, (const void*)src, sizeof(X)*n ); return; }
+       for ( int i=n-1; i>=0; i-- ) { new (dest+i) X ( std::move(src[i]) ); src[i].~X(); }
+     }
+
+    static void destroy ( X* pt, int n )
+     { if ( !std::is_trivially_destructible<X>::value ) for ( int i=0; i<n; i++ ) pt[i].~X(); }
+
+    static X* allocate ( int c ) { return c>0? (X*)malloc(sizeof(X)*c) : 0; }
+
+    // moves the elements to a buffer of capacity c>=_size
+    void realloc_data ( int c )
+     { if ( c==_capacity ) return;
+       if ( Trivial && c>0 ) { _data = (X*)realloc ( (void*)_data, sizeof(X)*c ); }
+        else { X* d=allocate(c); relocate(d,_data,_size); free(_data); _data=d; }
+       _capacity = c;
+     }
+
+    // opens n uninitialized positions at i, growing the array if needed
+    void open ( int i, int n )
+     { int ns = _size+n;
+       if ( ns<=_capacity ) { relocate_back ( _data+i+n, _data+i, _size-i ); }
+        else
+        { int c = grow(ns);
+          X* d = allocate(c);
+          relocate ( d, _data, i );
+          relocate ( d+i+n, _data+i, _size-i );
+          free ( _data );
+          _data = d;
+          _capacity = c;
+        }
+       _size = ns;
+     }
+
+    void copy_data ( const GsClassArray& a )
+     { if ( Trivial ) { if (a._size) memcpy ( (void*)_data, (const void*)a._data, sizeof(X)*a._size ); return; }
+       for ( int i=0; i<a._size; i++ ) new (_data+i) X ( a._data[i] );
+     }
+
+   public :
+
+    /*! Constructs with s default constructed elements and capacity c,
+        or s if c is smaller than s */
+    GsClassArray ( int s=0, int c=0 )
+     { _size=0; _capacity=GS_MAX(s,c); _data=allocate(_capacity); size(s); }
+
+    /*! Copy constructor, copying each element with the copy constructor of X
+        and allocating as capacity only the size of a */
+    GsClassArray ( const GsClassArray& a )
+     { _size=a._size; _capacity=a._size; _data=allocate(_capacity); copy_data(a); }
+
+    /*! Move constructor, taking the buffer of a without copying and leaving a empty */
+    GsClassArray ( GsClassArray&& a )
+     { _data=a._data; _size=a._size; _capacity=a._capacity; a._data=0; a._size=a._capacity=0; }
+
+    /*! Destructor destroys all elements and frees the buffer */
+   ~GsClassArray () { destroy(_data,_size); free(_data); }
+
+    /*! Returns true if the array has no elements, and false otherwise */
+    bool empty () const { return _size==0; }
+
+    /*! Returns the current size of the array */
+    int size () const { return _size; }
+
+    /*! Returns the capacity of the array */
+    int capacity () const { return _capacity; }
+
+    /*! Changes the size of the array, default constructing the new elements
+        or destroying the removed ones. The capacity grows geometrically
+        and is never reduced. */
+    void size ( int ns )
+     { if ( ns<_size ) { destroy(_data+ns,_size-ns); _size=ns; return; }
+       if ( ns>_capacity ) realloc_data ( GS_MAX(ns,grow(_capacity)) );
+       for ( ; _size<ns; _size++ ) new (_data+_size) X;
+     }
+
+    /*! Changes the capacity of the array, destroying the elements after
+        the new capacity, if any */
+    void capacity ( int nc )
+     { if ( nc<0 ) nc=0;
+       if ( nc<_size ) size(nc);
+       realloc_data ( nc );
+     }
+
+    /*! Ensures the capacity is at least c, without changing the size */
+    void reserve ( int c ) { if ( _capacity<c ) realloc_data(c); }
+
+    /*! Makes the capacity equal to the size */
+    void compress () { realloc_data(_size); }
+
+    /*! Same as compress() */
+    void shrink_to_fit () { realloc_data(_size); }
+
+    /*! Destroys all elements, keeping the capacity */
+    void clear () { destroy(_data,_size); _size=0; }
+
+    /*! Sets all elements to x with the copy operator of X */
+    void setall ( const X& x ) { for ( int i=0; i<_size; i++ ) _data[i]=x; }
+
+    /*! Returns a valid index as if the array was circular, see GsArray::vid() */
+    int vid ( int index ) const { if (index<0) index=_size-(-index%_size); return index%_size; }
+
+    /*! Element access, no checkings are done */
+    X& operator[] ( int i ) const { return _data[i]; }
+    const X& operator() ( int i ) const { return _data[i]; }
+    X& get ( int i ) const { return _data[i]; }
+    const X& cget ( int i ) const { return _data[i]; }
+    X* pt () const { return _data; }
+
+    /*! Returns the last element, or the i-th element before it */
+    X& top ( int i=0 ) const { return _data[_size-i-1]; }
+    const X& ctop ( int i=0 ) const { return _data[_size-i-1]; }
+
+    /*! Destroys the last element; the array must not be empty */
+    void pop () { _data[--_size].~X(); }
+
+    /*! Appends an element constructed with the given arguments and returns
+        a reference to it. If the array has to grow, the element is
+        constructed before the old elements are moved, so that the
+        arguments can reference elements of the array. */
+    template <typename... A>
+    X& emplace ( A&&... args )
+     { if ( _size<_capacity ) return *new (_data+_size++) X ( std::forward<A>(args)... );
+       int c = grow(_size+1);
+       X* d = allocate(c);
+       new (d+_size) X ( std::forward<A>(args)... );
+       relocate ( d, _data, _size );
+       free ( _data );
+       _data = d;
+       _capacity = c;
+       return _data[_size++];
+     }
+
+    /*! Appends a default constructed element and returns it */
+    X& push () { return emplace(); }
+
+    /*! Appends a copy of x */
+    void push ( const X& x ) { emplace(x); }
+
+    /*! Appends x, moving it */
+    void push ( X&& x ) { emplace(std::move(x)); }
+
+    /*! Inserts n default constructed elements at position i, moving the
+        following ones, and returns a reference to the first inserted one */
+    X& insert ( int i, int n=1 )
+     { open ( i, n );
+       for ( int k=0; k<n; k++ ) new (_data+i+k) X;
+       return _data[i];
+     }
+
+    /*! Destroys n elements starting at position i, moving the following ones */
+    void remove ( int i, int n=1 )
+     { destroy ( _data+i, n );
+       relocate ( _data+i, _data+i+n, _size-i-n );
+       _size -= n;
+     }
+
+    /*! Copy operator, assigning to the existing elements with the copy
+        operator of X so that the memory they own can be reused */
+    void operator = ( const GsClassArray& a )
+     { if ( this==&a ) return;
+       int i, n=GS_MIN(_size,a._size);
+       if ( a._size>_capacity ) { clear(); realloc_data(a._size); n=0; }
+       for ( i=0; i<n; i++ ) _data[i]=a._data[i];
+       for ( ; i<a._size; i++ ) new (_data+i) X ( a._data[i] );
+       if ( _size>a._size ) destroy ( _data+a._size, _size-a._size );
+       _size = a._size;
+     }
+
+    /*! Move operator, same as adopt() */
+    void operator = ( GsClassArray&& a ) { adopt(a); }
+
+    /*! Frees the data of the array, and then makes it be the given array a,
+        which becomes empty. The data is moved without reallocation. */
+    void adopt ( GsClassArray& a )
+     { if ( this==&a ) return;
+       destroy(_data,_size); free(_data);
+       _data=a._data; _size=a._size; _capacity=a._capacity;
+       a._data=0; a._size=a._capacity=0;
+     }
+
+    /*! Sorts the array with std::sort(), moving the elements. The compare
+        function is as in GsArray: int gs_compare(const X*,const X*) */
+    void sort ( GS_COMPARE_FUNC )
+     { std::sort ( _data, _data+_size, [cmpfunc] ( const X& a, const X& b ) { return cmpfunc(&a,&b)<0; } ); }
+
+    /*! Linear search, returns the index of the element found, or -1 */
+    int lsearch ( const X& x, GS_COMPARE_FUNC ) const
+     { for ( int i=0; i<_size; i++ ) if ( cmpfunc(_data+i,&x)==0 ) return i;
+       return -1;
+     }
+
+    /*! Binary search for sorted arrays, see GsArray::bsearch() */
+    int bsearch ( const X& x, GS_COMPARE_FUNC, int *pos=0 ) const
+     { int min=0, max=_size-1;
+       while ( min<=max )
+        { int mid = (min+max)/2;
+          int c = cmpfunc ( &x, _data+mid );
+          if ( c==0 ) { if (pos) *pos=mid; return mid; }
+          if ( c<0 ) max=mid-1; else min=mid+1;
+        }
+       if ( pos ) *pos=min;
+       return -1;
+     }
+
+    /*! Inserts a copy of x in the sorted array and returns its position;
+        x must not be an element of the array */
+    int insort ( const X& x, GS_COMPARE_FUNC )
+     { int pos;
+       bsearch ( x, cmpfunc, &pos );
+       open ( pos, 1 );
+       new (_data+pos) X ( x );
+       return pos;
+     }
+
+    /*! Same as insort() but x is not inserted if an equal element is found,
+        in which case -1 is returned */
+    int uniqinsort ( const X& x, GS_COMPARE_FUNC )
+     { int pos;
+       if ( bsearch(x,cmpfunc,&pos)>=0 ) return -1;
+       open ( pos, 1 );
+       new (_data+pos) X ( x );
+       return pos;
+     }
+
+    /*! Outputs all elements in format [e0 e1 ... en] */
+    friend GsOutput& operator<< ( GsOutput& o, const GsClassArray& a )
+     { o << '[';
+       for ( int i=0; i<a.size(); i++ ) o << ' ' << a[i];
+       return o << ' ' << ']';
+     }
+ };
+
+//============================== end of file ===============================
+
+# endif // GS_CLASS_ARRAY_H
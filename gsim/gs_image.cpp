@@ -10,8 +10,6 @@ notice licence.txt located at the base folder of the distribution.
 # include <iostream>
 # include "gs_image.h"
 
-# include "ogl_tools.h"
-
 using namespace std;
 
 # define TRACE  // comment this to hide messages
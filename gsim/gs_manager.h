@@ -11,6 +11,10 @@
 /** \file gs_manager.h 
  * Generic way to manage classes */
 
+# include <stdlib.h>
+# include <new>
+# include <utility>
+# include <type_traits>
 # include <gsim/gs_input.h>
 
 /*! Generic way to allocate, write, read and compare classes */
@@ -25,6 +29,11 @@ class GsManagerBase
     virtual void output ( GsOutput& /*o*/, const void* /*obj*/ ) { }
     virtual void input ( GsInput& /*i*/, void* /*obj*/ ) { }
     virtual int compare ( const void* /*obj1*/, const void* /*obj2*/ ) { return 0; }
+
+    /*! Called by a container which is about to free all its n objects. A
+        manager which can release them at once returns true, and then free()
+        is not called for each of them. The default returns false. */
+    virtual bool free_all ( int /*n*/ ) { return false; }
  };
 
 /*! Example of an implementation of a MyData class to be automatically
@@ -59,6 +68,84 @@ class GsManager : public GsManagerBase
      { return X::compare ( (const X*)obj1, (const X*)obj2 ); }
  };
 
+/*! \class GsPoolManager gs_manager.h
+    \brief Manager allocating objects in large blocks
+
+    GsPoolManager allocates the objects in blocks of blocknodes objects,
+    instead of calling new for each one, and reuses the memory of the freed
+    objects. It can be given to the constructor of GsTree, whose nodes must
+    then be created with create() or alloc() of the pool. When the tree is
+    deleted or its init() is called, and all objects of the pool are nodes
+    of that tree, the blocks are freed at once without visiting the nodes,
+    which is only possible if X does not need a destructor; otherwise each
+    node is freed as usual and the blocks are kept until the pool is deleted.
+    Differently than GsManager, the pool is not shared by default: it has
+    a public destructor and must live longer than the containers using it. */
+template <class X>
+class GsPoolManager : public GsManager<X>
+ { private :
+    union Slot { Slot* next; alignas(X) char data[sizeof(X)]; };
+    struct alignas(Slot) Block { Block* next; }; // followed by the slots of the block
+    Block* _blocks;        // the block being filled, first in the list
+    Slot* _free;           // list of freed slots
+    int _used;             // slots used in the first block
+    int _blocknodes;       // slots per block
+    int _nodes;            // objects allocated and not freed
+    gsuint64 _allocations; // number of blocks allocated
+
+    void* slot ()
+     { _nodes++;
+       if ( _free ) { Slot* s=_free; _free=s->next; return s; }
+       if ( !_blocks || _used==_blocknodes )
+        { Block* b = (Block*) malloc ( sizeof(Block)+sizeof(Slot)*_blocknodes );
+          b->next=_blocks; _blocks=b; _used=0; _allocations++;
+        }
+       return (Slot*)(_blocks+1) + _used++;
+     }
+
+   public :
+    /*! Constructs an empty pool, blocks are allocated when needed */
+    GsPoolManager ( int blocknodes=1024 )
+     { _blocks=0; _free=0; _used=0; _blocknodes=GS_MAX(blocknodes,1); _nodes=0; _allocations=0; }
+
+    /*! Frees all blocks; objects not freed are not destroyed */
+    virtual ~GsPoolManager () { release(); }
+
+    virtual void* alloc () { return (void*) new (slot()) X; }
+
+    virtual void* alloc ( const void* obj ) { return (void*) new (slot()) X(*((const X*)obj)); }
+
+    virtual void free ( void* obj )
+     { ((X*)obj)->~X();
+       Slot* s=(Slot*)obj; s->next=_free; _free=s;
+       _nodes--;
+     }
+
+    /*! Releases all blocks if n is the number of objects of the pool and X
+        is trivially destructible, returning true, and otherwise returns false */
+    virtual bool free_all ( int n )
+     { if ( !std::is_trivially_destructible<X>::value || n!=_nodes ) return false;
+       release ();
+       return true;
+     }
+
+    /*! Returns a new object constructed with the given arguments */
+    template <typename... A>
+    X* create ( A&&... args ) { return new (slot()) X ( std::forward<A>(args)... ); }
+
+    /*! Frees all blocks; objects not freed are not destroyed */
+    void release ()
+     { while ( _blocks ) { Block* b=_blocks; _blocks=b->next; ::free(b); }
+       _free=0; _used=0; _nodes=0;
+     }
+
+    /*! Number of objects allocated and not freed */
+    int nodes () const { return _nodes; }
+
+    /*! Number of blocks allocated since the pool was created */
+    gsuint64 allocations () const { return _allocations; }
+ };
+
 //============================== end of file ===============================
 
 # endif  // GS_MANAGER_H
@@ -0,0 +1,107 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <gsim/gs_mapped_file.h>
+
+# ifdef GS_WINDOWS
+# include <Windows.h>
+# else
+# include <sys/types.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
+# include <fcntl.h>
+# include <unistd.h>
+# endif
+
+//# define GS_USE_TRACE1 // open/close
+# include <gsim/gs_trace.h>
+
+//============================= GsMappedFile ================================
+
+GsMappedFile::GsMappedFile ()
+ {
+   _data = 0;
+   _size = 0;
+   _valid = false;
+   _file = 0;
+   _map = 0;
+ }
+
+GsMappedFile::GsMappedFile ( const char* filename )
+ {
+   _data = 0;
+   _size = 0;
+   _valid = false;
+   _file = 0;
+   _map = 0;
+   open ( filename );
+ }
+
+GsMappedFile::~GsMappedFile ()
+ {
+   close ();
+ }
+
+bool GsMappedFile::open ( const char* filename )
+ {
+   close ();
+   if ( !filename ) return false;
+   GS_TRACE1 ( "Mapping " << filename );
+
+   # ifdef GS_WINDOWS
+   HANDLE fh = CreateFileA ( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+   if ( fh==INVALID_HANDLE_VALUE ) return false;
+   LARGE_INTEGER fsize;
+   if ( !GetFileSizeEx(fh,&fsize) ) { CloseHandle(fh); return false; }
+   _file = (void*)fh;
+   _valid = true;
+   if ( fsize.QuadPart==0 ) return true; // empty files cannot be mapped
+   HANDLE mh = CreateFileMappingA ( fh, NULL, PAGE_READONLY, 0, 0, NULL );
+   if ( !mh ) { close(); return false; }
+   _map = (void*)mh;
+   _data = (const char*) MapViewOfFile ( mh, FILE_MAP_READ, 0, 0, 0 );
+   if ( !_data ) { close(); return false; }
+   _size = (size_t)fsize.QuadPart;
+   # else
+   int fd = ::open ( filename, O_RDONLY );
+   if ( fd<0 ) return false;
+   struct stat st;
+   if ( fstat(fd,&st)!=0 || !S_ISREG(st.st_mode) ) { ::close(fd); return false; }
+   _valid = true;
+   if ( st.st_size>0 )
+    { void* pt = mmap ( 0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( pt==MAP_FAILED ) { _valid=false; ::close(fd); return false; }
+      # ifdef MADV_SEQUENTIAL
+      madvise ( pt, (size_t)st.st_size, MADV_SEQUENTIAL );
+      # endif
+      _data = (const char*)pt;
+      _size = (size_t)st.st_size;
+    }
+   ::close ( fd ); // the mapping remains valid after closing the descriptor
+   # endif
+
+   return true;
+ }
+
+void GsMappedFile::close ()
+ {
+   # ifdef GS_WINDOWS
+   if ( _data ) UnmapViewOfFile ( (LPCVOID)_data );
+   if ( _map ) CloseHandle ( (HANDLE)_map );
+   if ( _file ) CloseHandle ( (HANDLE)_file );
+   # else
+   if ( _data ) munmap ( (void*)_data, _size );
+   # endif
+   _data = 0;
+   _size = 0;
+   _valid = false;
+   _file = 0;
+   _map = 0;
+ }
+
+//============================ End of File =================================
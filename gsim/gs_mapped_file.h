@@ -0,0 +1,71 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_MAPPED_FILE_H
+# define GS_MAPPED_FILE_H
+
+/** \file gs_mapped_file.h
+ * read-only memory mapped file */
+
+# include <stddef.h>
+# include <gsim/gs.h>
+
+/*! \class GsMappedFile gs_mapped_file.h
+    \brief Read-only memory mapped file
+
+    GsMappedFile maps the whole contents of a file in memory so that
+    parsers can scan the file bytes directly, without copies and without
+    per-character calls. mmap() is used in Linux and file mappings are used
+    in Windows. Note that the mapped data is not null-terminated: size()
+    must always be used to detect the end of the data. Empty files are
+    valid and have size 0 with a null data pointer. */
+class GsMappedFile
+ { private :
+    const char* _data; // mapped bytes or null
+    size_t _size;      // number of mapped bytes
+    bool   _valid;     // true if the file was succesfully opened
+    void*  _file;      // windows only: file handle
+    void*  _map;       // windows only: mapping handle
+
+   public :
+    /*! Constructs an invalid mapped file */
+    GsMappedFile ();
+
+    /*! Constructor calling open() for the given file */
+    GsMappedFile ( const char* filename );
+
+    /*! Destructor unmaps the file if needed */
+   ~GsMappedFile ();
+
+    /*! Maps the whole file in memory, returning true if succesfull.
+        Any previously mapped file is first closed. */
+    bool open ( const char* filename );
+
+    /*! Unmaps the file and becomes invalid */
+    void close ();
+
+    /*! Returns true if a file is currently open */
+    bool valid () const { return _valid; }
+
+    /*! Returns a pointer to the first byte of the file, or null if
+        the file is empty or not open */
+    const char* data () const { return _data; }
+
+    /*! Returns the number of bytes mapped */
+    size_t size () const { return _size; }
+
+    /*! Returns a pointer to one past the last mapped byte */
+    const char* end () const { return _data+_size; }
+
+   private :
+    GsMappedFile ( const GsMappedFile& ) {}
+    void operator= ( const GsMappedFile& ) {}
+ };
+
+//============================== end of file ===============================
+
+# endif  // GS_MAPPED_FILE_H
@@ -8,6 +8,12 @@
 # include <gsim/gs_mat.h>
 # include <math.h>
 
+// SSE is part of all x86-64 targets; GS_NO_SSE forces the scalar code:
+# if !defined(GS_NO_SSE) && ( defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP>=1) )
+# define GS_MAT_SSE
+# include <xmmintrin.h>
+# endif
+
 //================================== Static Data ===================================
 
 const GsMat GsMat::null ( 0.0, 0.0, 0.0, 0.0, 
@@ -78,6 +84,11 @@ void GsMat::round ( float prec )
 
 void GsMat::transpose ()
  {
+   # if defined(GS_MAT_SSE)
+   __m128 r1=_mm_loadu_ps(e), r2=_mm_loadu_ps(e+4), r3=_mm_loadu_ps(e+8), r4=_mm_loadu_ps(e+12);
+   _MM_TRANSPOSE4_PS ( r1, r2, r3, r4 );
+   _mm_storeu_ps(e,r1); _mm_storeu_ps(e+4,r2); _mm_storeu_ps(e+8,r3); _mm_storeu_ps(e+12,r4);
+   # else
    float tmp;
    GS_SWAP ( E12, E21 );
    GS_SWAP ( E13, E31 );
@@ -85,6 +96,7 @@ void GsMat::transpose ()
    GS_SWAP ( E23, E32 );
    GS_SWAP ( E24, E42 );
    GS_SWAP ( E34, E43 );
+   # endif
  }
 
 void GsMat::transpose3x3 ()
@@ -387,26 +399,77 @@ void GsMat::ortho ( float left, float right, float bottom, float top, float near
    transpose(); // back to line-major format...
  }
 
+# if defined(GS_MAT_SSE)
+// Four elements of a column of the inverse, for the two patterns of the cofactors:
+// with P the lanes are r2*b-r3*d+r4*f, r3*b-r1*d-r4*f, r1*b-r2*d+r4*f, r2*b-r1*d-r3*f,
+// and with Q the products of b and d are swapped and the signs are inverted, where
+// r1..r4 are the elements of a line of the matrix and b,d,f are the minors of two
+// other lines. The operations are the ones of the scalar code, in the same order.
+static inline __m128 inverse_column ( __m128 r, __m128 b, __m128 d, __m128 f, __m128 det, bool q )
+ {
+   __m128 a = _mm_shuffle_ps ( r, r, _MM_SHUFFLE(1,0,2,1) ); // r2 r3 r1 r2
+   __m128 c = _mm_shuffle_ps ( r, r, _MM_SHUFFLE(0,1,0,2) ); // r3 r1 r2 r1
+   __m128 g = _mm_shuffle_ps ( r, r, _MM_SHUFFLE(2,3,3,3) ); // r4 r4 r4 r3
+   __m128 t = q? _mm_sub_ps ( _mm_mul_ps(c,d), _mm_mul_ps(a,b) )
+               : _mm_sub_ps ( _mm_mul_ps(a,b), _mm_mul_ps(c,d) );
+   __m128 sign = q? _mm_setr_ps(-0.0f,0.0f,-0.0f,0.0f) : _mm_setr_ps(0.0f,-0.0f,0.0f,-0.0f);
+   t = _mm_add_ps ( t, _mm_xor_ps(_mm_mul_ps(g,f),sign) );
+   return _mm_mul_ps ( t, det );
+ }
+# endif
+
 void GsMat::inverse ( GsMat& inv ) const
  {
    float d = det();
    if (d==0.0) return;
    d = 1.0f/d;
 
+   # if defined(GS_MAT_SSE)
+   // the columns of the inverse are computed and then transposed to lines,
+   // so that inv can also be this matrix:
+   __m128 vd = _mm_set1_ps ( d );
+   float m12 = E21*E32 - E22*E31;
+   float m13 = E21*E33 - E23*E31;
+   float m14 = E21*E34 - E24*E31;
+   float m23 = E22*E33 - E23*E32;
+   float m24 = E22*E34 - E24*E32;
+   float m34 = E23*E34 - E24*E33;
+   __m128 b = _mm_setr_ps ( m34, m14, m24, m13 );
+   __m128 c = _mm_setr_ps ( m24, m34, m14, m23 );
+   __m128 f = _mm_setr_ps ( m23, m13, m12, m12 );
+   __m128 c1 = inverse_column ( _mm_loadu_ps(e+12), b, c, f, vd, false );
+   __m128 c4 = inverse_column ( _mm_loadu_ps(e), b, c, f, vd, true );
+
+   m12 = E11*E42 - E12*E41;
+   m13 = E11*E43 - E13*E41;
+   m14 = E11*E44 - E14*E41;
+   m23 = E12*E43 - E13*E42;
+   m24 = E12*E44 - E14*E42;
+   m34 = E13*E44 - E14*E43;
+   b = _mm_setr_ps ( m34, m14, m24, m13 );
+   c = _mm_setr_ps ( m24, m34, m14, m23 );
+   f = _mm_setr_ps ( m23, m13, m12, m12 );
+   __m128 c2 = inverse_column ( _mm_loadu_ps(e+8), b, c, f, vd, false );
+   __m128 c3 = inverse_column ( _mm_loadu_ps(e+4), b, c, f, vd, true );
+
+   _MM_TRANSPOSE4_PS ( c1, c2, c3, c4 );
+   _mm_storeu_ps(inv.e,c1); _mm_storeu_ps(inv.e+4,c2); _mm_storeu_ps(inv.e+8,c3); _mm_storeu_ps(inv.e+12,c4);
+   # else
+   GsMat t(NoInit); // (inv may be this matrix)
    float m12 = E21*E32 - E22*E31;
    float m13 = E21*E33 - E23*E31;
    float m14 = E21*E34 - E24*E31;
    float m23 = E22*E33 - E23*E32;
    float m24 = E22*E34 - E24*E32;
    float m34 = E23*E34 - E24*E33;
-   inv.E11 = (E42*m34 - E43*m24 + E44*m23) * d;
-   inv.E21 = (E43*m14 - E41*m34 - E44*m13) * d;
-   inv.E31 = (E41*m24 - E42*m14 + E44*m12) * d;
-   inv.E41 = (E42*m13 - E41*m23 - E43*m12) * d;
-   inv.E14 = (E13*m24 - E12*m34 - E14*m23) * d;
-   inv.E24 = (E11*m34 - E13*m14 + E14*m13) * d;
-   inv.E34 = (E12*m14 - E11*m24 - E14*m12) * d;
-   inv.E44 = (E11*m23 - E12*m13 + E13*m12) * d;
+   t.E11 = (E42*m34 - E43*m24 + E44*m23) * d;
+   t.E21 = (E43*m14 - E41*m34 - E44*m13) * d;
+   t.E31 = (E41*m24 - E42*m14 + E44*m12) * d;
+   t.E41 = (E42*m13 - E41*m23 - E43*m12) * d;
+   t.E14 = (E13*m24 - E12*m34 - E14*m23) * d;
+   t.E24 = (E11*m34 - E13*m14 + E14*m13) * d;
+   t.E34 = (E12*m14 - E11*m24 - E14*m12) * d;
+   t.E44 = (E11*m23 - E12*m13 + E13*m12) * d;
 
    m12 = E11*E42 - E12*E41;
    m13 = E11*E43 - E13*E41;
@@ -414,14 +477,16 @@ void GsMat::inverse ( GsMat& inv ) const
    m23 = E12*E43 - E13*E42;
    m24 = E12*E44 - E14*E42;
    m34 = E13*E44 - E14*E43;
-   inv.E12 = (E32*m34 - E33*m24 + E34*m23) * d;
-   inv.E22 = (E33*m14 - E31*m34 - E34*m13) * d;
-   inv.E32 = (E31*m24 - E32*m14 + E34*m12) * d;
-   inv.E42 = (E32*m13 - E31*m23 - E33*m12) * d;
-   inv.E13 = (E23*m24 - E22*m34 - E24*m23) * d;
-   inv.E23 = (E21*m34 - E23*m14 + E24*m13) * d;
-   inv.E33 = (E22*m14 - E21*m24 - E24*m12) * d;
-   inv.E43 = (E21*m23 - E22*m13 + E23*m12) * d;
+   t.E12 = (E32*m34 - E33*m24 + E34*m23) * d;
+   t.E22 = (E33*m14 - E31*m34 - E34*m13) * d;
+   t.E32 = (E31*m24 - E32*m14 + E34*m12) * d;
+   t.E42 = (E32*m13 - E31*m23 - E33*m12) * d;
+   t.E13 = (E23*m24 - E22*m34 - E24*m23) * d;
+   t.E23 = (E21*m34 - E23*m14 + E24*m13) * d;
+   t.E33 = (E22*m14 - E21*m24 - E24*m12) * d;
+   t.E43 = (E21*m23 - E22*m13 + E23*m12) * d;
+   inv = t;
+   # endif
  }
 
 float GsMat::det () const
@@ -462,29 +527,44 @@ float GsMat::norm () const
 
 void GsMat::mult ( const GsMat& m1, const GsMat& m2 )
  {
-   GsMat* m = (this==&m1||this==&m2)? new GsMat(GsMat::NoInit) : this;
+   # if defined(GS_MAT_SSE)
+   // each line is m1.Ei1*line1(m2) + m1.Ei2*line2(m2) + ..., with the additions in
+   // the order of the scalar code; all lines of m2 are loaded before storing:
+   __m128 l1=_mm_loadu_ps(m2.e), l2=_mm_loadu_ps(m2.e+4), l3=_mm_loadu_ps(m2.e+8), l4=_mm_loadu_ps(m2.e+12);
+   for ( int i=0; i<16; i+=4 )
+    { const float* a = m1.e+i;
+      __m128 r = _mm_mul_ps ( _mm_set1_ps(a[0]), l1 );
+      r = _mm_add_ps ( r, _mm_mul_ps(_mm_set1_ps(a[1]),l2) );
+      r = _mm_add_ps ( r, _mm_mul_ps(_mm_set1_ps(a[2]),l3) );
+      r = _mm_add_ps ( r, _mm_mul_ps(_mm_set1_ps(a[3]),l4) );
+      _mm_storeu_ps ( e+i, r );
+    }
+   # else
+   GsMat tmp(GsMat::NoInit);
+   GsMat& m = (this==&m1||this==&m2)? tmp : *this;
 
-   m->setl1 ( m1.E11*m2.E11 + m1.E12*m2.E21 + m1.E13*m2.E31 + m1.E14*m2.E41,
-              m1.E11*m2.E12 + m1.E12*m2.E22 + m1.E13*m2.E32 + m1.E14*m2.E42,
-              m1.E11*m2.E13 + m1.E12*m2.E23 + m1.E13*m2.E33 + m1.E14*m2.E43,
-              m1.E11*m2.E14 + m1.E12*m2.E24 + m1.E13*m2.E34 + m1.E14*m2.E44 );
+   m.setl1 ( m1.E11*m2.E11 + m1.E12*m2.E21 + m1.E13*m2.E31 + m1.E14*m2.E41,
+             m1.E11*m2.E12 + m1.E12*m2.E22 + m1.E13*m2.E32 + m1.E14*m2.E42,
+             m1.E11*m2.E13 + m1.E12*m2.E23 + m1.E13*m2.E33 + m1.E14*m2.E43,
+             m1.E11*m2.E14 + m1.E12*m2.E24 + m1.E13*m2.E34 + m1.E14*m2.E44 );
 
-   m->setl2 ( m1.E21*m2.E11 + m1.E22*m2.E21 + m1.E23*m2.E31 + m1.E24*m2.E41,
-              m1.E21*m2.E12 + m1.E22*m2.E22 + m1.E23*m2.E32 + m1.E24*m2.E42,
-              m1.E21*m2.E13 + m1.E22*m2.E23 + m1.E23*m2.E33 + m1.E24*m2.E43,
-              m1.E21*m2.E14 + m1.E22*m2.E24 + m1.E23*m2.E34 + m1.E24*m2.E44 );
+   m.setl2 ( m1.E21*m2.E11 + m1.E22*m2.E21 + m1.E23*m2.E31 + m1.E24*m2.E41,
+             m1.E21*m2.E12 + m1.E22*m2.E22 + m1.E23*m2.E32 + m1.E24*m2.E42,
+             m1.E21*m2.E13 + m1.E22*m2.E23 + m1.E23*m2.E33 + m1.E24*m2.E43,
+             m1.E21*m2.E14 + m1.E22*m2.E24 + m1.E23*m2.E34 + m1.E24*m2.E44 );
 
-   m->setl3 ( m1.E31*m2.E11 + m1.E32*m2.E21 + m1.E33*m2.E31 + m1.E34*m2.E41,
-              m1.E31*m2.E12 + m1.E32*m2.E22 + m1.E33*m2.E32 + m1.E34*m2.E42,
-              m1.E31*m2.E13 + m1.E32*m2.E23 + m1.E33*m2.E33 + m1.E34*m2.E43,
-              m1.E31*m2.E14 + m1.E32*m2.E24 + m1.E33*m2.E34 + m1.E34*m2.E44 );
+   m.setl3 ( m1.E31*m2.E11 + m1.E32*m2.E21 + m1.E33*m2.E31 + m1.E34*m2.E41,
+             m1.E31*m2.E12 + m1.E32*m2.E22 + m1.E33*m2.E32 + m1.E34*m2.E42,
+             m1.E31*m2.E13 + m1.E32*m2.E23 + m1.E33*m2.E33 + m1.E34*m2.E43,
+             m1.E31*m2.E14 + m1.E32*m2.E24 + m1.E33*m2.E34 + m1.E34*m2.E44 );
 
-   m->setl4 ( m1.E41*m2.E11 + m1.E42*m2.E21 + m1.E43*m2.E31 + m1.E44*m2.E41,
-              m1.E41*m2.E12 + m1.E42*m2.E22 + m1.E43*m2.E32 + m1.E44*m2.E42,
-              m1.E41*m2.E13 + m1.E42*m2.E23 + m1.E43*m2.E33 + m1.E44*m2.E43,
-              m1.E41*m2.E14 + m1.E42*m2.E24 + m1.E43*m2.E34 + m1.E44*m2.E44 );
+   m.setl4 ( m1.E41*m2.E11 + m1.E42*m2.E21 + m1.E43*m2.E31 + m1.E44*m2.E41,
+             m1.E41*m2.E12 + m1.E42*m2.E22 + m1.E43*m2.E32 + m1.E44*m2.E42,
+             m1.E41*m2.E13 + m1.E42*m2.E23 + m1.E43*m2.E33 + m1.E44*m2.E43,
+             m1.E41*m2.E14 + m1.E42*m2.E24 + m1.E43*m2.E34 + m1.E44*m2.E44 );
 
-   if ( m!=this ) { *this=*m; delete m; }
+   if ( &m!=this ) *this=m;
+   # endif
  }
 
 void GsMat::add ( const GsMat& m1, const GsMat& m2 )
@@ -527,29 +607,7 @@ void GsMat::operator *= ( float r )
 
 void GsMat::operator *= ( const GsMat& m )
  {
-   GsMat* t = (this==&m)? new GsMat(GsMat::NoInit) : this;
-
-   t->setl1 ( E11*m.E11 + E12*m.E21 + E13*m.E31 + E14*m.E41,
-              E11*m.E12 + E12*m.E22 + E13*m.E32 + E14*m.E42,
-              E11*m.E13 + E12*m.E23 + E13*m.E33 + E14*m.E43,
-              E11*m.E14 + E12*m.E24 + E13*m.E34 + E14*m.E44 );
-
-   t->setl2 ( E21*m.E11 + E22*m.E21 + E23*m.E31 + E24*m.E41,
-              E21*m.E12 + E22*m.E22 + E23*m.E32 + E24*m.E42,
-              E21*m.E13 + E22*m.E23 + E23*m.E33 + E24*m.E43,
-              E21*m.E14 + E22*m.E24 + E23*m.E34 + E24*m.E44 );
-
-   t->setl3 ( E31*m.E11 + E32*m.E21 + E33*m.E31 + E34*m.E41,
-              E31*m.E12 + E32*m.E22 + E33*m.E32 + E34*m.E42,
-              E31*m.E13 + E32*m.E23 + E33*m.E33 + E34*m.E43,
-              E31*m.E14 + E32*m.E24 + E33*m.E34 + E34*m.E44 );
-
-   t->setl4 ( E41*m.E11 + E42*m.E21 + E43*m.E31 + E44*m.E41,
-              E41*m.E12 + E42*m.E22 + E43*m.E32 + E44*m.E42,
-              E41*m.E13 + E42*m.E23 + E43*m.E33 + E44*m.E43,
-              E41*m.E14 + E42*m.E24 + E43*m.E34 + E44*m.E44 );
-
-   if ( t!=this ) { *this=*t; delete t; }
+   mult ( *this, m );
  }
 
 void GsMat::operator += ( const GsMat& m )
@@ -576,8 +634,29 @@ GsMat operator * ( float r, const GsMat& m )
                   m.E41*r, m.E42*r, m.E43*r, m.E44*r );
  }
 
+# if defined(GS_MAT_SSE)
+// x*l1 + y*l2 + z*l3 + l4, in the order of the scalar code
+static inline GsVec mult_lines ( const GsVec& v, __m128 l1, __m128 l2, __m128 l3, __m128 l4 )
+ {
+   __m128 r = _mm_mul_ps ( l1, _mm_set1_ps(v.x) );
+   r = _mm_add_ps ( r, _mm_mul_ps(l2,_mm_set1_ps(v.y)) );
+   r = _mm_add_ps ( r, _mm_mul_ps(l3,_mm_set1_ps(v.z)) );
+   r = _mm_add_ps ( r, l4 );
+   float f[4];
+   _mm_storeu_ps ( f, r );
+   GsVec p ( f[0], f[1], f[2] );
+   if ( f[3]!=0.0 && f[3]!=1.0 ) p/=f[3];
+   return p;
+ }
+# endif
+
 GsVec operator * ( const GsMat& m, const GsVec& v )
  {
+   # if defined(GS_MAT_SSE)
+   __m128 c1=_mm_loadu_ps(m.e), c2=_mm_loadu_ps(m.e+4), c3=_mm_loadu_ps(m.e+8), c4=_mm_loadu_ps(m.e+12);
+   _MM_TRANSPOSE4_PS ( c1, c2, c3, c4 ); // columns of m
+   return mult_lines ( v, c1, c2, c3, c4 );
+   # else
    GsVec r ( m.E11*v.x + m.E12*v.y + m.E13*v.z + m.E14,
              m.E21*v.x + m.E22*v.y + m.E23*v.z + m.E24,
              m.E31*v.x + m.E32*v.y + m.E33*v.z + m.E34  );
@@ -585,10 +664,14 @@ GsVec operator * ( const GsMat& m, const GsVec& v )
    float w = m.E41*v.x + m.E42*v.y + m.E43*v.z + m.E44;
    if ( w!=0.0 && w!=1.0 ) r/=w;
    return r;
+   # endif
  }
 
 GsVec operator * ( const GsVec& v, const GsMat& m )
  {
+   # if defined(GS_MAT_SSE)
+   return mult_lines ( v, _mm_loadu_ps(m.e), _mm_loadu_ps(m.e+4), _mm_loadu_ps(m.e+8), _mm_loadu_ps(m.e+12) );
+   # else
    GsVec r ( m.E11*v.x + m.E21*v.y + m.E31*v.z + m.E41,
              m.E12*v.x + m.E22*v.y + m.E32*v.z + m.E42,
              m.E13*v.x + m.E23*v.y + m.E33*v.z + m.E43  );
@@ -596,6 +679,7 @@ GsVec operator * ( const GsVec& v, const GsMat& m )
    float w = m.E14*v.x + m.E24*v.y + m.E34*v.z + m.E44;
    if ( w!=0.0 && w!=1.0 ) r/=w;
    return r;
+   # endif
  }
 
 GsMat operator * ( const GsMat& m1, const GsMat& m2 )
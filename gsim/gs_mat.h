@@ -28,7 +28,13 @@
     mathematical notation. In column-major format, the first
     three elements of the last line represent the translation
     vector (m[12],m[13],m[14]); in line-major format, the 
-    translation vector is in the last column (m[3],m[7],m[11]). */
+    translation vector is in the last column (m[3],m[7],m[11]).
+    The products with matrices and vectors, transpose() and inverse() use
+    SSE instructions when the compiler targets them and GS_NO_SSE is not
+    defined. They perform the same operations in the same order as the scalar
+    code, so the results are identical, unless the compiler fuses products and
+    additions (e.g. gcc with -mfma), what can change each element by 1 ulp of
+    its largest term. */
 class GsMat
  { public :
     /*! A union is used so that the elements of the matrix can
@@ -291,7 +297,8 @@ class GsMat
     void ortho ( float left, float right, float bottom, float top, float near, float far );
 
     /*! Fast invertion by direct calculation, no loops, no gauss, no pivot searching, 
-        but with more numerical errors. The result is returned in the 'inv' parameter. */
+        but with more numerical errors. The result is returned in the 'inv' parameter,
+        which can be this matrix. If the determinant is 0 inv is not changed. */
     void inverse ( GsMat& inv ) const;
 
     /*! Returns the inverse in a new matrix returned by value, callinf the inverse(GsMat&) method*/
@@ -314,7 +321,8 @@ class GsMat
     float norm () const;
 
     /*! Set GsMat to be the result of the multiplication of m1 with m2.
-        This method is safe if one of the given parameters is equal to 'this'. */
+        This method is safe if one of the given parameters is equal to 'this',
+        and does not allocate memory. */
     void mult ( const GsMat& m1, const GsMat& m2 );
 
     /*! Sets GsMat to be the addition of m1 with m2. */
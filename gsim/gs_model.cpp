@@ -6,12 +6,17 @@
   =======================================================================*/
 
 # include <stdlib.h>
+# include <string.h>
+# include <math.h>
 # include <iostream>
+# include <algorithm>
 
 # include <gsim/gs_model.h>
 # include <gsim/gs_tree.h>
 # include <gsim/gs_quat.h>
 # include <gsim/gs_strings.h>
+# include <gsim/gs_parallel.h>
+# include <gsim/gs_transform.h>
 
 //# define GS_USE_TRACE1 // IO
 //# define GS_USE_TRACE2 // Validation of normals materials, etc
@@ -45,12 +50,6 @@ void GsModel::init ()
    Ft.capacity ( 0 );
    mtlnames.capacity ( 0 );
    name = "";
-
-   while ( textures.size() )
-    { gs_string_delete ( textures.top().fname );
-      gs_string_delete ( textures.top().fullfname );
-      textures.pop();
-    }
    textures.capacity(0);
  }
 
@@ -186,113 +185,221 @@ void GsModel::remove_redundant_materials ()
     }
  }
 
-void GsModel::remove_redundant_normals ( float prec )
+//================================ PointGrid =================================
+
+/* Uniform grid with hashed cells, used to find the points closer than the cell
+   size to a given point by visiting the 27 cells around it. Point indices are
+   grouped per cell with a counting sort, each cell keeping its points in
+   increasing index order. */
+class PointGrid
+ { private :
+    struct Cell { int64_t x, y, z; int start, count; };
+    GsArray<Cell> _table; // open addressing hash table, count<0 marks free entries
+    GsArray<int> _ids;    // point indices sorted by cell
+    unsigned _mask;
+    double _inv;
+
+    static int64_t coord ( float x, double inv )
+     { const double lim = 4.0e18;
+       double d = double(x)*inv;
+       if ( !(d>-lim) ) d=-lim; // also handles NaN
+       if ( d>lim ) d=lim;
+       d = floor ( d );
+       return (int64_t)d;
+     }
+    static unsigned hash ( int64_t x, int64_t y, int64_t z )
+     { uint64_t h = uint64_t(x)*0x9E3779B97F4A7C15ull ^ uint64_t(y)*0xC2B2AE3D27D4EB4Full ^ uint64_t(z)*0x165667B19E3779F9ull;
+       return unsigned ( h ^ (h>>29) ^ (h>>47) );
+     }
+    int slot ( int64_t x, int64_t y, int64_t z, bool insert )
+     { unsigned k = hash(x,y,z)&_mask;
+       while ( true )
+        { Cell& c = _table[k];
+          if ( c.count<0 )
+           { if ( !insert ) return -1;
+             c.x=x; c.y=y; c.z=z; c.count=0;
+             return (int)k;
+           }
+          if ( c.x==x && c.y==y && c.z==z ) return (int)k;
+          k = (k+1)&_mask;
+        }
+     }
+
+   public :
+    /* Builds the grid for the n given points with the given cell size (>0) */
+    void build ( const GsVec* p, int n, float cellsize )
+     { int i;
+       _inv = 1.0/double(cellsize);
+       unsigned tsize=16;
+       while ( tsize<2u*unsigned(n) ) tsize*=2;
+       _mask = tsize-1;
+       _table.size ( int(tsize) );
+       for ( i=0; i<(int)tsize; i++ ) _table[i].count=-1;
+
+       GsArray<int> pcell ( n );
+       for ( i=0; i<n; i++ )
+        { int k = slot ( coord(p[i].x,_inv), coord(p[i].y,_inv), coord(p[i].z,_inv), true );
+          _table[k].count++;
+          pcell[i] = k;
+        }
+       int start=0;
+       for ( i=0; i<(int)tsize; i++ )
+        { Cell& c = _table[i];
+          if ( c.count<0 ) continue;
+          c.start=start; start+=c.count; c.count=0;
+        }
+       _ids.size ( n );
+       for ( i=0; i<n; i++ )
+        { Cell& c = _table[pcell[i]];
+          _ids[c.start+c.count++] = i;
+        }
+     }
+
+    /* Calls f(j) for each point j in the cells touching the cell of p, in
+       increasing order of j inside each cell; returning false from f skips
+       the remaining points of the cell */
+    template <class F>
+    void neighbours ( const GsVec& p, const F& f ) const
+     { int64_t x=coord(p.x,_inv), y=coord(p.y,_inv), z=coord(p.z,_inv);
+       for ( int64_t i=x-1; i<=x+1; i++ )
+        for ( int64_t j=y-1; j<=y+1; j++ )
+         for ( int64_t k=z-1; k<=z+1; k++ )
+          { int s = const_cast<PointGrid*>(this)->slot ( i, j, k, false );
+            if ( s<0 ) continue;
+            const Cell& c = _table[s];
+            for ( int e=c.start+c.count, a=c.start; a<e; a++ ) if ( !f(_ids[a]) ) break;
+          }
+     }
+ };
+
+/* Computes in rep[i] the index of the point representing point i: the
+   points are visited in order, and each one is either mapped to the lowest
+   index representative closer than prec, or becomes a new representative.
+   With parallel set, the closest lower neighbours are searched in parallel
+   and the result is the same. Returns the number of representatives. */
+static int find_representatives ( const GsVec* p, int n, float prec, GsArray<int>& rep, bool parallel )
  {
-   int i, j, k;
-   GsArray<int> iarray;
+   int i, nrep=0;
+   rep.size ( n );
+   if ( n==0 ) return 0;
+   if ( !(prec>0) ) // nothing can be closer than prec
+    { for ( i=0; i<n; i++ ) rep[i]=i;
+      return n;
+    }
+
+   float prec2 = prec*prec;
+   PointGrid grid;
+   grid.build ( p, n, prec );
+
+   // lowest representative closer than prec, or i if none:
+   auto lowestrep = [&] ( int i )
+    { int best=i;
+      grid.neighbours ( p[i], [&](int j)
+       { if ( j>=best ) return false; // no lower points left in this cell
+         if ( rep[j]==j && dist2(p[i],p[j])<prec2 ) best=j;
+         return true;
+       } );
+      return best;
+    };
+
+   if ( !parallel )
+    { for ( i=0; i<n; i++ )
+       { rep[i] = lowestrep(i);
+         if ( rep[i]==i ) nrep++;
+       }
+      return nrep;
+    }
+
+   // the lowest closer point is a good candidate and is searched in parallel:
+   GsArray<int> low ( n );
+   gs_parallel_blocks ( n, 4096, [&](int b, int e)
+    { for ( int i=b; i<e; i++ )
+       { int best=i;
+         grid.neighbours ( p[i], [&](int j)
+          { if ( j>=best ) return false;
+            if ( dist2(p[i],p[j])<prec2 ) best=j;
+            return true;
+          } );
+         low[i] = best;
+       }
+    } );
+
+   // then the representatives are decided in order:
+   for ( i=0; i<n; i++ )
+    { if ( low[i]==i ) rep[i]=i; // no lower point closer than prec
+      else if ( rep[low[i]]==low[i] ) rep[i]=low[i]; // it is the lowest one and is a representative
+      else rep[i] = lowestrep(i); // rare case: needs a new search
+      if ( rep[i]==i ) nrep++;
+    }
+   return nrep;
+ }
 
-   prec = prec*prec;
+//============================ redundant elements ============================
 
+void GsModel::remove_redundant_normals ( float prec )
+ {
    int fsize = F.size();
    int nsize = N.size();
+   int i;
 
    if ( nsize==0 || Fn.size()!=fsize )
     { N.size(0); 
       Fn.size(0);
+      return;
     }
-   else if ( nsize==1 )
-    { // nothing to test, only 1 normal
-    }
-   else
-    { // remove references to duplicated normals
-      iarray.size ( nsize );
-      iarray.setall ( -1 );
-      for ( i=0; i<nsize; i++ ) 
-       { for ( j=i+1; j<nsize; j++ ) 
-          { if ( iarray[j]>=0 ) continue;
-            if ( dist2(N[i],N[j])<prec )
-             { GS_TRACE2 ( "Detected normal "<<i<<" close to "<<j );
-               iarray[j]=i;
-               for ( k=0; k<fsize; k++ ) // replace references to j by i
-                { if ( Fn[k].a==j ) Fn[k].a=i;
-                  if ( Fn[k].b==j ) Fn[k].b=i;
-                  if ( Fn[k].c==j ) Fn[k].c=i;
-                }
-             }
-          }
-       }
 
-      int toadd = 0;
-      for ( i=0; i<iarray.size(); i++ ) 
-       { if ( iarray[i]>=0 )
-          { GS_TRACE2 ( "Detected unused normal "<<i );
-            toadd++;
-            iarray[i]=-1; // unused mark is now -1
-          }
-         else
-          iarray[i] = toadd;
-       }
+   // map each normal to its representative:
+   GsArray<int> iarray;
+   int nrep = find_representatives ( N.pt(), nsize, prec, iarray, false );
+   if ( nrep==nsize ) return;
 
-      for ( i=0; i<fsize; i++ ) // update indices
-       { Fn[i].a -= iarray[Fn[i].a];
-         Fn[i].b -= iarray[Fn[i].b];
-         Fn[i].c -= iarray[Fn[i].c];
-       }
+   // compress N, keeping the order of the representatives:
+   int ind=0;
+   for ( i=0; i<nsize; i++ )
+    { if ( iarray[i]==i ) { N[ind]=N[i]; iarray[i]=ind++; }
+       else { GS_TRACE2 ( "Detected normal "<<i<<" close to "<<iarray[i] ); iarray[i]=iarray[iarray[i]]; }
+    }
+   N.size ( ind );
 
-      for ( i=0,j=0; i<iarray.size(); i++ ) // compress N
-       { if ( iarray[i]<0 )
-          { N.remove(j); }
-         else
-          { j++; }
-       }
+   // update indices in one pass:
+   for ( i=0; i<fsize; i++ )
+    { Fn[i].a = iarray[Fn[i].a];
+      Fn[i].b = iarray[Fn[i].b];
+      Fn[i].c = iarray[Fn[i].c];
     }
  }
 
-void GsModel::merge_redundant_vertices ( float prec )
+void GsModel::merge_redundant_vertices ( float prec, bool parallel )
  {
-   prec = prec*prec;
-   
    int fsize = F.size();
    int vsize = V.size();
-   int i, j;
+   int i;
 
-   // build iarray marking replacements:
+   // map each vertex to its representative:
    GsArray<int> iarray;
-   iarray.size ( vsize );
-   for ( i=0; i<vsize; i++ ) iarray[i]=i;
-   
-   for ( i=0; i<vsize; i++ )
-    for ( j=0; j<vsize; j++ )
-     { if ( i==j ) break; // keep i < j
-       if ( dist2(V[i],V[j])<prec ) // equal
-        { iarray[j]=i;
-        }
-     }
+   int nrep = find_representatives ( V.pt(), vsize, prec, iarray, parallel );
+   if ( nrep==vsize ) return;
 
-   // fix face indices:
-   for ( i=0; i<fsize; i++ )
-    { F[i].a = iarray[ F[i].a ];
-      F[i].b = iarray[ F[i].b ];
-      F[i].c = iarray[ F[i].c ];
-    }
-
-   // compress indices:   
+   // compress vertices, keeping the order of the representatives:
    int ind=0;
-   bool newv;
    for ( i=0; i<vsize; i++ )
-    { newv = iarray[i]==i;
-      V[ind] = V[i];
-      iarray[i] = ind;
-      if ( newv ) ind++;
+    { if ( iarray[i]==i ) { V[ind]=V[i]; iarray[i]=ind++; }
+       else iarray[i] = iarray[iarray[i]]; // representatives have lower indices
     }
    V.size ( ind );
 
-   // fix face indices again:
-   for ( i=0; i<fsize; i++ )
-    { F[i].a = iarray[ F[i].a ];
-      F[i].b = iarray[ F[i].b ];
-      F[i].c = iarray[ F[i].c ];
-    }
+   // fix face indices:
+   Face* fp = F.pt();
+   const int* ip = iarray.pt();
+   auto fixfaces = [fp,ip] ( int b, int e )
+    { for ( int i=b; i<e; i++ )
+       { fp[i].a = ip[ fp[i].a ];
+         fp[i].b = ip[ fp[i].b ];
+         fp[i].c = ip[ fp[i].c ];
+       }
+    };
+   if ( parallel ) gs_parallel_blocks ( fsize, 16384, fixfaces );
+    else fixfaces ( 0, fsize );
  }
 
 bool GsModel::load ( const char* fname )
@@ -306,7 +413,10 @@ bool GsModel::load ( const char* fname )
       return load ( in );
     }
    if ( has_extension(filename,"obj") )
-    { return load_obj(fname);
+    { return load_obj_cached(fname);
+    }
+   if ( has_extension(filename,"gsmb") )
+    { return load_gsmb(fname);
     }
    else
     { if ( !in.open(fname) ) return false;
@@ -394,8 +504,8 @@ bool GsModel::load( GsInput &in )
        { textures.size(in.geti());
          for ( i=0; i<textures.size(); i++ )
           { textures[i].glid = -1;
-            textures[i].fname = gs_string_new ( in.gets() );
-            textures[i].fullfname = 0;
+            textures[i].fname = in.gets();
+            textures[i].fullfname = "";
           }
        }
       else if ( s=="textcoords" ) // read T: u v
@@ -409,15 +519,16 @@ bool GsModel::load( GsInput &in )
        }
       else if ( s=="mtlnames" ) // read materials
        { GsString buf1, buf2;
+         int last=-1; // the last index read, if any
          mtlnames.capacity ( 0 ); // clear all
          mtlnames.size ( M.size() ); // realloc
          while ( true )
           { if ( in.get()!=GsInput::Number ) { in.unget(); break; }
-            i = in.ltoken().atoi();
+            last = in.ltoken().atoi();
             in.get();
-            mtlnames.set ( i, in.ltoken() );
+            mtlnames.set ( last, in.ltoken() );
           }
-         if ( mtlnames.size()>0 && in.filename() && has_extension(mtlnames[i],"mt") )
+         if ( last>=0 && last<mtlnames.size() && in.filename() && has_extension(mtlnames[last],"mt") )
           { mtlpath=in.filename();
             extract_filename(mtlpath,s);
           }
@@ -478,11 +589,11 @@ float GsModel::count_mean_vertex_degree ()
  }
 
 
-int GsModel::common_vertices_of_faces ( int i1, int i2 )
+int GsModel::common_vertices_of_faces ( int i1, int i2 ) const
  {
    int i, j, c=0;
-   int *f1 = &(F[i1].a);
-   int *f2 = &(F[i2].a);
+   const int *f1 = &(F[i1].a);
+   const int *f2 = &(F[i2].a);
    for ( i=0; i<3; i++ )
     { for ( j=0; j<3; j++ )
        { if ( f1[i]==f2[j] ) c++; //gsout<<i<<","<<j<<gspc;
@@ -524,79 +635,6 @@ void GsModel::clear_textures ()
    T.compress();
  }
 
-//v:current vtx, vi:vertices around v indicating the faces around v, vec:just a buffer
-static void gen_normal ( int v, GsArray<GsVec>& vec, GsArray<int>& vi, GsModel *self, float crease_angle )
- {
-   int i, j, tmp;
-   float ang;
-
-   vec.size(vi.size());
-
-   //gsout<<"original:\n";
-   //for ( i=0; i<vi.size(); i++ ) gsout<<self->F[vi[i]].a<<","<<self->F[vi[i]].b<<","<<self->F[vi[i]].c<<gsnl;
-
-   // order faces around vertex (could use qsort in GsArray):
-   for ( i=0; i<vi.size(); i++ )
-    { for ( j=i+1; j<vi.size(); j++ )
-       { if ( self->common_vertices_of_faces(vi[i],vi[j])==2 ) // share an edge
-	      { GS_SWAP(vi[i+1],vi[j]);
-            break;
-	      }
-       }
-    }
-
-   // gen normals for each face around v:
-   for ( i=0; i<vi.size(); i++ ) 
-    { vec[i]= self->face_normal ( vi[i] ); }
-
-   // search for the first edge with a big angle and rearrange array, so
-   // that the array starts with a "crease angled edge":
-   bool angfound = false;
-   for ( i=0; i<vec.size(); i++ )
-    { ang = angle ( vec[i], vec[(i+1)%vec.size()]);
-      if ( ang>crease_angle ) 
-       { for ( j=0; j<=i; j++ ) { vec.push()=vec[j]; vi.push()=vi[j]; }
-	     vec.remove ( 0, i+1 );
-	     vi.remove ( 0, i+1 );
-         angfound = true;
-         break;
-       }
-    }
-   if ( !angfound ) return; // no crease angles in this face cluster
-
-   // Finally set the normals:
-   GsVec n;
-   float x=1.0f;
-   int init=0;
-   GsArray<GsVec>& N = self->N;
-   for ( i=0; i<vec.size(); i++ )
-    { ang = angle ( vec[i], vec[(i+1)%vec.size()]);
-
-      if ( ang>crease_angle )
-       { n = GsVec::null;
-         x = 0.0f;
-         for ( j=init; j<=i; j++ ) { n+=vec[j]; x=x+1.0f; }
-         n /= x; // n is the mean normal of the previous set of smoothed faces around v
-
-         for ( j=init; j<=i; j++ ) 
-          { GsModel::Face &fn=self->Fn[vi[j]];
-            /*if ( f.n<0 ) 
-              { f.n=N.size(); N.insert(N.size(),3); N[f.n]=N[f.a]; N[f.n+1]=N[f.b]; N[f.n+2]=N[f.c]; }
-            if ( v==f.a ) N[f.n]=n;
-	         else if ( v==f.b ) N[f.n+1]=n;
-	          else N[f.n+2]=n;
-            */
-            if ( v==fn.a ) fn.a = N.size();
-	         else if ( v==fn.b ) fn.b = N.size();
-	          else fn.c = N.size();
-            N.push() = n;
-          }
-
-         init = i+1;
-       }
-    } 
- }
-
 void GsModel::get_face_vertices ( GsArray<GsVec>& fv ) const
  { 
    fv.size ( F.size()*3 );
@@ -672,105 +710,204 @@ void GsModel::invert_normals ()
    for ( i=0; i<N.size(); i++ ) N[i]*=-1.0;
  }
 
-struct VertexNode : public GsTreeNode // only internally used
- { int v, i, f;
-   VertexNode ( int a, int b, int c ) : v(a), i(b), f(c) {}
-   VertexNode () { v=i=f=0; }
-   VertexNode ( const VertexNode& x ) : GsTreeNode(), v(x.v), i(x.i), f(x.f) {}
-  ~VertexNode () {}
-   friend GsOutput& operator<< ( GsOutput& out, const VertexNode& /*v*/ ) { return out; };
-   friend GsInput& operator>> ( GsInput& inp, VertexNode& /*v*/ ) { return inp; }
-   static inline int compare ( const VertexNode* v1, const VertexNode* v2 )
-    { return v1->v!=v2->v ? v1->v-v2->v   // vertices are different
-                          : v1->i-v2->i;  // vertices are equal: use index i
+void GsModel::vertex_faces ( VertexFaces& vf ) const
+ {
+   int i, vsize=V.size(), fsize=F.size();
+
+   // count the faces around each vertex:
+   vf.start.size ( vsize+1 );
+   vf.start.setall ( 0 );
+   const Face* fp = F.pt();
+   int* start = vf.start.pt();
+   for ( i=0; i<fsize; i++ )
+    { start[fp[i].a+1]++;
+      start[fp[i].b+1]++;
+      start[fp[i].c+1]++;
     }
- };
+   for ( i=0; i<vsize; i++ ) start[i+1]+=start[i];
+
+   // place the faces, which remain in increasing order for each vertex:
+   vf.faces.size ( 3*fsize );
+   int* faces = vf.faces.pt();
+   GsArray<int> pos ( vsize );
+   memcpy ( pos.pt(), start, sizeof(int)*(size_t)vsize );
+   for ( i=0; i<fsize; i++ )
+    { faces[pos[fp[i].a]++] = i;
+      faces[pos[fp[i].b]++] = i;
+      faces[pos[fp[i].c]++] = i;
+    }
+ }
+
+/* Orders the k faces fi around vertex v so that consecutive faces share an
+   edge whenever possible: after face i comes the first of the following
+   faces sharing an edge with it. Small fans test all following faces, and
+   larger ones find the faces sharing a vertex in the other corners of the
+   faces, sorted by vertex, so that the order takes O(k log k) time instead
+   of O(k^2). The arrays are work memory of the caller. */
+static void order_faces ( const GsModel* m, int v, int* fi, int k, GsArray<gsuint64>& corners, GsArray<int>& work )
+ {
+   int i, c, l, tmp;
+   if ( k<=16 ) // faster than sorting for the usual fans
+    { for ( i=0; i+1<k; i++ )
+       { for ( l=i+1; l<k; l++ )
+          { if ( m->common_vertices_of_faces(fi[i],fi[l])==2 ) // share an edge
+             { GS_SWAP(fi[i+1],fi[l]);
+               break;
+             }
+          }
+       }
+      return;
+    }
+   work.size ( 3*k );
+   int* face = work.pt();  // the faces of fi, indexed by l
+   int* loc = face+k;      // the l at each position of fi
+   int* pos = loc+k;       // the position of each l in fi
+
+   // the corners of each face other than v, as (vertex,l) sorted by vertex:
+   corners.size ( 0 );
+   for ( l=0; l<k; l++ )
+    { face[l]=fi[l]; loc[l]=l; pos[l]=l;
+      const int* f = &(m->F[fi[l]].a);
+      for ( c=0; c<3; c++ ) if ( f[c]!=v ) corners.push() = (gsuint64(f[c])<<32) | gsuint64(l);
+    }
+   gsuint64* cb = corners.pt();
+   gsuint64* ce = cb+corners.size();
+   std::sort ( cb, ce );
+
+   for ( i=0; i+1<k; i++ )
+    { int cur=loc[i], best=k;
+      const int* f = &(m->F[face[cur]].a);
+      for ( c=0; c<3; c++ )
+       { if ( f[c]==v ) continue;
+         for ( gsuint64* p=std::lower_bound(cb,ce,gsuint64(f[c])<<32); p<ce && int(*p>>32)==f[c]; p++ )
+          { l = int(*p&0xFFFFFFFF);
+            if ( pos[l]>i && pos[l]<best && m->common_vertices_of_faces(face[cur],face[l])==2 ) best=pos[l]; // share an edge
+          }
+       }
+      if ( best<k ) // moves the face to position i+1
+       { l=loc[best]; int n=loc[i+1];
+         loc[i+1]=l; pos[l]=i+1;
+         loc[best]=n; pos[n]=best;
+       }
+    }
+   for ( i=0; i<k; i++ ) fi[i]=face[loc[i]];
+ }
 
-static void insertv ( GsTree<VertexNode>& t, GsArray<int>& vi, int v, int f )
+/* Orders the k faces fi around vertex v with order_faces(), then splits
+   them in groups at the edges with an angle larger than crease_angle.
+   Group g gets normal gn[g] and the face at position j of the sorted fi is
+   in group gid[j]. Returns the number of groups, or 0 if no crease angle
+   was found. */
+static int crease_groups ( const GsModel* m, int v, const GsVec* fnormal, int* fi, int k, float crease_angle,
+                           int* gid, GsVec* gn, GsArray<gsuint64>& corners, GsArray<int>& work )
  {
-   // array vi is only used to generated a suitable tree key sorting the vertices.
-   VertexNode *n = new VertexNode(v,++vi[v],f);
-   if ( !t.insert(n) ) std::cout<<"Wrong faces in GsModel::smooth ()!\n";
+   int i, j;
+
+   // order faces around vertex:
+   order_faces ( m, v, fi, k, corners, work );
+
+   // search for the first edge with a big angle and rotate the faces so
+   // that the array starts after a "crease angled edge":
+   for ( i=0; i<k; i++ )
+    { if ( angle(fnormal[fi[i]],fnormal[fi[(i+1)%k]])>crease_angle ) break;
+    }
+   if ( i==k ) return 0; // no crease angles in this face cluster
+   std::rotate ( fi, fi+i+1, fi+k );
+
+   // set the mean normal of each group of smoothed faces:
+   int ng=0, init=0;
+   for ( i=0; i<k; i++ )
+    { if ( angle(fnormal[fi[i]],fnormal[fi[(i+1)%k]])>crease_angle )
+       { GsVec n = GsVec::null;
+         for ( j=init; j<=i; j++ ) { n+=fnormal[fi[j]]; gid[j]=ng; }
+         gn[ng++] = n / float(i-init+1);
+         init = i+1;
+       }
+    }
+   return ng;
  }
 
-// there is certainly a more efficient way to implement the function below...:
 void GsModel::smooth ( float crease_angle )
  {
-   int v, i;
-   GsTree<VertexNode> t;
-   GsArray<int> vi;
-   GsArray<GsVec> vec; // this is just a buffer to be used in gen_normal()
-
    if ( !V.size() || !F.size() ) return;
 
-   Fn.size ( F.size() );
+   int vsize=V.size(), fsize=F.size();
+   Fn = F;
 
-   vi.size(V.size());
-   for ( i=0; i<vi.size(); i++ ) vi[i]=0;
+   VertexFaces vf;
+   vertex_faces ( vf );
+   const int* start = vf.start.pt();
+   int* faces = vf.faces.pt();
 
-   for ( i=0; i<F.size(); i++ )
-    { insertv ( t, vi, F[i].a, i );
-      insertv ( t, vi, F[i].b, i );
-      insertv ( t, vi, F[i].c, i );
-      Fn[i].a = F[i].a;
-      Fn[i].b = F[i].b;
-      Fn[i].c = F[i].c;
-    }
+   GsArray<GsVec> fnormal ( fsize );
+   gs_parallel_blocks ( fsize, 4096, [&](int b, int e)
+    { for ( int f=b; f<e; f++ ) fnormal[f]=face_normal(f); } );
 
    // first pass will interpolate face normals around each vertex:
-   N.size ( V.size() );
-   vi.size(0);
-   t.gofirst ();
-   while ( t.cur()!=GsTreeNode::null )
-    { v = t.cur()->v;
-      vi.push() = t.cur()->f;
-      t.gonext();
-      if ( t.cur()==GsTreeNode::null || v!=t.cur()->v )
+   N.size ( vsize );
+   gs_parallel_blocks ( vsize, 2048, [&](int b, int e)
+    { for ( int v=b; v<e; v++ )
        { GsVec n = GsVec::null;
-         for ( i=0; i<vi.size(); i++ ) n += face_normal ( vi[i] );
-         N[v] = n / (float)vi.size();
-         vi.size(0);
+         int k = start[v+1]-start[v];
+         for ( int i=start[v]; i<start[v+1]; i++ ) n += fnormal[faces[i]];
+         N[v] = k? n/float(k) : n;
        }
-    }
+    } );
 
    if ( crease_angle<0 ) return; // only smooth everything
 
-   // second pass will solve crease angles:
-   vi.size(0);
-   t.gofirst();
-   while ( t.cur()!=GsTreeNode::null )
-    { v = t.cur()->v;
-      vi.push() = t.cur()->f;
-      t.gonext();
-      if ( t.cur()==GsTreeNode::null || v!=t.cur()->v )
-       { gen_normal ( v, vec, vi, this, crease_angle );
-         vi.size(0);
+   // second pass will solve crease angles, first finding the groups of each vertex:
+   GsArray<int> gid ( vf.faces.size() );
+   GsArray<GsVec> gn ( vf.faces.size() );
+   GsArray<int> ng ( vsize+1 );
+   gs_parallel_blocks ( vsize, 1024, [&](int b, int e)
+    { GsArray<gsuint64> corners; // work memory of the block
+      GsArray<int> work;
+      for ( int v=b; v<e; v++ )
+       { int s = start[v];
+         ng[v] = crease_groups ( this, v, fnormal.pt(), faces+s, start[v+1]-s, crease_angle, &gid[s], &gn[s], corners, work );
+       }
+    } );
+
+   // new normals are appended in vertex order:
+   int i, nbase=vsize;
+   for ( i=0; i<vsize; i++ ) { int n=ng[i]; ng[i]=nbase; nbase+=n; }
+   ng[vsize] = nbase;
+   N.size ( nbase );
+
+   // then each vertex sets its group normals and its corner in the faces around it:
+   gs_parallel_blocks ( vsize, 1024, [&](int b, int e)
+    { for ( int v=b; v<e; v++ )
+       { int s=start[v], base=ng[v];
+         if ( ng[v+1]==base ) continue;
+         for ( int g=0; g<ng[v+1]-base; g++ ) N[base+g]=gn[s+g];
+         for ( int i=s; i<start[v+1]; i++ )
+          { int f=faces[i], n=base+gid[i];
+            Face& fn = Fn[f];
+            const Face& fv = F[f];
+            if ( fv.a==v && fn.a==v ) fn.a = n; // only corner v of the face is written
+             else if ( fv.b==v && fn.b==v ) fn.b = n;
+              else fn.c = n;
+          }
        }
-    }
-//std::cout<<"A\n";
+    } );
+
    remove_redundant_normals ();
-//std::cout<<"B\n";
    compress ();
-//std::cout<<"C\n";
  }
 
 void GsModel::translate ( const GsVec &tr )
  {
-   int i, s=V.size();
-   for ( i=0; i<s; i++ ) V[i]+=tr;
+   gs_translate_points ( tr, V.pt(), V.pt(), V.size() );
  }
 
 void GsModel::scale ( float factor )
  {
-   int i, s=V.size();
-   for ( i=0; i<s; i++ ) V[i]*=factor;
+   gs_scale_points ( factor, V.pt(), V.pt(), V.size() );
  }
 
 void GsModel::transform ( const GsMat& mat, bool primtransf )
  {
-   int i, size;
-   GsMat m = mat;
-
    if ( primtransf )
     { GsQuat q(mat);
       GsVec t(&mat[12]);
@@ -779,24 +916,14 @@ void GsModel::transform ( const GsMat& mat, bool primtransf )
       return;
     }
 
-   size = V.size();
-   for ( i=0; i<size; i++ ) V[i] = m * V[i];
-
-   size = N.size();
-   if ( size<=0 ) return;
-   
-   // ok, apply to N:
-   m.setl4 ( 0, 0, 0, 1 ); // remove translation
-   for ( i=0; i<size; i++ ) { N[i]= m*N[i]; N[i].normalize(); }
+   gs_transform_points ( mat, V.pt(), V.pt(), V.size() );
+   gs_transform_vectors ( mat, N.pt(), N.pt(), N.size(), true ); // without translation
  }
  
 void GsModel::rotate ( const GsQuat& q )
  {
-   int i, size;
-   size = V.size();
-   for ( i=0; i<size; i++ ) V[i] = q.apply(V[i]);
-   size = N.size();
-   for ( i=0; i<size; i++ ) N[i] = q.apply(N[i]);
+   gs_rotate_vectors ( q, V.pt(), V.pt(), V.size() );
+   gs_rotate_vectors ( q, N.pt(), N.pt(), N.size() );
  }
 
 //================================ End of File =================================================
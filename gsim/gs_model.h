@@ -24,6 +24,7 @@ class GsPolygon;
 # include <gsim/gs_array.h>
 # include <gsim/gs_string.h>
 # include <gsim/gs_strings.h>
+# include <gsim/gs_class_array.h>
 # include <gsim/gs_material.h>
 
 /*! \class GsModel gs_model.h
@@ -76,13 +77,24 @@ class GsModel
 
     /*! Structure to keep texture information */
      struct Texture
-     { int glid;        //!< the OGL texture id, or: -1 if id not yet set, -2 if could not load texture
-       char* fname;     //!< texture filename as read from model file
-       char* fullfname; //!< full path of loaded/"tried to load" filename, or empty if not loaded
+     { int glid;           //!< the OGL texture id, or: -1 if id not yet set, -2 if could not load texture
+       GsString fname;     //!< texture filename as read from model file
+       GsString fullfname; //!< full path of loaded/"tried to load" filename, or empty if not loaded
+       Texture () { glid=-1; }
      };
 
     /*! Contain the list of textures being used */
-    GsArray<Texture> textures;
+    GsClassArray<Texture> textures;
+
+    /*! Vertex to face adjacency in compressed row format: the faces around
+        vertex v are faces[start[v]] to faces[start[v+1]-1], in increasing order.
+        A face appears once for each of its corners using v. */
+    struct VertexFaces
+     { GsArray<int> start; //!< V.size()+1 offsets in faces
+       GsArray<int> faces; //!< 3*F.size() face indices grouped by vertex
+       int size ( int v ) const { return start[v+1]-start[v]; }
+       const int* operator[] ( int v ) const { return &faces[start[v]]; }
+     };
 
    public :
 
@@ -107,14 +119,23 @@ class GsModel
     /*! Removes unreferenced or duplicated materials. */
     void remove_redundant_materials ();
 
-    /*! Removes redundant normals, which are very close or equal to each other. */
+    /*! Removes redundant normals, which are very close or equal to each other.
+        Each normal is replaced by the lowest index kept normal closer than prec,
+        using the same hashed grid as merge_redundant_vertices(), and Fn is
+        updated in a single pass. */
     void remove_redundant_normals ( float prec=gstiny );
 
-    /*! Check and remove redundant vertices */
-    void merge_redundant_vertices ( float prec=gstiny );
+    /*! Merges vertices closer than prec. Vertices are visited in order and each one is
+        either replaced by the lowest index kept vertex closer than prec, or is kept.
+        Kept vertices are found with a hashed grid of cell size prec, so that the method
+        runs in linear time for well distributed vertices. If parallel is true the
+        neighbour searches are distributed with gs_parallel_for(), with the same result.
+        Only V and F are updated. */
+    void merge_redundant_vertices ( float prec=gstiny, bool parallel=false );
 
-    /*! Checks the extension to be "obj" or "3ds", calling the apropiate importer,
+    /*! Checks the extension to be "obj" or "gsmb", calling the apropiate importer,
         or otherwise it will load a GsModel in .m (or old .srm) format.
+        The .obj files are loaded with load_obj_cached().
         The given filename is stored and can be accessed later on
         with filename() */
     bool load ( const char* filename );
@@ -124,9 +145,41 @@ class GsModel
     bool load ( GsInput& in );
 
     /*! This method imports a model in .obj format. If the import
-        is succesfull, true is returned, otherwise false is returned. */
+        is succesfull, true is returned, otherwise false is returned.
+        The file is memory mapped and scanned in place, without per line
+        allocations; the resulting model is identical to the one built
+        by load_obj_gsinput(). Files of 1MB or more are loaded in parallel
+        with load_obj_parallel() when more than one thread is available. */
     bool load_obj ( const char* file );
 
+    /*! Same as load_obj() but always splitting the file in nchunks newline-aligned
+        chunks that are parsed in parallel with gs_parallel_for(). If nchunks<=0,
+        4*gs_parallel_threads() chunks are used. The result is identical to the
+        serial loader. load_obj() already uses this method for large files. */
+    bool load_obj_parallel ( const char* file, int nchunks=0 );
+
+    /*! Loads an .obj file using the binary cache file with same name and extension
+        .gsmb if it is newer than the .obj and was created from an .obj with the
+        same modification time and size. Otherwise the .obj is loaded with load_obj()
+        and the cache file is written. Note that changes in .mtl files are not detected,
+        in which case the .gsmb file has to be deleted. */
+    bool load_obj_cached ( const char* file );
+
+    /*! Saves the arrays, materials and names of the model in the binary .gsmb format.
+        The given modification time and size of the source file are stored in order
+        to be checked by load_gsmb(). Returns false if the file could not be written. */
+    bool save_gsmb ( const char* file, gsuint srcmtime=0, gsuint srcsize=0 ) const;
+
+    /*! Loads a model saved with save_gsmb(). Each array is read in one block into a
+        new buffer which is then adopted by the model array. If srcmtime or srcsize
+        are not zero they must be equal to the values stored in the file, otherwise
+        false is returned and the model is left empty. */
+    bool load_gsmb ( const char* file, gsuint srcmtime=0, gsuint srcsize=0 );
+
+    /*! Original .obj importer, which reads the file line by line with GsInput.
+        It is used by load_obj() for inputs that cannot be memory mapped. */
+    bool load_obj_gsinput ( const char* file );
+
     /*! Returns 3F/2, which is the number of edges for "well connected" manifold meshes */
     int numedges () const { return 3*F.size()/2; }
    
@@ -134,7 +187,10 @@ class GsModel
     float count_mean_vertex_degree ();
 
     /*! Returns the number of common vertices between the two faces indices. */
-    int common_vertices_of_faces ( int i, int j );
+    int common_vertices_of_faces ( int i, int j ) const;
+
+    /*! Builds the faces around each vertex with a counting sort over F, in linear time. */
+    void vertex_faces ( VertexFaces& vf ) const;
 
     /*! Clear the N and Fn arrays, with compression. */
     void flat ();
@@ -178,7 +234,9 @@ class GsModel
     /*! Generates normals smoothly, respecting the given crease
         angle in radians. Compression is called in the end.
         If the crease angle is <0, it is not considered and
-        only an overall smooth is done. */
+        only an overall smooth is done. The faces around each
+        vertex are obtained with vertex_faces() and vertices
+        are processed in parallel with gs_parallel_blocks(). */
     void smooth ( float crease_angle=GS_TORAD(35.0f) );
 
     /*! Multiply all normals in N by -1 */
@@ -196,7 +254,9 @@ class GsModel
         N is transformed without translation and with renormalization.
         If parameter primtransf is true, only the rotation and translation
         in mat are aplied to the model and the primitive. If false,
-        the current primitive information, if any, is lost. */
+        the current primitive information, if any, is lost.
+        The arrays are transformed with the functions in gs_transform.h,
+        in parallel for large models. */
     void transform ( const GsMat& mat, bool primtransf=false );
 
     /*! Apply rotation in quaternion q to all vertices and normals.
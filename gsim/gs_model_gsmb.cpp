@@ -0,0 +1,195 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <stdio.h>
+# include <stdlib.h>
+# include <string.h>
+
+# include <gsim/gs_model.h>
+
+//# define GS_USE_TRACE1 // load/save
+# include <gsim/gs_trace.h>
+
+/* The .gsmb format is a binary dump of the data arrays of a GsModel, in the
+   byte order of the machine that wrote it:
+    - GsmbHeader
+    - raw arrays V, N, T, F, Fn, Ft, Fm with the sizes given in the header
+    - materials, 20 bytes each: 4 colors rgba, shininess, 0, texid (int16)
+    - strings as an int32 length followed by the chars: name, mtlnames, texture file names */
+
+struct GsmbHeader
+ { char     magic[4];  // "GSMB"
+   gsuint32 version;   // GsmbVersion
+   gsuint32 byteorder; // 0x01020304 written in the machine order
+   gsuint32 srcmtime;  // modification time of the source file, or 0
+   gsuint32 srcsize;   // size of the source file, or 0
+   gsint32  nv, nn, nt, nf, nfn, nft, nfm, nm, nmtlnames, ntextures;
+ };
+
+static const gsuint32 GsmbVersion = 1;
+static const gsuint32 GsmbByteOrder = 0x01020304;
+
+//================================ save ==================================
+
+template <class X>
+static bool write_array ( FILE* f, const GsArray<X>& a )
+ {
+   if ( a.size()==0 ) return true;
+   return fwrite ( (const void*)a.pt(), sizeof(X), (size_t)a.size(), f )==(size_t)a.size();
+ }
+
+static bool write_string ( FILE* f, const char* s )
+ {
+   gsint32 len = s? (gsint32)strlen(s):0;
+   if ( fwrite(&len,sizeof(len),1,f)!=1 ) return false;
+   return len==0 || fwrite(s,1,(size_t)len,f)==(size_t)len;
+ }
+
+bool GsModel::save_gsmb ( const char* file, gsuint srcmtime, gsuint srcsize ) const
+ {
+   FILE* f = fopen ( file, "wb" );
+   if ( !f ) return false;
+   GS_TRACE1 ( "Saving " << file );
+
+   GsmbHeader h;
+   memcpy ( h.magic, "GSMB", 4 );
+   h.version = GsmbVersion;
+   h.byteorder = GsmbByteOrder;
+   h.srcmtime = srcmtime;
+   h.srcsize = srcsize;
+   h.nv=V.size(); h.nn=N.size(); h.nt=T.size(); h.nf=F.size();
+   h.nfn=Fn.size(); h.nft=Ft.size(); h.nfm=Fm.size(); h.nm=M.size();
+   h.nmtlnames=mtlnames.size(); h.ntextures=textures.size();
+
+   bool ok = fwrite(&h,sizeof(h),1,f)==1;
+   ok = ok && write_array(f,V) && write_array(f,N) && write_array(f,T) && write_array(f,F) &&
+              write_array(f,Fn) && write_array(f,Ft) && write_array(f,Fm);
+
+   int i;
+   for ( i=0; ok && i<M.size(); i++ )
+    { const GsMaterial& m = M[i];
+      gsbyte b[20];
+      memcpy ( b, &m.ambient, 4 );
+      memcpy ( b+4, &m.diffuse, 4 );
+      memcpy ( b+8, &m.specular, 4 );
+      memcpy ( b+12, &m.emission, 4 );
+      b[16] = m.shininess;
+      b[17] = 0;
+      memcpy ( b+18, &m.texid, 2 );
+      ok = fwrite(b,20,1,f)==1;
+    }
+
+   ok = ok && write_string(f,name);
+   for ( i=0; ok && i<mtlnames.size(); i++ ) ok = write_string(f,mtlnames[i]);
+   for ( i=0; ok && i<textures.size(); i++ ) ok = write_string(f,textures[i].fname);
+
+   if ( fclose(f)!=0 ) ok=false;
+   if ( !ok ) remove ( file ); // do not leave a truncated file
+   return ok;
+ }
+
+//================================ load ==================================
+
+// reads n elements in a new malloc buffer which is adopted by a
+template <class X>
+static bool read_array ( FILE* f, GsArray<X>& a, int n )
+ {
+   if ( n==0 ) { a.capacity(0); return true; }
+   X* pt = (X*) malloc ( sizeof(X)*(size_t)n );
+   if ( !pt ) return false;
+   if ( fread((void*)pt,sizeof(X),(size_t)n,f)!=(size_t)n ) { free(pt); return false; }
+   a.adopt ( pt, n, n );
+   return true;
+ }
+
+static bool read_string ( FILE* f, GsString& s )
+ {
+   gsint32 len;
+   if ( fread(&len,sizeof(len),1,f)!=1 || len<0 ) return false;
+   s.len ( len );
+   return len==0 || fread(&s[0],1,(size_t)len,f)==(size_t)len;
+ }
+
+static bool read_gsmb ( GsModel& m, FILE* f, gsuint srcmtime, gsuint srcsize )
+ {
+   GsmbHeader h;
+   if ( fread(&h,sizeof(h),1,f)!=1 ) return false;
+   if ( memcmp(h.magic,"GSMB",4)!=0 || h.version!=GsmbVersion || h.byteorder!=GsmbByteOrder ) return false;
+   if ( srcmtime && h.srcmtime!=srcmtime ) return false;
+   if ( srcsize && h.srcsize!=srcsize ) return false;
+   if ( h.nv<0 || h.nn<0 || h.nt<0 || h.nf<0 || h.nfn<0 || h.nft<0 || h.nfm<0 ||
+        h.nm<0 || h.nmtlnames<0 || h.ntextures<0 ) return false;
+
+   if ( !read_array(f,m.V,h.nv) || !read_array(f,m.N,h.nn) || !read_array(f,m.T,h.nt) ||
+        !read_array(f,m.F,h.nf) || !read_array(f,m.Fn,h.nfn) || !read_array(f,m.Ft,h.nft) ||
+        !read_array(f,m.Fm,h.nfm) ) return false;
+
+   int i;
+   m.M.size ( h.nm );
+   m.M.compress ();
+   for ( i=0; i<h.nm; i++ )
+    { GsMaterial& mtl = m.M[i];
+      gsbyte b[20];
+      if ( fread(b,20,1,f)!=1 ) return false;
+      memcpy ( (void*)&mtl.ambient, b, 4 );
+      memcpy ( (void*)&mtl.diffuse, b+4, 4 );
+      memcpy ( (void*)&mtl.specular, b+8, 4 );
+      memcpy ( (void*)&mtl.emission, b+12, 4 );
+      mtl.shininess = b[16];
+      memcpy ( &mtl.texid, b+18, 2 );
+    }
+
+   GsString s;
+   if ( !read_string(f,m.name) ) return false;
+   for ( i=0; i<h.nmtlnames; i++ )
+    { if ( !read_string(f,s) ) return false;
+      m.mtlnames.push ( s );
+    }
+   m.mtlnames.compress ();
+   for ( i=0; i<h.ntextures; i++ )
+    { GsModel::Texture& t = m.textures.push();
+      if ( !read_string(f,t.fname) ) return false;
+    }
+   m.textures.compress ();
+
+   return fgetc(f)==EOF; // the whole file must have been used
+ }
+
+bool GsModel::load_gsmb ( const char* file, gsuint srcmtime, gsuint srcsize )
+ {
+   FILE* f = fopen ( file, "rb" );
+   if ( !f ) return false;
+   GS_TRACE1 ( "Loading " << file );
+
+   init ();
+   bool ok = read_gsmb ( *this, f, srcmtime, srcsize );
+   fclose ( f );
+   if ( !ok ) init ();
+   return ok;
+ }
+
+bool GsModel::load_obj_cached ( const char* file )
+ {
+   GsString cache(file);
+   remove_extension ( cache );
+   cache << ".gsmb";
+
+   gsuint cmtime = gs_mtime ( cache );
+   gsuint mtime = gs_mtime ( file );
+   gsuint size = gs_size ( file );
+   if ( mtime>0 && cmtime>=mtime && load_gsmb(cache,mtime,size) )
+    { GS_TRACE1 ( "Using cache " << cache );
+      return true;
+    }
+
+   if ( !load_obj(file) ) return false;
+
+   save_gsmb ( cache, mtime, size ); // the cache is optional, failing to write it is not an error
+   return true;
+ }
+
+//============================ EOF ===============================
@@ -5,32 +5,81 @@
    notice licence.txt located at the base folder of the distribution. 
   =======================================================================*/
 
+# include <stdlib.h>
+# include <string.h>
+# include <ctype.h>
+
 # include <gsim/gs_strings.h>
 # include <gsim/gs_string.h>
 # include <gsim/gs_model.h>
+# include <gsim/gs_mapped_file.h>
+# include <gsim/gs_parallel.h>
 
 //# define GS_USE_TRACE1    // keyword tracking
 //# define GS_USE_TRACE2    // materials
 //# define GS_USE_TRACE3    // cur material
 # include <gsim/gs_trace.h>
 
-# define GETID(n,A) in>>n; if (n>0) n--; else if (n<0) n+=A.size()
- 
-static void get_face ( GsInput& in, GsModel& m, int& vc, int& vt, int& vn )
+// converts an index as read from the file, with n>0 being 1-based and n<0 relative to
+// the current size of the array, to a 0-based index
+static inline int objid ( int n, int size )
+ {
+   if ( n>0 ) n--; else if ( n<0 ) n+=size;
+   return n;
+ }
+
+// reads the indices of one face vertex as they appear in the file, returning a
+// combination of bits 1 and 2 telling if vt and vn were present
+template <class IN>
+static int get_face_raw ( IN& in, int& vc, int& vt, int& vn )
  {
-   vc = vt = vn = -1;
-   GETID(vc,m.V);
+   int has=0;
+   in >> vc;
 
-   if ( in.check()!=GsInput::Delimiter ) return; // was only: vc
+   if ( in.check()!=GsInput::Delimiter ) return has; // was only: vc
    in.get(); // get /
 
    if ( in.check()==GsInput::Number ) // get vt from: vc/vt or vc/vt/vn
-    { GETID(vt,m.T);
+    { in >> vt; has|=1;
     }
 
    if ( in.get()==GsInput::Delimiter ) // get vn from: vc/vt/vn or vc//vn
-    { GETID(vn,m.N);
+    { in >> vn; has|=2;
     }
+   return has;
+ }
+
+template <class IN>
+static void get_face ( IN& in, GsModel& m, int& vc, int& vt, int& vn )
+ {
+   int has = get_face_raw ( in, vc, vt, vn );
+   vc = objid ( vc, m.V.size() );
+   vt = has&1? objid(vt,m.T.size()) : -1;
+   vn = has&2? objid(vn,m.N.size()) : -1;
+ }
+
+template <class IN>
+static bool read_faces ( IN& in, GsModel& m, int curmtl,
+                         GsArray<int>& va, GsArray<int>& ta, GsArray<int>& na )
+ {
+   int i=0;
+   va.size(0); ta.size(0); na.size(0);
+   while ( true )
+    { if ( in.get()==GsInput::End ) break;
+      in.unget();
+      get_face ( in, m, va.push(), ta.push(), na.push() );
+    }
+   if ( va.size()<3 ) return false;
+
+   for ( i=2; i<va.size(); i++ )
+    { m.F.push().set ( va[0], va[i-1], va[i] );
+      m.Fm.push() = curmtl;
+      if ( ta[0]>=0 && ta[1]>=0 && ta[i]>=0 )
+        m.Ft.push().set ( ta[0], ta[i-1], ta[i] );
+      if ( na[0]>=0 && na[1]>=0 && na[i]>=0 )
+        m.Fn.push().set ( na[0], na[i-1], na[i] );
+    }
+   return true;
  }
 
 static GsColor read_color ( GsInput& in )
@@ -93,10 +142,7 @@ static void read_materials ( GsModel& model,
          in.readline(texfile);
          texfile.len(texfile.len()-1); // removing '/n'
          M.top().texid = model.textures.size();
-         model.textures.push();
-         model.textures.top().glid=-1;
-         model.textures.top().fullfname=0;
-         model.textures.top().fname = gs_string_new ( texfile );
+         model.textures.push().fname = texfile;
        }
       else if ( in.ltoken()=="map_Bump" ) // bump maps not loaded
        { in.skipline();
@@ -152,23 +198,7 @@ static bool process_line ( const GsString& line,
     }
    else if ( in.ltoken()=="f" ) // f v/t/n v/t/n v/t/n (or v/t or v//n or v)
     { GS_TRACE1 ( "f" );
-      int i=0;
-      va.size(0); ta.size(0); na.size(0);
-      while ( true )
-       { if ( in.get()==GsInput::End ) break;
-         in.unget();
-         get_face ( in, m, va.push(), ta.push(), na.push() );
-       }
-      if ( va.size()<3 ) return false;
-
-      for ( i=2; i<va.size(); i++ )
-       { m.F.push().set ( va[0], va[i-1], va[i] );
-         m.Fm.push() = curmtl;
-         if ( ta[0]>=0 && ta[1]>=0 && ta[i]>=0 )
-           m.Ft.push().set ( ta[0], ta[i-1], ta[i] );
-         if ( na[0]>=0 && na[1]>=0 && na[i]>=0 )
-           m.Fn.push().set ( na[0], na[i-1], na[i] );
-       }
+      if ( !read_faces(in,m,curmtl,va,ta,na) ) return false;
     }
    else if ( in.ltoken()=="s" ) // smoothing groups not supported
     { GS_TRACE1 ( "s" );
@@ -206,7 +236,7 @@ static bool process_line ( const GsString& line,
    return true;
  }
 
-bool GsModel::load_obj ( const char* file )
+bool GsModel::load_obj_gsinput ( const char* file )
  {
    GsInput in ( fopen(file,"r") );
    if ( !in.valid() ) return false;
@@ -239,4 +269,514 @@ bool GsModel::load_obj ( const char* file )
    return true;
  }
 
+//=========================== mapped .obj scanner ============================
+
+/* ObjLineInput reproduces over a memory range the exact token semantics of
+   a GsInput initialized with one line of the file (lowercase mode, no
+   comment char), as used by process_line(). It needs no allocation and
+   reads the mapped file in place, so that the fast loader below builds
+   exactly the same model as load_obj_gsinput(). */
+class ObjLineInput
+ { public :
+    enum { MaxTokSize=128 };
+   private :
+    const char* _cur;   // current position in the line
+    const char* _end;   // one past the line's '\n'
+    char _stack[2*MaxTokSize+16]; // unget stack
+    int  _nstack;
+    char _tok[MaxTokSize+1];      // last token read, null terminated
+    int  _toklen;
+    GsInput::TokenType _ltype;
+
+   public :
+    void init ( const char* s, const char* e )
+     { _cur=s; _end=e; _nstack=0; _tok[0]=0; _toklen=0; _ltype=GsInput::End; }
+
+    const char* ltoken () const { return _tok; }
+    int ltokenlen () const { return _toklen; }
+    GsInput::TokenType ltype () const { return _ltype; }
+
+    int readchar ()
+     { int c=EOF;
+       if ( _nstack>0 )
+        { c = _stack[--_nstack]; }
+       else
+        { while ( _cur<_end ) // null bytes are discarded by GsInput::readline()
+           { char ch = *_cur++;
+             if ( ch ) { c=ch; break; }
+           }
+        }
+       if ( c>='A' && c<='Z' ) c = c-'A'+'a';
+       return c;
+     }
+
+    void unget ( char c )
+     { if ( _nstack<(int)sizeof(_stack) ) _stack[_nstack++]=c; }
+
+    void unget ()
+     { unget ( gspc );
+       for ( int i=(int)strlen(_tok)-1; i>=0; i-- ) unget ( _tok[i] );
+     }
+
+    GsInput::TokenType check ()
+     { int c;
+       do { c = readchar();
+            if ( c==EOF ) return GsInput::End;
+          } while ( isspace(c) );
+       if ( c=='.'||c=='+'||c=='-' )
+        { int n=readchar(); unget(n);
+          if ( isdigit(n) ) { unget(c); return GsInput::Number; }
+        }
+       unget(c);
+       if ( isdigit(c) ) return GsInput::Number;
+       if ( isalpha(c) || c=='"' || c=='_' ) return GsInput::String;
+       return GsInput::Delimiter;
+     }
+
+    GsInput::TokenType get ();
+
+    int geti ();
+
+    float getf ();
+
+    friend ObjLineInput& operator>> ( ObjLineInput& in, int& i ) { i=in.geti(); return in; }
+    friend ObjLineInput& operator>> ( ObjLineInput& in, float& f ) { f=in.getf(); return in; }
+ };
+
+static char getescape ( char c ) // same as in gs_input.cpp
+ {
+   switch ( c )
+    { case 'n' : return '\n';
+      case 't' : return '\t';
+      case '\n': return 0;
+      default  : return c;
+    }
+ }
+
+GsInput::TokenType ObjLineInput::get ()
+ {
+   GsInput::TokenType type = check();
+   _ltype = type;
+   int i=0, c;
+
+   if ( type==GsInput::String )
+    { c = readchar();
+      if ( c=='"' )
+       { for ( i=0; i<MaxTokSize; i++ )
+          { c = readchar();
+            if ( c=='\\' ) c=getescape(readchar());
+            if ( c==EOF || c=='"' ) break;
+            _tok[i]=c;
+          }
+       }
+      else
+       { for ( i=0; i<MaxTokSize; i++ )
+          { if ( c==EOF ) break;
+            if ( !isalnum(c) && c!='_' ) { unget(c); break; }
+            _tok[i] = c;
+            c = readchar();
+          }
+       }
+    }
+   else if ( type==GsInput::Number )
+    { bool pnt=false, exp=false;
+      _tok[0] = readchar();
+      for ( i=1; i<MaxTokSize; i++ )
+       { c = readchar();
+         if ( !isdigit(c) )
+          { if ( c=='e' ) c='E';
+            if ( !pnt && c=='.' ) pnt=true;
+            else if ( pnt && c=='.' ) break;
+            else if ( !exp && c=='E' ) exp=pnt=true;
+            else if ( (c=='+'||c=='-') && _tok[i-1]=='E' ); // ok
+            else { unget(c); break; }
+          }
+         _tok[i]=c;
+       }
+    }
+   else if ( type==GsInput::Delimiter )
+    { _tok[0] = readchar();
+      i = 1;
+    }
+
+   _tok[i] = 0;
+   _toklen = i;
+   return type;
+ }
+
+// same result as atoi() for the tokens accepted as numbers
+int ObjLineInput::geti ()
+ {
+   if ( get()!=GsInput::Number ) return 0;
+   const char* s=_tok;
+   bool neg = *s=='-';
+   if ( *s=='-' || *s=='+' ) s++;
+   int n=0, nd=0;
+   while ( *s>='0' && *s<='9' )
+    { if ( ++nd>9 ) return ::atoi(_tok); // may not fit in an int
+      n = n*10 + (*s++-'0');
+    }
+   return neg? -n:n;
+ }
+
+/* Same result as (float)atof() for the tokens accepted as numbers. When the
+   decimal mantissa fits in 53 bits and the power of ten is exact in a double,
+   one multiplication or division gives the correctly rounded double, which is
+   what strtod() returns. Other cases are left to atof(). */
+float ObjLineInput::getf ()
+ {
+   static const double p10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+                                 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19,
+                                 1e20, 1e21, 1e22 };
+
+   if ( get()!=GsInput::Number ) return 0;
+   const char* s=_tok;
+   bool neg = *s=='-';
+   if ( *s=='-' || *s=='+' ) s++;
+
+   uint64_t m=0;
+   int nd=0, e=0;
+   while ( *s>='0' && *s<='9' )
+    { if ( m || *s!='0' ) { if ( ++nd>19 ) return (float)::atof(_tok); m = m*10 + (*s-'0'); }
+      s++;
+    }
+   if ( *s=='.' )
+    { s++;
+      while ( *s>='0' && *s<='9' )
+       { if ( m || *s!='0' ) { if ( ++nd>19 ) return (float)::atof(_tok); m = m*10 + (*s-'0'); }
+         e--; s++;
+       }
+    }
+   if ( *s=='E' )
+    { s++;
+      bool eneg = *s=='-';
+      if ( *s=='-' || *s=='+' ) s++;
+      int x=0;
+      while ( *s>='0' && *s<='9' )
+       { if ( x<10000 ) x = x*10 + (*s-'0');
+         s++;
+       }
+      e += eneg? -x:x;
+    }
+
+   if ( m==0 ) return neg? -0.0f:0.0f;
+   if ( m>(uint64_t(1)<<53) || e<-22 || e>22 ) return (float)::atof(_tok);
+   double d = e<0? double(m)/p10[-e] : double(m)*p10[e];
+   return (float)( neg? -d:d );
+ }
+
+// copies a line as GsInput::readline() would have read it
+static void copy_line ( const char* pt, const char* end, GsString& line )
+ {
+   line.len ( int(end-pt) );
+   int k=0;
+   for ( ; pt<end; pt++ ) if ( *pt ) line[k++]=*pt;
+   # ifdef GS_WINDOWS // text mode reading converts \r\n to \n
+   if ( k>=2 && line[k-2]=='\r' ) { line[k-2]='\n'; k--; }
+   # endif
+   line.len ( k );
+ }
+
+// gets the keyword of a line, returning null if the line cannot have any effect
+static const char* get_keyword ( ObjLineInput& in, const char* pt, const char* end )
+ {
+   in.init ( pt, end );
+   if ( in.get()!=GsInput::String ) return 0; // no keyword starts with a number or delimiter
+   if ( in.ltokenlen()==0 ) return 0;
+   return in.ltoken();
+ }
+
+// true for the keywords handled by process_line() in the mapped loaders
+static bool is_rare_keyword ( const char* key )
+ {
+   return gs_compare(key,"usemtl")==0 || gs_compare(key,"g")==0 ||
+          gs_compare(key,"o")==0 || gs_compare(key,"mtllib")==0;
+ }
+
+// returns false only when process_line() would return false
+static bool process_mapped_line ( ObjLineInput& in, const char* pt, const char* end,
+                                  GsString& line, GsModel& m,
+                                  GsStrings& paths, GsStrings& mnames,
+                                  int& curmtl,
+                                  GsArray<int>& va, GsArray<int>& ta, GsArray<int>& na )
+ {
+   const char* key = get_keyword ( in, pt, end );
+   if ( !key ) return true;
+
+   if ( gs_compare(key,"v")==0 )
+    { GsVec& p = m.V.push();
+      in >> p.x >> p.y >> p.z;
+    }
+   else if ( gs_compare(key,"vn")==0 )
+    { GsVec& n = m.N.push();
+      in >> n.x >> n.y >> n.z;
+    }
+   else if ( gs_compare(key,"vt")==0 )
+    { GsVec2& t = m.T.push();
+      in >> t.x >> t.y;
+    }
+   else if ( gs_compare(key,"f")==0 )
+    { return read_faces ( in, m, curmtl, va, ta, na );
+    }
+   else if ( is_rare_keyword(key) )
+    { // copy the line and use the original parser for these few lines
+      copy_line ( pt, end, line );
+      return process_line ( line, m, paths, mnames, curmtl, va, ta, na );
+    }
+   return true;
+ }
+
+//=========================== chunked .obj loading ============================
+
+/* The file is split in newline-aligned chunks which are parsed in parallel.
+   Each chunk keeps its own V, N, T arrays and its face vertices with indices
+   in file form. Lines changing materials or names are only recorded, and then
+   replayed in file order with process_line(). Prefix sums of the chunk sizes
+   give the offsets needed to resolve relative (negative) indices, and the
+   result is concatenated in the model, exactly as the serial loader would do. */
+
+struct ObjCorner
+ { int v, t, n; // 0-based or, if the respective rel bit is set, relative to the chunk base
+   int rel;     // bits 1, 2 and 4 for v, t and n
+ };
+
+struct ObjChunk
+ { const char* start;
+   const char* end;
+   GsArray<GsVec> V, N;
+   GsArray<GsVec2> T;
+   GsArray<ObjCorner> corners;   // face vertices of all face lines
+   GsArray<int> lines;           // first corner of each face line
+   GsArray<int> linesegs;        // number of recorded events before each face line
+   GsArray<const char*> events;  // start and end of each recorded line
+   GsArray<int> segmtl;          // current material after each event, segmtl[0] is the initial one
+   bool failed;                  // true if a face line with less than 3 vertices was found
+   GsArray<GsModel::Face> F, Ft, Fn;
+   GsArray<int> Fm;
+   int basev, baset, basen;      // sizes of V, T, N before this chunk
+   int basef, baseft, basefn;    // sizes of F, Ft, Fn before this chunk
+ };
+
+static inline int chunkid ( int n, int size, int& rel, int bit )
+ {
+   if ( n>0 ) return n-1;
+   if ( n<0 ) { rel|=bit; return n+size; }
+   return 0;
+ }
+
+static void parse_chunk ( ObjChunk& c )
+ {
+   ObjLineInput in;
+   const char* pt = c.start;
+   c.failed = false;
+   while ( pt<c.end )
+    { const char* nl = (const char*) memchr ( pt, '\n', size_t(c.end-pt) ) + 1;
+      const char* key = get_keyword ( in, pt, nl );
+      if ( !key )
+       { }
+      else if ( gs_compare(key,"v")==0 )
+       { GsVec& p = c.V.push();
+         in >> p.x >> p.y >> p.z;
+       }
+      else if ( gs_compare(key,"vn")==0 )
+       { GsVec& n = c.N.push();
+         in >> n.x >> n.y >> n.z;
+       }
+      else if ( gs_compare(key,"vt")==0 )
+       { GsVec2& t = c.T.push();
+         in >> t.x >> t.y;
+       }
+      else if ( gs_compare(key,"f")==0 )
+       { int first = c.corners.size();
+         while ( true )
+          { if ( in.get()==GsInput::End ) break;
+            in.unget();
+            ObjCorner& k = c.corners.push();
+            int has = get_face_raw ( in, k.v, k.t, k.n );
+            k.rel = 0;
+            k.v = chunkid ( k.v, c.V.size(), k.rel, 1 );
+            k.t = has&1? chunkid(k.t,c.T.size(),k.rel,2) : -1;
+            k.n = has&2? chunkid(k.n,c.N.size(),k.rel,4) : -1;
+          }
+         if ( c.corners.size()-first<3 ) // the serial loader stops here
+          { c.corners.size(first); c.failed=true; return; }
+         c.lines.push() = first;
+         c.linesegs.push() = c.events.size()/2;
+       }
+      else if ( is_rare_keyword(key) )
+       { c.events.push()=pt; c.events.push()=nl;
+       }
+      pt = nl;
+    }
+ }
+
+static void resolve_chunk ( ObjChunk& c )
+ {
+   int nlines = c.lines.size();
+   int ntris = c.corners.size()-2*nlines;
+   c.F.capacity(ntris); c.Fm.capacity(ntris);
+   GsArray<int> va(0,8), ta(0,8), na(0,8);
+   int i, l;
+   for ( l=0; l<nlines; l++ )
+    { int s = c.lines[l];
+      int e = l+1<nlines? c.lines[l+1] : c.corners.size();
+      va.size(0); ta.size(0); na.size(0);
+      for ( i=s; i<e; i++ )
+       { const ObjCorner& k = c.corners[i];
+         va.push() = k.rel&1? k.v+c.basev : k.v;
+         ta.push() = k.rel&2? k.t+c.baset : k.t;
+         na.push() = k.rel&4? k.n+c.basen : k.n;
+       }
+      int curmtl = c.segmtl[c.linesegs[l]];
+      for ( i=2; i<va.size(); i++ ) // same triangulation as in read_faces()
+       { c.F.push().set ( va[0], va[i-1], va[i] );
+         c.Fm.push() = curmtl;
+         if ( ta[0]>=0 && ta[1]>=0 && ta[i]>=0 )
+           c.Ft.push().set ( ta[0], ta[i-1], ta[i] );
+         if ( na[0]>=0 && na[1]>=0 && na[i]>=0 )
+           c.Fn.push().set ( na[0], na[i-1], na[i] );
+       }
+    }
+ }
+
+template <class X>
+static void copy_chunk ( GsArray<X>& a, int base, const GsArray<X>& ca )
+ {
+   if ( ca.size()>0 ) memcpy ( (void*)&a[base], (const void*)&ca[0], sizeof(X)*ca.size() );
+ }
+
+static bool load_mapped_chunks ( GsModel& m, const char* pt, const char* end,
+                                 GsStrings& paths, int nchunks )
+ {
+   const char* last = end; // as in GsInput::readline(), a last line without '\n' is not processed
+   while ( last>pt && last[-1]!='\n' ) last--;
+   size_t size = size_t(last-pt);
+   if ( (size_t)nchunks>size/64+1 ) nchunks = int(size/64+1);
+
+   ObjChunk* chunks = new ObjChunk[nchunks];
+   int c, i;
+   for ( c=0; c<nchunks; c++ )
+    { ObjChunk& ch = chunks[c];
+      ch.start = c==0? pt : chunks[c-1].end;
+      const char* e = c==nchunks-1? last : pt+size*(c+1)/nchunks;
+      if ( e<ch.start ) e=ch.start;
+      if ( e>ch.start && e[-1]!='\n' ) e = (const char*) memchr ( e, '\n', size_t(last-e) ) + 1;
+      ch.end = e;
+    }
+
+   // 1. parse all chunks in parallel:
+   gs_parallel_for ( nchunks, [&](int k) { parse_chunk(chunks[k]); } );
+
+   // 2. replay recorded lines in order and compute the chunk offsets:
+   GsString line;
+   GsArray<int> va, ta, na;
+   int curmtl=-1, nused=nchunks;
+   int nv=0, nt=0, nn=0;
+   for ( c=0; c<nchunks; c++ )
+    { ObjChunk& ch = chunks[c];
+      ch.basev=nv; ch.baset=nt; ch.basen=nn;
+      nv+=ch.V.size(); nt+=ch.T.size(); nn+=ch.N.size();
+      ch.segmtl.size(ch.events.size()/2+1);
+      ch.segmtl[0] = curmtl;
+      for ( i=0; i<ch.events.size(); i+=2 )
+       { copy_line ( ch.events[i], ch.events[i+1], line );
+         process_line ( line, m, paths, m.mtlnames, curmtl, va, ta, na );
+         ch.segmtl[i/2+1] = curmtl;
+       }
+      if ( ch.failed ) { nused=c+1; break; }
+    }
+
+   // 3. resolve the face indices and count the final faces:
+   gs_parallel_for ( nused, [&](int k) { resolve_chunk(chunks[k]); } );
+
+   int nf=0, nft=0, nfn=0;
+   for ( c=0; c<nused; c++ )
+    { ObjChunk& ch = chunks[c];
+      ch.basef=nf; ch.baseft=nft; ch.basefn=nfn;
+      nf+=ch.F.size(); nft+=ch.Ft.size(); nfn+=ch.Fn.size();
+    }
+
+   // 4. concatenate:
+   m.V.size(nv); m.T.size(nt); m.N.size(nn);
+   m.F.size(nf); m.Fm.size(nf); m.Ft.size(nft); m.Fn.size(nfn);
+   gs_parallel_for ( nused, [&](int k)
+    { ObjChunk& ch = chunks[k];
+      copy_chunk ( m.V, ch.basev, ch.V );
+      copy_chunk ( m.T, ch.baset, ch.T );
+      copy_chunk ( m.N, ch.basen, ch.N );
+      copy_chunk ( m.F, ch.basef, ch.F );
+      copy_chunk ( m.Fm, ch.basef, ch.Fm );
+      copy_chunk ( m.Ft, ch.baseft, ch.Ft );
+      copy_chunk ( m.Fn, ch.basefn, ch.Fn );
+    } );
+
+   bool ok = !chunks[nused-1].failed;
+   delete[] chunks;
+   return ok;
+ }
+
+//=============================== mapped loading ==============================
+
+// files smaller than this are loaded serially by load_obj()
+static const size_t ParallelMinSize = 1<<20;
+
+static bool load_mapped_obj ( GsModel& m, const char* file, int nchunks )
+ {
+   GsMappedFile mf;
+   if ( !mf.open(file) ) return m.load_obj_gsinput ( file );
+
+   GsString path=file;
+   GsString filename;
+   extract_filename(path,filename);
+   GsStrings paths;
+   paths.push ( path );
+   GS_TRACE1 ( "First path:" << path );
+
+   m.init ();
+   m.name = filename;
+   remove_extension ( m.name );
+
+   if ( nchunks==0 ) // automatic
+    { if ( mf.size()>=ParallelMinSize && gs_parallel_threads()>1 ) nchunks = 4*gs_parallel_threads();
+       else nchunks = 1;
+    }
+
+   if ( nchunks>1 )
+    { if ( !load_mapped_chunks(m,mf.data(),mf.end(),paths,nchunks) ) return false;
+    }
+   else
+    { int curmtl = -1;
+      ObjLineInput in;
+      GsString line;
+      GsArray<int> v(0,8), t(0,8), n(0,8); // buffers
+      const char* pt = mf.data();
+      const char* end = mf.end();
+      while ( pt<end )
+       { const char* nl = (const char*) memchr ( pt, '\n', size_t(end-pt) );
+         if ( !nl ) break; // as in GsInput::readline(), a last line without '\n' is not processed
+         nl++;
+         if ( !process_mapped_line(in,pt,nl,line,m,paths,m.mtlnames,curmtl,v,t,n) ) return false;
+         pt = nl;
+       }
+    }
+
+   m.validate();
+   m.compress ();
+
+   GS_TRACE1("Ok!");
+   return true;
+ }
+
+bool GsModel::load_obj ( const char* file )
+ {
+   return load_mapped_obj ( *this, file, 0 );
+ }
+
+bool GsModel::load_obj_parallel ( const char* file, int nchunks )
+ {
+   if ( nchunks<=0 ) nchunks = 4*gs_parallel_threads();
+   if ( nchunks<2 ) nchunks = 2;
+   return load_mapped_obj ( *this, file, nchunks );
+ }
+
 //============================ EOF ===============================
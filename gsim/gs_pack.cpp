@@ -0,0 +1,115 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <string.h>
+# include <gsim/gs_pack.h>
+
+# if defined(__F16C__)
+# include <immintrin.h>
+# endif
+
+//================================ halfs ==================================
+
+static inline gsuint32 floatbits ( float f ) { gsuint32 x; memcpy(&x,&f,4); return x; }
+static inline float bitsfloat ( gsuint32 x ) { float f; memcpy(&f,&x,4); return f; }
+
+/* All cases are computed and then selected with masks, so that loops
+   calling this function can be vectorized. Denormal results are obtained
+   with a float addition which aligns the mantissa and rounds it. */
+static inline gsuint16 tohalf ( float f )
+ {
+   const gsuint32 infty = 255u<<23;
+   const gsuint32 halfmax = (127u+16u)<<23;                    // first value too large for a half
+   const gsuint32 halfmin = 113u<<23;                          // smallest normal half
+   const gsuint32 denmagic = ((127u-15u)+(23u-10u)+1u)<<23;
+
+   gsuint32 x = floatbits ( f );
+   gsuint32 sign = x&0x80000000u;
+   x ^= sign;
+
+   gsuint32 big = 0x7c00u | (gsuint32(x>infty)<<9);           // infinity, or NaN (0x7e00)
+   gsuint32 den = floatbits ( bitsfloat(x)+bitsfloat(denmagic) ) - denmagic;
+   gsuint32 nrm = ( x + (gsuint32(15-127)<<23) + 0xfffu + ((x>>13)&1u) ) >> 13; // rounds to even
+
+   gsuint32 isbig = 0u-gsuint32(x>=halfmax);
+   gsuint32 isden = ~isbig & (0u-gsuint32(x<halfmin));
+   gsuint32 h = (big&isbig) | (den&isden) | (nrm&~(isbig|isden));
+   return gsuint16 ( h | (sign>>16) );
+ }
+
+gsuint16 gs_float_to_half ( float f )
+ {
+   return tohalf ( f );
+ }
+
+float gs_half_to_float ( gsuint16 h )
+ {
+   const gsuint32 shiftedexp = 0x7c00u<<13; // exponent mask after shift
+   gsuint32 x = gsuint32(h&0x7fffu)<<13;
+   gsuint32 exp = x&shiftedexp;
+   x += (127u-15u)<<23;
+   if ( exp==shiftedexp ) // infinity or NaN
+    { x += (128u-16u)<<23; }
+   else if ( exp==0 ) // zero or denormal
+    { x += 1u<<23;
+      x = floatbits ( bitsfloat(x)-bitsfloat(113u<<23) );
+    }
+   return bitsfloat ( x | (gsuint32(h&0x8000u)<<16) );
+ }
+
+void gs_floats_to_halfs ( const float* src, gsuint16* dst, int n )
+ {
+   int i=0;
+   # if defined(__F16C__)
+   for ( ; i+8<=n; i+=8 )
+    { __m128i h = _mm256_cvtps_ph ( _mm256_loadu_ps(src+i), _MM_FROUND_TO_NEAREST_INT );
+      _mm_storeu_si128 ( (__m128i*)(dst+i), h );
+    }
+   # endif
+   for ( ; i<n; i++ ) dst[i]=tohalf(src[i]);
+ }
+
+//=============================== normals =================================
+
+static inline gsuint32 snorm10 ( float x )
+ {
+   // clamp to [-1,1] with integer operations on the bits, which keeps the
+   // loops vectorizable (float comparisons are not, as they may trap):
+   gsuint32 b = floatbits ( x );
+   gsuint32 out = 0u-gsuint32( (b&0x7fffffffu)>0x3f800000u ); // |x|>1 or NaN
+   b = (b&~out) | (((b&0x80000000u)|0x3f800000u)&out);
+   x = bitsfloat(b)*511.0f;
+   x += bitsfloat ( (floatbits(x)&0x80000000u) | floatbits(0.5f) ); // rounds away from zero
+   return gsuint32(gsint32(x))&0x3ffu;
+ }
+
+static inline float unsnorm10 ( gsuint32 p )
+ {
+   gsint32 i = gsint32(p<<22)>>22; // sign extension
+   float x = float(i)/511.0f;
+   return x<-1.0f? -1.0f:x;
+ }
+
+gsuint32 gs_pack_normal ( const GsVec& n )
+ {
+   return snorm10(n.x) | (snorm10(n.y)<<10) | (snorm10(n.z)<<20);
+ }
+
+GsVec gs_unpack_normal ( gsuint32 p )
+ {
+   return GsVec ( unsnorm10(p), unsnorm10(p>>10), unsnorm10(p>>20) );
+ }
+
+void gs_pack_normals ( const GsVec* src, gsuint32* dst, int n )
+ {
+   const float* f = &src[0].x;
+   for ( int i=0; i<n; i++ )
+    { dst[i] = snorm10(f[3*i]) | (snorm10(f[3*i+1])<<10) | (snorm10(f[3*i+2])<<20);
+    }
+ }
+
+//============================== end of file ===============================
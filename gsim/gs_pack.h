@@ -0,0 +1,43 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_PACK_H
+# define GS_PACK_H
+
+/** \file gs_pack.h
+ * compact vertex attribute encodings */
+
+# include <gsim/gs.h>
+# include <gsim/gs_vec.h>
+
+/*! Converts a float to a 16 bit IEEE half float, rounding to the nearest
+    even value. Values too large become infinity and NaN is kept. */
+gsuint16 gs_float_to_half ( float f );
+
+/*! Converts a 16 bit IEEE half float to a float, exactly */
+float gs_half_to_float ( gsuint16 h );
+
+/*! Converts n floats to half floats, with the same results as gs_float_to_half().
+    The loop has no branches so that it is vectorized by the compiler, and
+    F16C instructions are used when the compiler enables them. */
+void gs_floats_to_halfs ( const float* src, gsuint16* dst, int n );
+
+/*! Encodes a normalized vector in the OpenGL GL_INT_2_10_10_10_REV format:
+    x, y and z are stored as 10 bit signed normalized integers from the
+    lowest bits, and the 2 highest bits (w) are 0. Coordinates are clamped
+    to [-1,1]. */
+gsuint32 gs_pack_normal ( const GsVec& n );
+
+/*! Decodes a vector encoded with gs_pack_normal(), as OpenGL does */
+GsVec gs_unpack_normal ( gsuint32 p );
+
+/*! Encodes n vectors with gs_pack_normal() in a loop suitable for vectorization */
+void gs_pack_normals ( const GsVec* src, gsuint32* dst, int n );
+
+//============================== end of file ===============================
+
+# endif  // GS_PACK_H
@@ -0,0 +1,145 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <atomic>
+# include <vector>
+
+# include <gsim/gs_parallel.h>
+
+//# define GS_USE_TRACE1 // pool start/stop
+# include <gsim/gs_trace.h>
+
+//============================== ThreadPool ==================================
+
+// Workers sleep until a new job is posted, then take iterations from a
+// shared atomic counter. Only one job runs at a time.
+class ThreadPool
+ { public :
+    std::vector<std::thread> workers;
+    std::mutex mtx;                   // protects the job fields below
+    std::condition_variable wakecv;   // signals a new job or quit
+    std::condition_variable donecv;   // signals that workers left the job
+    std::mutex runmtx;                // only one parallel loop at a time
+    void (*func)(int,void*);
+    void* udata;
+    int n;
+    std::atomic<int> next;            // next iteration to execute
+    int active;                       // workers still inside the current job
+    unsigned jobid;
+    bool quit;
+    int nthreads;                     // requested number of threads
+
+    ThreadPool () : func(0), udata(0), n(0), next(0), active(0), jobid(0), quit(false), nthreads(0) {}
+   ~ThreadPool () { stop(); }
+
+    void start ( int nt );
+    void stop ();
+    void work ();
+    void run ( int n, void (*func)(int,void*), void* udata );
+ };
+
+static ThreadPool Pool;
+static thread_local bool InsideLoop = false;
+
+void ThreadPool::start ( int nt )
+ {
+   GS_TRACE1 ( "Starting " << nt-1 << " workers" );
+   quit = false;
+   for ( int i=1; i<nt; i++ ) workers.push_back ( std::thread(&ThreadPool::work,this) );
+ }
+
+void ThreadPool::stop ()
+ {
+   if ( workers.empty() ) return;
+   GS_TRACE1 ( "Stopping workers" );
+   { std::lock_guard<std::mutex> lock(mtx);
+     quit = true;
+   }
+   wakecv.notify_all ();
+   for ( size_t i=0; i<workers.size(); i++ ) workers[i].join();
+   workers.clear ();
+ }
+
+void ThreadPool::work ()
+ {
+   InsideLoop = true;
+   unsigned lastjob = 0;
+   while ( true )
+    { void (*f)(int,void*);
+      void* ud;
+      int size;
+      { std::unique_lock<std::mutex> lock(mtx);
+        wakecv.wait ( lock, [&]{ return quit || jobid!=lastjob; } );
+        if ( quit ) return;
+        lastjob = jobid;
+        f=func; ud=udata; size=n;
+      }
+      int i;
+      while ( (i=next++)<size ) f ( i, ud );
+      { std::lock_guard<std::mutex> lock(mtx);
+        if ( --active==0 ) donecv.notify_one();
+      }
+    }
+ }
+
+void ThreadPool::run ( int size, void (*f)(int,void*), void* ud )
+ {
+   { std::lock_guard<std::mutex> lock(mtx);
+     func=f; udata=ud; n=size; next=0;
+     active = (int)workers.size();
+     jobid++;
+   }
+   wakecv.notify_all ();
+
+   InsideLoop = true;
+   int i;
+   while ( (i=next++)<size ) f ( i, ud );
+   InsideLoop = false;
+
+   std::unique_lock<std::mutex> lock(mtx);
+   donecv.wait ( lock, [&]{ return active==0; } );
+ }
+
+//============================== functions ==================================
+
+int gs_parallel_threads ()
+ {
+   if ( Pool.nthreads<=0 )
+    { int hw = (int)std::thread::hardware_concurrency();
+      Pool.nthreads = hw>0? hw:1;
+    }
+   return Pool.nthreads;
+ }
+
+void gs_parallel_threads ( int n )
+ {
+   std::lock_guard<std::mutex> lock(Pool.runmtx);
+   Pool.stop ();
+   Pool.nthreads = n;
+ }
+
+void gs_parallel_for ( int n, void (*func)(int i, void* udata), void* udata )
+ {
+   if ( n<=0 ) return;
+
+   bool serial = n==1 || InsideLoop || gs_parallel_threads()<=1;
+   std::unique_lock<std::mutex> runlock ( Pool.runmtx, std::defer_lock );
+   if ( !serial ) serial = !runlock.try_lock(); // another thread is using the pool
+
+   if ( serial )
+    { for ( int i=0; i<n; i++ ) func ( i, udata );
+      return;
+    }
+
+   if ( Pool.workers.empty() ) Pool.start ( gs_parallel_threads() );
+   Pool.run ( n, func, udata );
+ }
+
+//============================ End of File =================================
@@ -0,0 +1,56 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_PARALLEL_H
+# define GS_PARALLEL_H
+
+/** \file gs_parallel.h
+ * parallel loops on a persistent thread pool */
+
+# include <gsim/gs.h>
+
+/*! Returns the number of threads used by gs_parallel_for(), including the
+    calling thread. The default is the number of hardware threads. */
+int gs_parallel_threads ();
+
+/*! Sets the number of threads used by gs_parallel_for(). A value of 1
+    disables threading and a value <=0 restores the default. Must not be
+    called while a parallel loop is running. */
+void gs_parallel_threads ( int n );
+
+/*! Calls func(i,udata) for every i in [0,n), distributing the indices
+    among the threads of the pool. The calling thread also executes
+    iterations, and the function returns only after all iterations are
+    done. Iterations must be independent of each other. Calls made from
+    inside an iteration, or while another thread is running a parallel
+    loop, are executed serially. */
+void gs_parallel_for ( int n, void (*func)(int i, void* udata), void* udata );
+
+/*! Template version accepting any function object, e.g. a lambda [&](int i){...} */
+template <class F>
+void gs_parallel_for ( int n, const F& f )
+ {
+   struct Caller { static void call ( int i, void* f ) { (*(const F*)f)(i); } };
+   gs_parallel_for ( n, Caller::call, (void*)&f );
+ }
+
+/*! Splits the range [0,n) in about gs_parallel_threads() blocks of at least
+    minblock elements and calls f(begin,end) for each block in parallel. */
+template <class F>
+void gs_parallel_blocks ( int n, int minblock, const F& f )
+ {
+   if ( n<=0 ) return;
+   if ( minblock<1 ) minblock=1;
+   int nb = n/minblock;
+   if ( nb>gs_parallel_threads() ) nb=gs_parallel_threads();
+   if ( nb<=1 ) { f(0,n); return; }
+   gs_parallel_for ( nb, [&](int b) { f ( int((long long)n*b/nb), int((long long)n*(b+1)/nb) ); } );
+ }
+
+//============================== end of file ===============================
+
+# endif  // GS_PARALLEL_H
@@ -46,6 +46,9 @@ class GsString
     /*! Copy constructor. Copies the given string with member function set(). */
     GsString ( const GsString& st );
 
+    /*! Move constructor, taking the buffer of st, which becomes empty. */
+    GsString ( GsString&& st ) { _data.adopt(st._data); }
+
     /*! Obtains a string with length len and filled with c. */
     void set ( char c, int len );
 
@@ -262,6 +265,9 @@ class GsString
     /*! Assignment operator by calling set(). */
     void operator = ( const GsString &s ) { set(s); }
 
+    /*! Move operator, taking the buffer of s, which becomes empty. */
+    void operator = ( GsString&& s ) { if ( this!=&s ) _data.adopt(s._data); }
+
     /*! Copies s into GsString by calling set(). */
     void operator = ( const char* s ) { set(s); }
 
@@ -13,101 +13,45 @@
 
 //====================== GsStrings ==========================
 
-# define SETZERO(i,ini,size) for(i=ini;i<size;i++) GsArray<char*>::set(i,0)
-# define DELETE(i,ini,size) for(i=ini;i<size;i++) delete[] GsArray<char*>::get(i)
-
-GsStrings::GsStrings ( int s, int c )
-          :GsArray<char*>(s,c)
- {
-   int i;
-   SETZERO(i,0,s);
- }
-
-GsStrings::GsStrings ( const GsStrings& a )
-          :GsArray<char*>(0,0)
- {
-   *this = a; // calls copy operator
- }
-
-GsStrings::~GsStrings ()
- {
-   size(0);
- }
-
-void GsStrings::size ( int ns )
- {
-   int i, s = size();
-   if ( ns>s )
-    { GsArray<char*>::size(ns);
-      SETZERO(i,s,ns);
-    }
-   else if ( ns<s )
-    { DELETE(i,ns,s);
-      GsArray<char*>::size(ns);
-    }
- }
-
-void GsStrings::capacity ( int nc )
- {
-   int i, s = size();
-   if ( nc<s )
-    { DELETE(i,nc,s);
-    }
-   GsArray<char*>::capacity(nc);
- }
-
-void GsStrings::compress ()
- {
-   capacity ( size() );
- }
-
 void GsStrings::setall ( const char* s )
  {
    int i;
-   for ( i=0; i<size(); i++ ) set(i,s);
+   for ( i=0; i<size(); i++ ) Base::get(i).set(s);
  }
 
 void GsStrings::set ( int i, const char* s )
  {
    if ( i<0 || i>=size() ) return;
-   delete[] GsArray<char*>::get(i);
-   GsArray<char*>::set ( i, gs_string_new(s) );
+   Base::get(i).set ( s );
  }
 
 const char* GsStrings::get ( int i ) const
  {
-   const char* st;
-   if ( i<0 || i>=size() )
-    st=0;
-   else
-    st=GsArray<char*>::get(i);
-   return st? st:"";
+   if ( i<0 || i>=size() ) return "";
+   return Base::get(i).pt();
  }
 
 void GsStrings::pop ()
  {
-   if ( size()>0 ) delete[] GsArray<char*>::pop();
+   if ( size()>0 ) Base::pop();
  }
 
 void GsStrings::push ( const char* s )
  {
-   GsArray<char*>::push() = gs_string_new(s);
+   Base::emplace ( s );
  }
 
 void GsStrings::insert ( int i, const char* s, int dp )
  {
-   GsArray<char*>::insert ( i, dp );
+   Base::insert ( i, dp );
    int j;
    for ( j=0; j<dp; j++ )
-   GsArray<char*>::get(i+j) = gs_string_new(s);
+    Base::get(i+j).set ( s );
  }
 
 void GsStrings::remove ( int i, int dp )
  {
-   int j;
-   for ( j=0; j<dp; j++ )
-    delete[] GsArray<char*>::get(i+j);
-   GsArray<char*>::remove ( i, dp );
+   Base::remove ( i, dp );
  }
 
 int GsStrings::parse ( const char* s, char stopdelim, bool skipdelim )
@@ -124,63 +68,53 @@ int GsStrings::parse ( const char* s, char stopdelim, bool skipdelim )
    return size();
  }
 
-void GsStrings::operator = ( const GsStrings& a )
- {
-   size ( 0 ); // deletes all data
-   GsArray<char*>::size ( a.size() );
-   GsArray<char*>::compress();
-   int i;
-   for ( i=0; i<a.size(); i++ ) GsArray<char*>::set ( i, gs_string_new(a[i]) );
- }
-
-static int fcmpst ( const void* pt1, const void* pt2 )
- {
-   typedef const char* cchar;
-   return gs_compare( *((cchar*)pt1), (cchar)pt2 );
- }
-
-static int fcmppt ( const void* pt1, const void* pt2 )
+// binary search of s in a sorted array, as done by GsArrayBase::bsearch()
+static int bsearch_pos ( const GsStrings& a, const char* s, int& pos )
  {
-   typedef const char* cchar;
-   return gs_compare( *((cchar*)pt1), *((cchar*)pt2) );
+   int min=0, max=a.size()-1;
+   while ( min<=max )
+    { int mid = (min+max)/2;
+      int c = gs_compare ( s, a[mid] );
+      if ( c==0 ) { pos=mid; return mid; }
+      if ( c<0 ) max=mid-1; else min=mid+1;
+    }
+   pos = min;
+   return -1;
  }
 
 int GsStrings::insort ( const char* s )
  {
    int pos;
-   pos = GsArrayBase::insort ( sizeof(char*), s, fcmpst );
-   GsArray<char*>::get(pos) = gs_string_new(s);
+   bsearch_pos ( *this, s, pos );
+   insert ( pos, s );
    return pos;
  }
 
 int GsStrings::uniqinsort ( const char* s )
  {
    int pos;
-   pos = GsArrayBase::uniqinsort ( sizeof(char*), s, fcmpst );
-   if ( pos<0 ) return pos;
-   GsArray<char*>::get(pos) = gs_string_new(s);
+   if ( bsearch_pos(*this,s,pos)>=0 ) return -1;
+   insert ( pos, s );
    return pos;
  }
 
 void GsStrings::sort ()
  {
-   GsArrayBase::sort ( sizeof(char*), fcmppt );
+   Base::sort ( GsString::compare );
  }
 
 int GsStrings::lsearch ( const char* s ) const
  {
-   return GsArrayBase::lsearch ( sizeof(char*), s, fcmpst );
+   for ( int i=0; i<size(); i++ ) if ( gs_compare(Base::get(i).pt(),s)==0 ) return i;
+   return -1;
  }
 
 int GsStrings::bsearch ( const char* s, int *pos ) 
  {
-   return GsArrayBase::bsearch ( sizeof(char*), s, fcmpst, pos );
- }
-
-void GsStrings::adopt ( GsStrings& a )
- {
-   capacity(0);
-   GsArray<char*>::adopt(a);
+   int p;
+   int i = bsearch_pos ( *this, s, p );
+   if ( pos ) *pos=p;
+   return i;
  }
 
 GsOutput& operator<< ( GsOutput& o, const GsStrings& a )
@@ -11,48 +11,57 @@
 /** \file gs_strings.h 
  * resizeable array of strings */
 
-# include <gsim/gs_array.h> 
+# include <gsim/gs_class_array.h>
+# include <gsim/gs_string.h>
 # include <gsim/gs_input.h> 
 
 /*! \class GsStrings gs_strings.h
     \brief resizeable array of strings
 
     GsStrings implements methods for managing a resizeable array
-    of strings. It derives GsArray, rewriting all methods to correctly
-    manage the allocation and deallocation of the strings. */
-class GsStrings : private GsArray<char*>
- { public :
+    of strings. It derives GsClassArray<GsString>, so that each string is
+    owned by its element and strings are moved, not copied, when the array
+    is resized. */
+class GsStrings : private GsClassArray<GsString>
+ { typedef GsClassArray<GsString> Base;
+   public :
     /*! Default constructor */
-    GsStrings ( int s=0, int c=0 );
+    GsStrings ( int s=0, int c=0 ) : Base ( s, c ) {}
 
     /*! Copy constructor */
-    GsStrings ( const GsStrings& a );
+    GsStrings ( const GsStrings& a ) : Base ( a ) {}
 
-    /*! Destructor */
-   ~GsStrings ();
+    /*! Move constructor, taking the strings of a */
+    GsStrings ( GsStrings&& a ) : Base ( std::move(a) ) {}
 
     /*! Returns true if the array has no elements, and false otherwise. */
-    bool empty () const { return GsArray<char*>::empty(); }
+    bool empty () const { return Base::empty(); }
 
     /*! Returns the capacity of the array. */
-    int capacity () const { return GsArray<char*>::capacity(); }
+    int capacity () const { return Base::capacity(); }
 
     /*! Returns the current size of the array. */
-    int size () const { return GsArray<char*>::size(); }
+    int size () const { return Base::size(); }
 
-    /*! Changes the size of the array. */
-    void size ( int ns );
+    /*! Changes the size of the array, new elements are empty strings. */
+    void size ( int ns ) { Base::size(ns); }
 
     /*! Changes the capacity of the array. */
-    void capacity ( int nc );
+    void capacity ( int nc ) { Base::capacity(nc); }
+
+    /*! Ensures the capacity is at least c. */
+    void reserve ( int c ) { Base::reserve(c); }
 
     /*! Makes capacity to be equal to size. */
-    void compress ();
+    void compress () { Base::compress(); }
+
+    /*! Removes all strings, keeping the capacity of the array. */
+    void clear () { Base::clear(); }
 
     /*! Returns a valid index as if the given index references a circular
         array, ie, it returns index%size() for positive numbers. Negative
         numbers are also correctly mapped. */
-    int vid ( int index ) const { return GsArray<char*>::vid(index); }
+    int vid ( int index ) const { return Base::vid(index); }
 
     /*! Sets all elements to s */
     void setall ( const char* s );
@@ -61,17 +70,16 @@ class GsStrings : private GsArray<char*>
         Nothing is done if index i is out of range. */
     void set ( int i, const char* s );
 
-    /*! Get a const pointer to the string index i. If that string was not
-        defined, or if i is out of range, a pointer to a static empty string ""
-        is returned. */
+    /*! Get a const pointer to the string index i. If i is out of range,
+        a pointer to a static empty string "" is returned. */
     const char* get ( int i ) const;
 
     /*! Operator version of get() */
     const char* operator[] ( int i ) const { return get(i); }
 
     /*! Returns a const pointer to the i-th last element of the array.
-        If that string was not defined, or if i is out of range, a pointer
-        to a static empty string "" is returned. */
+        If i is out of range, a pointer to a static empty string "" is
+        returned. */
     const char* top ( int i=1 ) const { return get(size()-i); }
 
     /*! Pop and frees element size-1 if the array is not empty */
@@ -80,6 +88,9 @@ class GsStrings : private GsArray<char*>
     /*! Appends one element */
     void push ( const char* s );
 
+    /*! Appends one element, moving the buffer of s */
+    void push ( GsString&& s ) { Base::push(std::move(s)); }
+
     /*! Inserts dp positions, starting at pos i, and adding a copy of
         string s in each new position created. */
     void insert ( int i, const char* s, int dp=1 );
@@ -93,8 +104,11 @@ class GsStrings : private GsArray<char*>
         and skipdelim tells if delimiters should be parsed or skipped. */
     int parse ( const char* s, char stopdelim=0, bool skipdelim=true );
 
-    /*! Copy operator */
-    void operator = ( const GsStrings& a );
+    /*! Copy operator, reusing the buffers of the existing strings */
+    void operator = ( const GsStrings& a ) { Base::operator=(a); }
+
+    /*! Move operator, same as adopt() */
+    void operator = ( GsStrings&& a ) { Base::adopt(a); }
 
     /*! Inserts one string, considering the array is sorted. Returns the
         inserted position. */
@@ -119,7 +133,7 @@ class GsStrings : private GsArray<char*>
     /*! Frees the data of GsStrings, and then makes GsStrings be the
         given array a. After this, a is set to be a valid empty array. The data
         is moved without reallocation. */
-    void adopt ( GsStrings& a );
+    void adopt ( GsStrings& a ) { Base::adopt(a); }
 
     /*! Outputs all elements of the array in format ["e0" "e1" ... "en"]. */
     friend GsOutput& operator<< ( GsOutput& o, const GsStrings& a );
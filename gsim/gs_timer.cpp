@@ -0,0 +1,145 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <gsim/gs_timer.h>
+
+# ifdef GS_WINDOWS
+# include <Windows.h>
+# else
+# include <time.h>
+# include <errno.h>
+# endif
+
+// the time stamp counter is read with rdtsc on x86 processors:
+# if !defined(GS_NO_TSC) && ( defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86) )
+# define GS_TIMER_TSC
+# ifdef _MSC_VER
+# include <intrin.h>
+# else
+# include <x86intrin.h>
+# include <cpuid.h>
+# endif
+# endif
+
+//================================ ticks ==================================
+
+gsuint64 gs_ticks ()
+ {
+   # ifdef GS_WINDOWS
+   static LARGE_INTEGER freq = [] { LARGE_INTEGER f; QueryPerformanceFrequency(&f); return f; } ();
+   LARGE_INTEGER c;
+   QueryPerformanceCounter ( &c );
+   gsuint64 f = gsuint64(freq.QuadPart);
+   gsuint64 n = gsuint64(c.QuadPart);
+   return (n/f)*1000000000ull + ((n%f)*1000000000ull)/f; // (split to not overflow)
+   # else
+   timespec ts;
+   clock_gettime ( CLOCK_MONOTONIC, &ts );
+   return gsuint64(ts.tv_sec)*1000000000ull + gsuint64(ts.tv_nsec);
+   # endif
+ }
+
+# ifdef GS_TIMER_TSC
+static bool invariant_tsc ()
+ {
+   unsigned r[4] = { 0, 0, 0, 0 }; // eax, ebx, ecx, edx
+   # ifdef _MSC_VER
+   int i[4];
+   __cpuid ( i, 0x80000000 );
+   if ( unsigned(i[0])<0x80000007u ) return false;
+   __cpuid ( i, 0x80000007 );
+   r[3] = unsigned(i[3]);
+   # else
+   if ( !__get_cpuid(0x80000007,&r[0],&r[1],&r[2],&r[3]) ) return false;
+   # endif
+   return (r[3]&(1u<<8))!=0;
+ }
+
+/* The counter is read between two readings of gs_ticks() at the start and at
+   the end of an interval of 10 milliseconds, so that the error of the rate is
+   of a few parts per million. */
+struct TscClock
+ { bool tsc;
+   gsuint64 tsc0, ns0;
+   double scale; // nanoseconds per count
+   TscClock ()
+    { tsc = invariant_tsc();
+      if ( !tsc ) return;
+      gsuint64 a=gs_ticks(), c0=__rdtsc(), b=gs_ticks();
+      ns0 = a+(b-a)/2;
+      tsc0 = c0;
+      gsuint64 c1;
+      do { a=gs_ticks(); c1=__rdtsc(); b=gs_ticks(); } while ( a-ns0<10000000ull );
+      scale = double ( a+(b-a)/2-ns0 ) / double ( c1-tsc0 );
+      if ( !(scale>0) ) tsc=false;
+    }
+ };
+
+static const TscClock& tsc_clock ()
+ {
+   static TscClock c; // calibrated once, in a thread safe way
+   return c;
+ }
+# endif
+
+gsuint64 gs_fast_ticks ()
+ {
+   # ifdef GS_TIMER_TSC
+   const TscClock& c = tsc_clock();
+   if ( c.tsc ) return c.ns0 + gsuint64 ( double(__rdtsc()-c.tsc0)*c.scale );
+   # endif
+   return gs_ticks();
+ }
+
+bool gs_fast_ticks_tsc ()
+ {
+   # ifdef GS_TIMER_TSC
+   return tsc_clock().tsc;
+   # else
+   return false;
+   # endif
+ }
+
+void gs_sleep_until ( gsuint64 t )
+ {
+   gsuint64 now = gs_ticks();
+   if ( t<=now ) return;
+   # ifdef GS_WINDOWS
+   Sleep ( DWORD ( (t-now+999999ull)/1000000ull ) ); // rounded up to milliseconds
+   # else
+   timespec ts;
+   ts.tv_sec = time_t ( t/1000000000ull );
+   ts.tv_nsec = long ( t%1000000000ull );
+   while ( clock_nanosleep(CLOCK_MONOTONIC,TIMER_ABSTIME,&ts,0)==EINTR ); // again if interrupted
+   # endif
+ }
+
+//============================== GsPeriodic ===============================
+
+void GsPeriodic::period ( double secs )
+ {
+   _period = gsuint64 ( secs*1.0E9 );
+   if ( _period==0 ) _period=1;
+   _next = gs_ticks()+_period;
+ }
+
+int GsPeriodic::due ( int max )
+ {
+   gsuint64 now = gs_ticks();
+   if ( now<_next ) return 0;
+   gsuint64 n = (now-_next)/_period + 1;
+   _next += n*_period; // the first event after now, keeping the phase
+   return n>gsuint64(max)? max : int(n);
+ }
+
+double GsPeriodic::wait () const
+ {
+   gsuint64 now = gs_ticks();
+   return now<_next? double(_next-now)*1.0E-9 : 0;
+ }
+
+//============================== end of file ===============================
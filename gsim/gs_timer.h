@@ -0,0 +1,84 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_TIMER_H
+# define GS_TIMER_H
+
+/** \file gs_timer.h
+ * monotonic clock, stopwatch and periodic events */
+
+# include <gsim/gs.h>
+
+/*! Returns nanoseconds from an arbitrary origin on a monotonic clock, which
+    is not changed by adjustments of the system time. It uses
+    clock_gettime(CLOCK_MONOTONIC) in Linux and the performance counter
+    in Windows. Thread safe. */
+gsuint64 gs_ticks ();
+
+/*! Same as gs_ticks(), but reading the time stamp counter of the processor
+    when it runs at a constant rate (invariant TSC), which is much cheaper
+    than a system call. The counter is calibrated against gs_ticks() in
+    the first call, which takes 10 milliseconds, and its rate then differs
+    from the one of gs_ticks() by a few parts per million, so it is meant
+    for measuring short intervals. When there is no invariant TSC, or if
+    GS_NO_TSC is defined, gs_ticks() is returned. */
+gsuint64 gs_fast_ticks ();
+
+/*! Returns true if gs_fast_ticks() uses the time stamp counter */
+bool gs_fast_ticks_tsc ();
+
+/*! Returns the seconds of gs_ticks() */
+inline double gs_seconds () { return double(gs_ticks())*1.0E-9; }
+
+/*! Sleeps until gs_ticks() reaches t, returning immediately if t has passed */
+void gs_sleep_until ( gsuint64 t );
+
+/*! Measures the time elapsed between calls to start() and stop(),
+    accumulating the intervals until reset() is called. */
+class GsStopwatch
+ { private :
+    gsuint64 _start, _elapsed;
+    bool _running;
+   public :
+    /*! Constructs a stopped stopwatch, started if start is true */
+    GsStopwatch ( bool start=false ) { _elapsed=0; _running=start; _start=start? gs_ticks():0; }
+    void start () { if (!_running) { _start=gs_ticks(); _running=true; } }
+    void stop () { if (_running) { _elapsed+=gs_ticks()-_start; _running=false; } }
+    void reset () { _elapsed=0; _running=false; }
+    /*! Resets and starts again */
+    void restart () { _elapsed=0; _start=gs_ticks(); _running=true; }
+    bool running () const { return _running; }
+    /*! Elapsed nanoseconds, including the current interval if running */
+    gsuint64 ticks () const { return _elapsed + (_running? gs_ticks()-_start:0); }
+    double secs () const { return double(ticks())*1.0E-9; }
+    double ms () const { return double(ticks())*1.0E-6; }
+ };
+
+/*! Schedules events at a fixed period on the gs_ticks() clock, without
+    accumulating delays: the events are due at multiples of the period
+    from the start, however late each one is handled. */
+class GsPeriodic
+ { private :
+    gsuint64 _period, _next;
+   public :
+    /*! The first event is due one period after now */
+    GsPeriodic ( double secs ) { period(secs); }
+    /*! Changes the period and schedules the next event one period after now */
+    void period ( double secs );
+    double period () const { return double(_period)*1.0E-9; }
+    /*! Returns the number of events which are due, 0 if none, and schedules
+        the next one; events missed by more than max periods are skipped. */
+    int due ( int max=1 );
+    /*! Seconds until the next event, 0 if it is due */
+    double wait () const;
+    /*! Sleeps until the next event is due */
+    void sleep () const { gs_sleep_until(_next); }
+ };
+
+//============================== end of file ===============================
+
+# endif  // GS_TIMER_H
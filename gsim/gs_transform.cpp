@@ -0,0 +1,118 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# include <math.h>
+# include <gsim/gs_mat.h>
+# include <gsim/gs_quat.h>
+# include <gsim/gs_parallel.h>
+# include <gsim/gs_transform.h>
+
+//================================ blocks =================================
+
+static const int Block = 256;            // vectors converted at a time, fits in the L1 cache
+static const int MinThreadBlock = 16384; // below it the threads cost more than they save
+
+/* Calls f(x,y,z,k) for consecutive blocks of k<=Block vectors of src, with
+   the coordinates in separate arrays, and copies the arrays changed by f to
+   dst. Each block is read before being written, so src can be dst. */
+template <class F>
+static void transform_blocks ( const GsVec* src, GsVec* dst, int n, const F& f )
+ {
+   gs_parallel_blocks ( n, MinThreadBlock, [&] ( int b, int e )
+    { float x[Block], y[Block], z[Block];
+      for ( int i=b; i<e; i+=Block )
+       { int j, k = GS_MIN ( Block, e-i );
+         const GsVec* s = src+i;
+         for ( j=0; j<k; j++ ) { x[j]=s[j].x; y[j]=s[j].y; z[j]=s[j].z; }
+         f ( x, y, z, k );
+         GsVec* d = dst+i;
+         for ( j=0; j<k; j++ ) { d[j].x=x[j]; d[j].y=y[j]; d[j].z=z[j]; }
+       }
+    } );
+ }
+
+//=============================== kernels =================================
+
+/* The operations are the ones of the scalar GsMat and GsVec code, in the same
+   order, and the conditional divisions are replaced by divisions by 1, so that
+   the results are the same. */
+
+void gs_transform_points ( const GsMat& m, const GsVec* src, GsVec* dst, int n )
+ {
+   const float a11=m.e11, a12=m.e12, a13=m.e13, a14=m.e14,
+               a21=m.e21, a22=m.e22, a23=m.e23, a24=m.e24,
+               a31=m.e31, a32=m.e32, a33=m.e33, a34=m.e34,
+               a41=m.e41, a42=m.e42, a43=m.e43, a44=m.e44;
+   transform_blocks ( src, dst, n, [&] ( float* x, float* y, float* z, int k )
+    { float w[Block];
+      int j, proj=0;
+      for ( j=0; j<k; j++ )
+       { float px=x[j], py=y[j], pz=z[j];
+         x[j] = a11*px + a12*py + a13*pz + a14;
+         y[j] = a21*px + a22*py + a23*pz + a24;
+         z[j] = a31*px + a32*py + a33*pz + a34;
+         w[j] = a41*px + a42*py + a43*pz + a44;
+         proj |= int ( w[j]!=0.0f && w[j]!=1.0f );
+       }
+      if ( !proj ) return; // usual case of affine transformations
+      for ( j=0; j<k; j++ )
+       { float d = w[j]!=0.0f && w[j]!=1.0f? w[j]:1.0f;
+         x[j]/=d; y[j]/=d; z[j]/=d;
+       }
+    } );
+ }
+
+void gs_transform_vectors ( const GsMat& m, const GsVec* src, GsVec* dst, int n, bool normalize )
+ {
+   const float a11=m.e11, a12=m.e12, a13=m.e13,
+               a21=m.e21, a22=m.e22, a23=m.e23,
+               a31=m.e31, a32=m.e32, a33=m.e33;
+   transform_blocks ( src, dst, n, [&] ( float* x, float* y, float* z, int k )
+    { int j;
+      for ( j=0; j<k; j++ )
+       { float px=x[j], py=y[j], pz=z[j];
+         x[j] = a11*px + a12*py + a13*pz;
+         y[j] = a21*px + a22*py + a23*pz;
+         z[j] = a31*px + a32*py + a33*pz;
+       }
+      if ( !normalize ) return;
+      for ( j=0; j<k; j++ )
+       { float f = sqrtf ( x[j]*x[j] + y[j]*y[j] + z[j]*z[j] );
+         f = f>0? f:1.0f;
+         x[j]/=f; y[j]/=f; z[j]/=f;
+       }
+    } );
+ }
+
+void gs_rotate_vectors ( const GsQuat& q, const GsVec* src, GsVec* dst, int n )
+ {
+   GsMat m(GsMat::NoInit);
+   q.get ( m );
+   gs_transform_vectors ( m, src, dst, n );
+ }
+
+void gs_translate_points ( const GsVec& t, const GsVec* src, GsVec* dst, int n )
+ {
+   // the additions need no conversion to be vectorized:
+   const float tx=t.x, ty=t.y, tz=t.z;
+   gs_parallel_blocks ( n, MinThreadBlock, [&] ( int i, int e )
+    { for ( ; i<e; i++ ) { dst[i].x=src[i].x+tx; dst[i].y=src[i].y+ty; dst[i].z=src[i].z+tz; }
+    } );
+ }
+
+void gs_scale_points ( float s, const GsVec* src, GsVec* dst, int n )
+ {
+   if ( n<=0 ) return;
+   // all coordinates are scaled, so the vectors are seen as one float array:
+   const float* a = &src->x;
+   float* b = &dst->x;
+   gs_parallel_blocks ( 3*n, 3*MinThreadBlock, [&] ( int i, int e )
+    { for ( ; i<e; i++ ) b[i]=a[i]*s;
+    } );
+ }
+
+//============================== end of file ===============================
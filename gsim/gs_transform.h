@@ -0,0 +1,44 @@
+/*=======================================================================
+   Copyright 2013 Marcelo Kallmann. All Rights Reserved.
+   This software is distributed for noncommercial use only, without
+   any warranties, and provided that all copies contain the full copyright
+   notice licence.txt located at the base folder of the distribution.
+  =======================================================================*/
+
+# ifndef GS_TRANSFORM_H
+# define GS_TRANSFORM_H
+
+/** \file gs_transform.h
+ * transformations of large vector arrays */
+
+# include <gsim/gs.h>
+# include <gsim/gs_vec.h>
+
+class GsMat;
+class GsQuat;
+
+/* All functions below read blocks of vectors into separate x, y and z arrays
+   so that the compiler vectorizes the loops, and split arrays large enough
+   among the threads of gs_parallel_for(). Arrays src and dst can be the same,
+   but must not partially overlap. */
+
+/*! Sets dst[i]=m*src[i] for i in [0,n), with the same results as the GsMat
+    operator, including the division by w when w is not 0 or 1. */
+void gs_transform_points ( const GsMat& m, const GsVec* src, GsVec* dst, int n );
+
+/*! Multiplies the n vectors in src by the upper-left 3x3 part of m, ie,
+    without translation, and normalizes the results if normalize is true */
+void gs_transform_vectors ( const GsMat& m, const GsVec* src, GsVec* dst, int n, bool normalize=false );
+
+/*! Rotates the n vectors in src by q, using its rotation matrix */
+void gs_rotate_vectors ( const GsQuat& q, const GsVec* src, GsVec* dst, int n );
+
+/*! Sets dst[i]=src[i]+t for i in [0,n) */
+void gs_translate_points ( const GsVec& t, const GsVec* src, GsVec* dst, int n );
+
+/*! Sets dst[i]=src[i]*s for i in [0,n) */
+void gs_scale_points ( float s, const GsVec* src, GsVec* dst, int n );
+
+//============================== end of file ===============================
+
+# endif  // GS_TRANSFORM_H
@@ -286,6 +286,12 @@ GsTreeBase::~GsTreeBase ()
 
 void GsTreeBase::init ()
  {
+   if ( _man->free_all(_elements) ) // all nodes released at once by the manager
+    { _elements = 0;
+      _root = _cur = GsTreeNode::null;
+      return;
+    }
+
    _cur = _root;
    GsTreeNode *curp;
 
@@ -199,7 +199,8 @@ class GsTree : public GsTreeBase
     /*! Default constructor that automatically creates a GsManager<X>. */
     GsTree () : GsTreeBase ( new GsManager<X> ) {}
 
-    /*! Constructor with a given class manager. */
+    /*! Constructor with a given class manager, as a GsPoolManager<X> to
+        allocate the nodes in blocks. */
     GsTree ( GsManagerBase* m ) : GsTreeBase ( m ) {}
 
     /*! Copy constructor with class manager sharing. */
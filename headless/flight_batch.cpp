@@ -0,0 +1,185 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <stdlib.h>
+# include <math.h>
+# include <gsim/gs.h>
+# include <gsim/gs_parallel.h>
+# include <gsim/gs_timer.h>
+# include "flight_sim.h"
+
+//==========================================================================
+// Headless batch simulation:
+//    flightbatch [-n aircraft] [-t ticks] [-dt seconds] [-threads n] [-check]
+// Runs n independent aircraft for the given number of fixed steps, each one
+// flying its own scenario of speed changes, turns, maneuvers and curves, with
+// no window or OpenGL. The aircraft are distributed among the threads of
+// gs_parallel. One tab separated result line is printed:
+//    batch aircraft=<n> ticks=<t> threads=<n> secs=<s> ticks_per_sec=<r> checksum=<x>
+// where ticks_per_sec counts the steps of all aircraft, and checksum is a
+// hash of all final states, which does not depend on the number of threads.
+// With -check, the frames of the curves of n aircraft are verified instead,
+// and the exit code is 1 if they are not orthonormal or not continuous, or
+// if the steps of an aircraft allocate array memory after its first curve.
+//==========================================================================
+
+// controls aircraft i at a given tick, with events every second of simulation:
+static void control ( FlightSim& sim, int i, int tick, int tickspersec )
+ {
+   if ( tick==0 )
+    { sim.seed ( gsuint(i+1) );
+      sim.accelerate ( 0.5f + 0.1f*float(i%5) );
+      sim.animate_surfaces ();
+    }
+   if ( tick%tickspersec!=0 ) return;
+
+   int sec = tick/tickspersec + i; // aircraft start their scenarios at different points
+   if ( sim.state().curving ) return;
+   if ( sec%15==7 ) { sim.gen_curve(); return; }
+   if ( sec%5==0 && sim.maneuver()==FlightSim::NoManeuver )
+    sim.maneuver ( FlightSim::Maneuver(1+(sec/5)%7) );
+   sim.turn ( 0, float(sec%3-1), float((sec*7)%11-5) );
+   if ( sec%4==0 ) sim.accelerate ( sec%8==0? 0.1f:-0.1f );
+ }
+
+static void hash ( gsuint& h, const float* f, int n )
+ {
+   for ( int i=0; i<n; i++ )
+    { gsuint32 x; memcpy ( &x, f+i, 4 );
+      h ^= x; h *= 16777619u;
+    }
+ }
+
+// accurate also for small angles, unlike acos
+static float turn ( const GsVec& a, const GsVec& b )
+ {
+   return atan2f ( cross(a,b).len(), dot(a,b) );
+ }
+
+static float ortho_error ( const GsVec& t, const GsVec& n, const GsVec& b )
+ {
+   float e = GS_MAX3 ( GS_ABS(t.len()-1), GS_ABS(n.len()-1), GS_ABS(b.len()-1) );
+   return GS_MAX ( e, GS_MAX3(GS_ABS(dot(t,n)),GS_ABS(dot(n,b)),GS_ABS(dot(b,t))) );
+ }
+
+// Checks the stored frames of a curve per aircraft, and the interpolated ones
+// while the curve is followed with 1 ms steps. The normals of rotation
+// minimizing frames may not turn more than the tangents, between consecutive
+// points and between steps shorter than the edges, which also excludes flips.
+static int check_frames ( int n )
+ {
+   const double dt = 0.001;
+   float orth=0, excess=0, stepexcess=0;
+   int points=0;
+   for ( int i=0; i<n; i++ )
+    { FlightSim sim ( dt );
+      sim.seed ( gsuint(i+1) );
+      sim.gen_curve ();
+      const CurveFrames& fr = sim.frames();
+      const GsArray<GsVec> &T=fr.tangents(), &N=fr.normals(), &B=fr.bitangents();
+      points += fr.size();
+      for ( int k=0; k<fr.size(); k++ )
+       { GS_UPDMAX ( orth, ortho_error(T[k],N[k],B[k]) );
+         if ( k>0 ) GS_UPDMAX ( excess, turn(N[k-1],N[k])-turn(T[k-1],T[k]) );
+       }
+
+      GsVec lastn=sim.state().cnormal, lastt=sim.state().ctangent;
+      while ( sim.state().curving )
+       { sim.step ( dt );
+         const FlightSim::State& s = sim.state();
+         if ( !s.curving ) break;
+         GS_UPDMAX ( orth, ortho_error(s.ctangent,s.cnormal,s.cbitangent) );
+         GS_UPDMAX ( stepexcess, turn(lastn,s.cnormal)-turn(lastt,s.ctangent) );
+         lastn=s.cnormal; lastt=s.ctangent;
+       }
+    }
+
+   bool ok = orth<1.0e-4f && excess<1.0e-3f && stepexcess<1.0e-3f;
+   printf ( "check\tframes\tcurves=%d\tpoints=%d\tortho_err=%.2e\tturn_excess=%.2e\tstep_turn_excess=%.2e\t%s\n",
+            n, points, orth, excess, stepexcess, ok? "ok":"FAILED" );
+   return ok? 0:1;
+ }
+
+// Flies one aircraft with its scenario and counts the array allocations after
+// its first curve, when the arrays of the curve and of its frames already
+// have their memory, which they keep between curves. Only a curve with more
+// points than all the previous ones may allocate, for its 5 arrays.
+static int check_allocations ( double dt, int ticks )
+ {
+   int tickspersec = GS_MAX ( 1, int(1.0/dt+0.5) );
+   FlightSim sim ( dt );
+   int k=0, maxpoints=0;
+   for ( ; k<ticks && (sim.curve_id()==0||sim.state().curving); k++ ) // first curve
+    { control ( sim, 0, k, tickspersec );
+      sim.step ( dt );
+      maxpoints = GS_MAX ( maxpoints, sim.curve().size() );
+    }
+
+   int first=k, curves=0, grown=0;
+   int stepallocs=0, curveallocs=0, growallocs=0;
+   for ( ; k<ticks; k++ )
+    { int id = sim.curve_id();
+      gsuint64 a = GsArrayBase::allocations();
+      control ( sim, 0, k, tickspersec );
+      sim.step ( dt );
+      int n = int ( GsArrayBase::allocations()-a );
+      if ( sim.curve_id()==id ) { stepallocs+=n; continue; }
+      curves++;
+      if ( sim.curve().size()<=maxpoints ) { curveallocs+=n; continue; }
+      maxpoints = sim.curve().size();
+      grown++;
+      growallocs+=n;
+    }
+
+   bool ok = stepallocs==0 && curveallocs==0 && growallocs<=5*grown;
+   printf ( "check\tallocs\tticks=%d\tcurves=%d\tgrown=%d\tstep_allocs=%d\tcurve_allocs=%d\tgrow_allocs=%d\t%s\n",
+            ticks-first, curves, grown, stepallocs, curveallocs, growallocs, ok? "ok":"FAILED" );
+   return ok? 0:1;
+ }
+
+int main ( int argc, char** argv )
+ {
+   int n=100, ticks=10000, threads=0;
+   double dt=0.001;
+   bool check=false;
+   for ( int i=1; i<argc; i++ )
+    { if ( strcmp(argv[i],"-n")==0 && i+1<argc ) n=atoi(argv[++i]);
+      else if ( strcmp(argv[i],"-t")==0 && i+1<argc ) ticks=atoi(argv[++i]);
+      else if ( strcmp(argv[i],"-dt")==0 && i+1<argc ) dt=atof(argv[++i]);
+      else if ( strcmp(argv[i],"-threads")==0 && i+1<argc ) threads=atoi(argv[++i]);
+      else if ( strcmp(argv[i],"-check")==0 ) check=true;
+      else { printf ( "usage: flightbatch [-n aircraft] [-t ticks] [-dt seconds] [-threads n] [-check]\n" ); return 1; }
+    }
+   if ( n<1 || ticks<1 || dt<=0 ) { printf ( "invalid arguments\n" ); return 1; }
+   if ( check ) return check_frames(n) | check_allocations(dt,GS_MAX(ticks,100000));
+   gs_parallel_threads ( threads );
+   int tickspersec = GS_MAX ( 1, int(1.0/dt+0.5) );
+
+   GsArrayPt<FlightSim*> sims; // (GsArray does not call constructors)
+   for ( int i=0; i<n; i++ ) sims.push() = new FlightSim ( dt );
+
+   double t0 = gs_seconds();
+   gs_parallel_blocks ( n, 1, [&] ( int b, int e )
+    { for ( int i=b; i<e; i++ )
+       { FlightSim& sim = *sims[i];
+         for ( int k=0; k<ticks; k++ )
+          { control ( sim, i, k, tickspersec );
+            sim.step ( dt );
+          }
+       }
+    } );
+   double secs = gs_seconds()-t0;
+
+   gsuint h = 2166136261u;
+   for ( int i=0; i<n; i++ )
+    { const FlightSim::State& s = sims[i]->state();
+      const GsVec& p = s.curving? s.cpos : s.pos;
+      float f[7] = { p.x, p.y, p.z, s.roll, s.pitch, s.yaw, s.wingr };
+      hash ( h, f, 7 );
+    }
+
+   double total = double(n)*double(ticks);
+   printf ( "batch\taircraft=%d\tticks=%d\tthreads=%d\tsecs=%.4f\tticks_per_sec=%.0f\tchecksum=%08x\n",
+            n, ticks, gs_parallel_threads(), secs, secs>0? total/secs:0.0, h );
+   return 0;
+ }
@@ -20,6 +20,10 @@
 # ifdef GS_WINDOWS
   # include <windows.h>
   # include <GL/glew.h>
+# else
+  # define GL_GLEXT_PROTOTYPES
+  # include <GL/gl.h>
+  # include <GL/glext.h>
 # endif
 
 //====================== GlShader =====================
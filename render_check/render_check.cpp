@@ -0,0 +1,403 @@
+
+# include <stdio.h>
+# include <string.h>
+# include <atomic>
+# include <new>
+# include <EGL/egl.h>
+# include <EGL/eglext.h>
+# include <gsim/gs_model.h>
+# include <gsim/gs_image.h>
+# include "so_model.h"
+# include "so_aircraft.h"
+# include "so_curve.h"
+# include "so_text.h"
+# include "flight_sim.h"
+# include "frame_profiler.h"
+# include "bench/bench.h"
+
+//==========================================================================
+// Offscreen rendering check: rendercheck [-smooth] [-save] [files...]
+// Renders each model with SoModel in array mode, and in indexed mode with
+// each vertex format, with both shaders, and compares the images pixel by
+// pixel. The separate float format must give identical images, the packed
+// formats are only approximations and their differences are reported.
+// The 757 parts are also drawn as several aircraft with SoAircraft, which
+// must give the same images as drawing each part with its own SoModel.
+// The tangent, normal and bitangent lines rebuilt by AppWindow every frame
+// must not allocate array memory after the first frame, and the frames of
+// AppWindow, with the simulation, the curve lines and the profiler overlay,
+// must not call malloc() or new from the code of the program once they reach
+// a steady state. Uses an EGL context without window system, so it runs
+// with Mesa's software rasterizer (llvmpipe). It must run from this folder, since SoModel loads the
+// shaders from ../shaders. With no files given ../models/*.obj are used.
+//==========================================================================
+
+static const int W=512, H=512;
+
+//=========================== allocation counting ===========================
+
+// malloc(), calloc(), realloc() and new are replaced to count the calls made
+// from the code of this program while counting is on; calls from the shared
+// libraries, as the ones of the OpenGL driver when buffers are uploaded, are
+// not counted since their return address is not in the program's text
+extern "C" void* __libc_malloc ( size_t n );
+extern "C" void* __libc_calloc ( size_t n, size_t s );
+extern "C" void* __libc_realloc ( void* p, size_t n );
+extern "C" char __executable_start[], etext[];
+static std::atomic<bool> Counting ( false );
+static std::atomic<int> Mallocs ( 0 );
+
+static inline void count ( void* caller )
+ {
+   if ( Counting.load(std::memory_order_relaxed) && (char*)caller>=__executable_start && (char*)caller<etext )
+    Mallocs.fetch_add ( 1, std::memory_order_relaxed );
+ }
+
+extern "C" void* malloc ( size_t n ) { count(__builtin_return_address(0)); return __libc_malloc(n); }
+extern "C" void* calloc ( size_t n, size_t s ) { count(__builtin_return_address(0)); return __libc_calloc(n,s); }
+extern "C" void* realloc ( void* p, size_t n ) { count(__builtin_return_address(0)); return __libc_realloc(p,n); }
+
+void* operator new ( size_t n )
+ {
+   count ( __builtin_return_address(0) );
+   void* p = __libc_malloc ( n? n:1 );
+   if ( !p ) throw std::bad_alloc();
+   return p;
+ }
+
+void* operator new[] ( size_t n )
+ {
+   count ( __builtin_return_address(0) );
+   void* p = __libc_malloc ( n? n:1 );
+   if ( !p ) throw std::bad_alloc();
+   return p;
+ }
+
+void operator delete ( void* p ) noexcept { free(p); }
+void operator delete[] ( void* p ) noexcept { free(p); }
+void operator delete ( void* p, size_t ) noexcept { free(p); }
+void operator delete[] ( void* p, size_t ) noexcept { free(p); }
+
+//============================== rendering =================================
+
+static bool init_context ()
+ {
+   PFNEGLGETPLATFORMDISPLAYEXTPROC getdisplay =
+     (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress ( "eglGetPlatformDisplayEXT" );
+   EGLDisplay d = getdisplay? getdisplay ( EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0 )
+                            : eglGetDisplay ( EGL_DEFAULT_DISPLAY );
+   EGLint major, minor;
+   if ( d==EGL_NO_DISPLAY || !eglInitialize(d,&major,&minor) ) return false;
+
+   EGLint cattribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+   EGLConfig config;
+   EGLint nconfigs=0;
+   if ( !eglChooseConfig(d,cattribs,&config,1,&nconfigs) ) nconfigs=0;
+
+   eglBindAPI ( EGL_OPENGL_API );
+   EGLint attribs[] = { EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 0,
+                        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT, EGL_NONE };
+   EGLContext c = eglCreateContext ( d, nconfigs? config:EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attribs );
+   if ( c==EGL_NO_CONTEXT ) return false;
+   if ( !eglMakeCurrent(d,EGL_NO_SURFACE,EGL_NO_SURFACE,c) ) return false;
+
+   // all rendering goes to a framebuffer object:
+   GLuint fbo, rb[2];
+   glGenFramebuffers ( 1, &fbo );
+   glBindFramebuffer ( GL_FRAMEBUFFER, fbo );
+   glGenRenderbuffers ( 2, rb );
+   glBindRenderbuffer ( GL_RENDERBUFFER, rb[0] );
+   glRenderbufferStorage ( GL_RENDERBUFFER, GL_RGBA8, W, H );
+   glFramebufferRenderbuffer ( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rb[0] );
+   glBindRenderbuffer ( GL_RENDERBUFFER, rb[1] );
+   glRenderbufferStorage ( GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, W, H );
+   glFramebufferRenderbuffer ( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rb[1] );
+   if ( glCheckFramebufferStatus(GL_FRAMEBUFFER)!=GL_FRAMEBUFFER_COMPLETE ) return false;
+
+   glViewport ( 0, 0, W, H );
+   glEnable ( GL_DEPTH_TEST );
+   glEnable ( GL_CULL_FACE );
+   glClearColor ( GsColor::lightgray );
+   std::cout << "Renderer: " << (const char*)glGetString(GL_RENDERER) << gsnl;
+   return true;
+ }
+
+static void render ( SoModel& so, const GsMat& tr, const GsMat& proj, const GsLight& light, GsImage& img )
+ {
+   glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+   so.draw ( tr, proj, light, false );
+   glFinish ();
+   img.init ( W, H );
+   glReadPixels ( 0, 0, W, H, GL_RGBA, GL_UNSIGNED_BYTE, img.data() );
+ }
+
+// returns the number of different pixels and the largest channel difference in maxdelta
+static int count_differences ( GsImage& a, GsImage& b, int& maxdelta )
+ {
+   int n=0;
+   maxdelta=0;
+   for ( int l=0; l<H; l++ )
+    for ( int c=0; c<W; c++ )
+     { const GsColor& x=a.pixel(l,c);
+       const GsColor& y=b.pixel(l,c);
+       if ( x==y ) continue;
+       n++;
+       GS_UPDMAX ( maxdelta, GS_ABS(int(x.r)-int(y.r)) );
+       GS_UPDMAX ( maxdelta, GS_ABS(int(x.g)-int(y.g)) );
+       GS_UPDMAX ( maxdelta, GS_ABS(int(x.b)-int(y.b)) );
+     }
+   return n;
+ }
+
+// returns the number of compared images that are not identical
+static int check_model ( const char* file, bool smooth, bool save )
+ {
+   GsModel m;
+   if ( !m.load_obj(file) ) { printf ( "could not load %s\n", file ); return 1; }
+   if ( m.F.size()==0 ) return 0;
+   if ( smooth ) m.smooth ();
+
+   // fit the model in the view:
+   GsVec a=m.V[0], b=m.V[0];
+   for ( int i=1; i<m.V.size(); i++ )
+    { GS_UPDMIN(a.x,m.V[i].x); GS_UPDMAX(b.x,m.V[i].x);
+      GS_UPDMIN(a.y,m.V[i].y); GS_UPDMAX(b.y,m.V[i].y);
+      GS_UPDMIN(a.z,m.V[i].z); GS_UPDMAX(b.z,m.V[i].z);
+    }
+   float radius = dist(a,b)/2.0f;
+   if ( radius<gstiny ) radius=1.0f;
+   GsMat t, s, rx, ry, cam, persp;
+   t.translation ( -(a+b)/2.0f );
+   s.scale ( 1.0f/radius );
+   rx.rotx ( 0.4f );
+   ry.roty ( 0.7f );
+   cam.lookat ( GsVec(0,0,3.0f), GsVec::null, GsVec::j );
+   persp.perspective ( GS_TORAD(50.0f), 1.0f, 0.1f, 10.0f );
+   GsMat tr = rx*ry*s*t;
+   GsMat proj = persp*cam;
+   GsLight light ( GsVec(0,0,10), GsColor(90,90,90,255), GsColor::white, GsColor::white );
+
+   // the first model gives the reference images, the others are compared to it:
+   const int NumModels=4;
+   const char* names[NumModels] = { "arrays", "indexed", "interleaved", "interleaved_half" };
+   SoModel so[NumModels];
+   for ( int i=0; i<NumModels; i++ )
+    { so[i].init ();
+      so[i].indexed ( i>0 );
+      so[i].vertex_format ( i<2? SoModel::Separate : i==2? SoModel::Interleaved : SoModel::InterleavedHalf );
+      so[i].build ( m );
+    }
+
+   int failures=0;
+   for ( int phong=0; phong<=1; phong++ )
+    { GsImage ref, img;
+      const char* shader = phong? "phong":"gouraud";
+      for ( int i=0; i<NumModels; i++ )
+       { so[i].phong ( phong==1 );
+         render ( so[i], tr, proj, light, i==0? ref:img );
+         int bytes = so[i].vertices()*so[i].vertex_size() + so[i].indices()*(so[i].vertices()<=65536? 2:4);
+         int diff=0, maxdelta=0;
+         if ( i>0 ) diff = count_differences ( ref, img, maxdelta );
+         bool exact = i<=1; // only the separate float format must give the same image
+         if ( exact && diff>0 ) failures++;
+         printf ( "render\t%s\t%s:%s\tvertices=%d\tindices=%d\tbytes=%d\tdiffpixels=%d\tmaxdelta=%d\t%s\n",
+                  gs_filename(file), shader, names[i], so[i].vertices(), so[i].indices(), bytes, diff, maxdelta,
+                  i==0? "reference" : diff==0? "identical" : exact? "DIFFERENT":"approximate" );
+         if ( save )
+          { GsString name;
+            name.setf ( "%s_%s_%s.bmp", gs_filename(file), shader, names[i] );
+            ( i==0? ref:img ).save ( name );
+          }
+       }
+    }
+   return failures;
+ }
+
+// draws a grid of aircraft made of the 757 parts, with the control surfaces
+// rotated, with one SoModel draw per part and with one SoAircraft draw per pass;
+// returns the number of passes giving different images
+static int check_aircraft ( bool save )
+ {
+   const int NumParts=6, Side=3;
+   const char* files[NumParts] = { "757body", "757rightwing", "757leftwing", "757toptail", "757leftback", "757rightback" };
+   GsModel m[NumParts];
+   GsModel* parts[NumParts];
+   for ( int k=0; k<NumParts; k++ )
+    { GsString file;
+      file.setf ( "../models/%s.obj", files[k] );
+      m[k].load ( file ); // missing parts are left empty
+      m[k].scale ( 0.1f );
+      parts[k] = &m[k];
+    }
+
+   GsMat surf[NumParts], rx, ry, cam, persp;
+   surf[1].rotz ( 0.3f ); surf[2].rotz ( -0.3f );
+   surf[4].rotx ( 0.4f ); surf[5].rotx ( -0.4f );
+   rx.rotx ( 0.5f );
+   ry.roty ( 0.6f );
+   cam.lookat ( GsVec(0,0,7.0f), GsVec::null, GsVec::j );
+   persp.perspective ( GS_TORAD(50.0f), 1.0f, 0.1f, 20.0f );
+   GsMat proj = persp*cam;
+   GsLight light ( GsVec(0,0,10), GsColor(90,90,90,255), GsColor::white, GsColor::white );
+   GsLight shadow ( GsVec(0,0,10), GsColor(0,0,0,255), GsColor::black, GsColor::black );
+
+   GsMat body[Side*Side], flat[Side*Side];
+   for ( int i=0; i<Side*Side; i++ )
+    { GsMat t, s;
+      t.translation ( GsVec(2.0f*(i%Side-1),2.0f*(i/Side-1),0) );
+      s.scale ( 1.0f, 0.05f, 1.0f ); // squashed copies as the shadows
+      body[i] = t*rx*ry;
+      flat[i] = t*s*rx*ry;
+    }
+
+   SoModel so[NumParts];
+   for ( int k=0; k<NumParts; k++ ) { so[k].init(); so[k].build(m[k]); }
+   SoAircraft air;
+   air.init ();
+   air.build ( parts, NumParts );
+   air.instances ( Side*Side );
+   for ( int i=0; i<Side*Side; i++ ) air.transform ( i, body[i], flat[i], surf );
+
+   // the lit passes are done first since SoModel keeps the shadow material
+   // after drawing a shadow:
+   int failures=0;
+   for ( int pass=0; pass<=1; pass++ )
+    for ( int phong=0; phong<=1; phong++ )
+     { GsImage ref, img;
+       glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+       for ( int i=0; i<Side*Side; i++ )
+        for ( int k=0; k<NumParts; k++ )
+         { so[k].phong ( phong==1 );
+           so[k].draw ( (pass? flat[i]:body[i])*surf[k], proj, pass? shadow:light, pass==1 );
+         }
+       glFinish ();
+       ref.init ( W, H );
+       glReadPixels ( 0, 0, W, H, GL_RGBA, GL_UNSIGNED_BYTE, ref.data() );
+
+       glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+       air.phong ( phong==1 );
+       if ( pass ) air.draw_shadows ( proj, shadow ); else air.draw ( proj, light );
+       glFinish ();
+       img.init ( W, H );
+       glReadPixels ( 0, 0, W, H, GL_RGBA, GL_UNSIGNED_BYTE, img.data() );
+
+       int maxdelta=0;
+       int diff = count_differences ( ref, img, maxdelta );
+       if ( diff>0 ) failures++;
+       const char* name = pass? "shadows":"lit";
+       printf ( "render\taircraft\t%s:%s\tinstances=%d\tdraws=%d:1\tdiffpixels=%d\tmaxdelta=%d\t%s\n",
+                phong? "phong":"gouraud", name, air.instances(), Side*Side*NumParts, diff, maxdelta,
+                diff==0? "identical":"DIFFERENT" );
+       if ( save )
+        { GsString file;
+          file.setf ( "aircraft_%s_%s.bmp", phong? "phong":"gouraud", name );
+          img.save ( file );
+        }
+     }
+   return failures;
+ }
+
+// rebuilds and draws 3 SoCurve lines per frame as AppWindow does at the curve
+// point, returning 1 if array memory is allocated after the first frame
+static int check_curve_lines ()
+ {
+   const int frames=100;
+   SoCurve lines[3];
+   for ( int k=0; k<3; k++ ) lines[k].init();
+   GsArray<GsVec> p[3];
+   GsMat id;
+   gsuint64 a0=0;
+   for ( int f=0; f<frames; f++ )
+    { if ( f==1 ) a0 = GsArrayBase::allocations();
+      GsVec c ( 0.01f*float(f), 0, 0 );
+      for ( int k=0; k<3; k++ )
+       { p[k].size(2); p[k][0]=c; p[k][1]=c; p[k][1].e[k]+=0.5f;
+         lines[k].build ( p[k], GsColor::green );
+         lines[k].draw ( id, id );
+       }
+    }
+   glFinish ();
+   int allocs = int ( GsArrayBase::allocations()-a0 );
+   printf ( "render\tcurve\tframe_lines\tframes=%d\tallocs=%d\t%s\n", frames-1, allocs, allocs==0? "ok":"FAILED" );
+   return allocs==0? 0:1;
+ }
+
+// runs the frames of AppWindow::glutDisplay() without its models: the
+// simulation advances, the curve lines and the profiler overlay are built in
+// the arena of the frame, and all is drawn; returns 1 if the code of the
+// program allocates memory after the first frames, which also build the
+// curve and reach the final length of the overlay text
+static int check_frame_allocations ()
+ {
+   const int warmup=20, frames=300;
+   FlightSim sim;
+   sim.seed ( 1 );
+   sim.accelerate ( 0.5f );
+   sim.animate_surfaces ();
+   sim.animate_sun ( true );
+   sim.gen_curve ();
+
+   SoCurve curve, lines[3];
+   SoText text;
+   curve.init ();
+   for ( int k=0; k<3; k++ ) lines[k].init();
+   text.init ();
+   FrameProfiler prof;
+   prof.init ( 60, true );
+   GsArena frame;
+   GsMat id;
+   int curveid=-1, curving=0;
+
+   for ( int f=0; f<frames; f++ )
+    { if ( f==warmup ) { Mallocs=0; Counting=true; }
+      FrameProfiler::FrameScope pf ( prof );
+      frame.reset ();
+      glClear ( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+      sim.advance ( 1.0/60.0 );
+      FlightSim::State st = sim.interpolated();
+      if ( sim.curve_id()!=curveid ) { curve.build(sim.curve(),GsColor::red); curveid=sim.curve_id(); }
+      { FrameProfiler::PassScope pp ( prof, "curve" );
+        curve.draw ( id, id );
+      }
+      if ( st.curving )
+       { FrameProfiler::PassScope pp ( prof, "frame lines" );
+         GsVec* p = frame.alloc<GsVec>(6);
+         p[0] = st.cpoint; p[1] = st.cpoint + st.ctangent;
+         p[2] = st.cpoint; p[3] = st.cpoint + st.cnormal;
+         p[4] = st.cpoint; p[5] = st.cpoint + st.cbitangent;
+         for ( int k=0; k<3; k++ ) { lines[k].build ( p+2*k, 2, GsColor::green ); lines[k].draw ( id, id ); }
+         curving++;
+       }
+      { FrameProfiler::PassScope pp ( prof, "overlay" );
+        if ( f%15==0 ) text.build ( prof.text(frame), 10, 10, 2, GsColor::yellow, W, H );
+        text.draw ();
+      }
+    }
+   Counting = false;
+   glFinish ();
+   int mallocs = Mallocs;
+   printf ( "render\tframe\tallocations\tframes=%d\tcurving=%d\tarena_peak=%d\tmallocs=%d\t%s\n",
+            frames-warmup, curving, int(frame.peak()), mallocs, mallocs==0? "ok":"FAILED" );
+   return mallocs==0? 0:1;
+ }
+
+int main ( int argc, char** argv )
+ {
+   GsStrings files;
+   bool smooth=false, save=false;
+   for ( int i=1; i<argc; i++ )
+    { if ( strcmp(argv[i],"-smooth")==0 ) smooth=true;
+      else if ( strcmp(argv[i],"-save")==0 ) save=true;
+      else files.push ( argv[i] );
+    }
+   if ( files.size()==0 ) bench_list_files ( "../models", "obj", files );
+
+   if ( !init_context() ) { printf ( "could not create an offscreen OpenGL context\n" ); return 1; }
+
+   int failures=0;
+   for ( int i=0; i<files.size(); i++ ) failures += check_model ( files[i], smooth, save );
+   failures += check_aircraft ( save );
+   failures += check_curve_lines ();
+   failures += check_frame_allocations ();
+   return failures>0? 1:0;
+ }
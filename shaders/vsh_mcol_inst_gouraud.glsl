@@ -0,0 +1,57 @@
+# version 400
+
+layout (location = 0) in vec3 vPos;
+layout (location = 1) in vec3 vNorm;
+layout (location = 2) in vec4 vColor;
+layout (location = 3) in uint vPart;
+
+uniform samplerBuffer vTransfs; // 4 texels per matrix, one matrix per instance and part
+uniform int vFirst;             // first matrix of the pass
+uniform int vParts;             // number of parts per instance
+uniform mat4 vProj;
+
+uniform vec3 lPos;
+uniform vec4 la;
+uniform vec4 ld;
+uniform vec4 ls;
+
+uniform vec4 ka;
+uniform vec4 ks;
+uniform float sh;
+
+out vec4 Color;
+
+mat4 transf ()
+ {
+   int i = 4 * ( vFirst + gl_InstanceID*vParts + int(vPart) );
+   return mat4 ( texelFetch(vTransfs,i), texelFetch(vTransfs,i+1),
+                 texelFetch(vTransfs,i+2), texelFetch(vTransfs,i+3) );
+ }
+
+vec4 shade ( vec4 p, mat4 vTransf )
+ {
+   vec4 kd = vColor / 255.0;
+
+   vec3 n = normalize ( vNorm*mat3(vTransf) ); // vertex normal
+   vec3 l = normalize ( lPos-p.xyz );          // light direction
+   vec3 r = reflect ( -l, n );                 // reflected ray
+   vec3 v = vec3 ( 0, 0, 1.0 );                // view point
+
+   vec4 amb = la*ka;
+   vec4 dif = ld*kd*max(dot(l,n),0.0);
+   vec4 spe = ls*ks*pow(max(r.z,0.0),sh);      // r.z==dot(v,r)
+
+   if ( dot(l,n)<0 ) spe=vec4(0.0,0.0,0.0,1.0);
+
+   return amb + dif + spe;
+ }
+
+void main ()
+ {
+   mat4 vTransf = transf ();
+   vec4 p = vec4(vPos,1.0)*vTransf; // vertex pos in eye coords
+
+   Color = shade ( p, vTransf );
+
+   gl_Position = p * vProj;
+ }
@@ -0,0 +1,27 @@
+# version 400
+
+layout (location=0) in vec3 vPos;
+layout (location=1) in vec3 vNorm;
+layout (location=2) in vec4 vColor;
+layout (location=3) in uint vPart;
+
+out vec3 Pos;
+out vec3 Norm;
+out vec4 DifColor;
+
+uniform samplerBuffer vTransfs; // 4 texels per matrix, one matrix per instance and part
+uniform int vFirst;             // first matrix of the pass
+uniform int vParts;             // number of parts per instance
+uniform mat4 vProj;
+
+void main ()
+ {
+   int i = 4 * ( vFirst + gl_InstanceID*vParts + int(vPart) );
+   mat4 vTransf = mat4 ( texelFetch(vTransfs,i), texelFetch(vTransfs,i+1),
+                         texelFetch(vTransfs,i+2), texelFetch(vTransfs,i+3) );
+   Norm = normalize ( vNorm*mat3(vTransf) ); // vertex normal
+   vec4 p = vec4(vPos,1.0)*vTransf; // vertex pos in eye coords
+   gl_Position = p * vProj;
+   Pos = vec3(p);
+   DifColor = vColor/255;
+ }
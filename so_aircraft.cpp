@@ -0,0 +1,198 @@
+
+# include "so_aircraft.h"
+# include "so_model.h"
+
+SoAircraft::SoAircraft()
+ {
+   _tex = 0;
+   _numparts = 0;
+   _numinstances = 1;
+   _numindices = 0;
+   _indextype = GL_UNSIGNED_INT;
+   _phong = false;
+
+   _shadowmtl.ambient = GsColor::darkred;
+   _shadowmtl.diffuse = GsColor::white;
+   _shadowmtl.specular = GsColor::yellow;
+   _shadowmtl.emission = GsColor::black;
+   _shadowmtl.shininess = 1;
+ }
+
+SoAircraft::~SoAircraft()
+ {
+   if ( _tex ) glDeleteTextures ( 1, &_tex );
+ }
+
+void SoAircraft::init ()
+ {
+   // Load programs:
+   _vshgou.load_and_compile ( GL_VERTEX_SHADER, "../shaders/vsh_mcol_inst_gouraud.glsl" );
+   _fshgou.load_and_compile ( GL_FRAGMENT_SHADER, "../shaders/fsh_gouraud.glsl" );
+   _proggouraud.init_and_link ( _vshgou, _fshgou );
+
+   _vshphong.load_and_compile ( GL_VERTEX_SHADER, "../shaders/vsh_mcol_inst_phong.glsl" );
+   _fshphong.load_and_compile ( GL_FRAGMENT_SHADER, "../shaders/fsh_mcol_phong.glsl" );
+   _progphong.init_and_link ( _vshphong, _fshphong );
+
+   // Define buffers needed:
+   gen_vertex_arrays ( 1 ); // will use 1 vertex array
+   gen_buffers ( 6 );       // will use 6 buffers: P, N, C, part ids, indices and matrices
+
+   // the matrices are read in the shaders from a buffer texture, and the
+   // buffer must be bound once to exist before being attached to it:
+   glBindBuffer ( GL_TEXTURE_BUFFER, buf[5] );
+   glBindBuffer ( GL_TEXTURE_BUFFER, 0 );
+   glGenTextures ( 1, &_tex );
+   glBindTexture ( GL_TEXTURE_BUFFER, _tex );
+   glTexBuffer ( GL_TEXTURE_BUFFER, GL_RGBA32F, buf[5] );
+   glBindTexture ( GL_TEXTURE_BUFFER, 0 );
+
+   GlProgram* progs[2] = { &_proggouraud, &_progphong };
+   for ( int i=0; i<2; i++ )
+    { GlProgram& p = *progs[i];
+      p.uniform_locations ( 11 ); // will send 11 variables
+      p.uniform_location ( 0, "vTransfs" );
+      p.uniform_location ( 1, "vFirst" );
+      p.uniform_location ( 2, "vParts" );
+      p.uniform_location ( 3, "vProj" );
+      p.uniform_location ( 4, "lPos" );
+      p.uniform_location ( 5, "la" );
+      p.uniform_location ( 6, "ld" );
+      p.uniform_location ( 7, "ls" );
+      p.uniform_location ( 8, "ka" );
+      p.uniform_location ( 9, "ks" );
+      p.uniform_location ( 10, "sh" );
+    }
+ }
+
+void SoAircraft::instances ( int n )
+ {
+   _numinstances = n;
+   _transfs.size ( 2*n*_numparts );
+   _transfs.setall ( GsMat::id );
+   changed = true;
+ }
+
+void SoAircraft::build ( GsModel** parts, int n )
+ {
+   int i, k;
+   GsArray<GsVec>   P; // coordinates
+   GsArray<GsVec>   N; // normals
+   GsArray<GsColor> C; // diffuse colors
+   GsArray<gsbyte>  A; // part of each vertex
+   GsArray<gsuint>  I; // triangle indices
+
+   // the parts are appended to the same arrays, each one sharing its equal vertices:
+   _mtl.init();
+   bool mtl=false;
+   if ( n>256 ) n=256;
+   for ( k=0; k<n; k++ )
+    { GsModel& m = *parts[k];
+      int first = P.size();
+      SoModel::make_arrays ( m, true, P, N, C, I );
+      A.size ( P.size() );
+      for ( i=first; i<P.size(); i++ ) A[i]=(gsbyte)k;
+      if ( !mtl && m.M.size()>0 ) { _mtl=m.M[0]; mtl=true; }
+    }
+
+   // send data to OpenGL buffers:
+   glBindVertexArray ( va[0] );
+   glEnableVertexAttribArray ( 0 );
+   glEnableVertexAttribArray ( 1 );
+   glEnableVertexAttribArray ( 2 );
+   glEnableVertexAttribArray ( 3 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[0] );
+   glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*P.size(), P.pt(), GL_STATIC_DRAW );
+   glVertexAttribPointer ( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[1] );
+   glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*N.size(), N.pt(), GL_STATIC_DRAW );
+   glVertexAttribPointer ( 1, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[2] );
+   glBufferData ( GL_ARRAY_BUFFER, 4*sizeof(gsbyte)*C.size(), C.pt(), GL_STATIC_DRAW );
+   glVertexAttribPointer ( 2, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, 0 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[3] );
+   glBufferData ( GL_ARRAY_BUFFER, sizeof(gsbyte)*A.size(), A.pt(), GL_STATIC_DRAW );
+   glVertexAttribIPointer ( 3, 1, GL_UNSIGNED_BYTE, 0, 0 );
+
+   glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, buf[4] );
+   if ( P.size()<=65536 ) // 16 bit indices are enough
+    { GsArray<gsuint16> I16 ( I.size() );
+      for ( i=0; i<I.size(); i++ ) I16[i]=(gsuint16)I[i];
+      glBufferData ( GL_ELEMENT_ARRAY_BUFFER, sizeof(gsuint16)*I16.size(), I16.pt(), GL_STATIC_DRAW );
+      _indextype = GL_UNSIGNED_SHORT;
+    }
+   else
+    { glBufferData ( GL_ELEMENT_ARRAY_BUFFER, sizeof(gsuint)*I.size(), I.pt(), GL_STATIC_DRAW );
+      _indextype = GL_UNSIGNED_INT;
+    }
+
+   glBindVertexArray(0); // break the existing vertex array object binding.
+
+   _numindices = I.size();
+   _numparts = n;
+   instances ( _numinstances );
+ }
+
+void SoAircraft::transform ( int i, const GsMat& body, const GsMat& shadow, const GsMat* parts )
+ {
+   GsMat* lit = &_transfs[i*_numparts];
+   GsMat* sha = &_transfs[(_numinstances+i)*_numparts];
+   for ( int k=0; k<_numparts; k++ )
+    { if ( parts ) { lit[k]=body*parts[k]; sha[k]=shadow*parts[k]; }
+       else { lit[k]=body; sha[k]=shadow; }
+    }
+   changed = true;
+ }
+
+void SoAircraft::draw ( const GsMat& pr, const GsLight& l )
+ {
+   draw_pass ( 0, pr, l, _mtl );
+ }
+
+void SoAircraft::draw_shadows ( const GsMat& pr, const GsLight& l )
+ {
+   draw_pass ( _numinstances*_numparts, pr, l, _shadowmtl );
+ }
+
+void SoAircraft::draw_pass ( int first, const GsMat& pr, const GsLight& l, const GsMaterial& mtl )
+ {
+   if ( _numindices==0 || _numinstances==0 ) return;
+
+   // all matrices are sent once after being changed, the buffer is replaced to
+   // not wait for draws still using the previous one:
+   if ( changed )
+    { glBindBuffer ( GL_TEXTURE_BUFFER, buf[5] );
+      glBufferData ( GL_TEXTURE_BUFFER, sizeof(GsMat)*_transfs.size(), _transfs.pt(), GL_STREAM_DRAW );
+      glBindBuffer ( GL_TEXTURE_BUFFER, 0 );
+      changed = false;
+    }
+
+   float f[4];
+   float sh = (float)mtl.shininess;
+   if ( sh<0.001f ) sh=64;
+
+   GlProgram& p = _phong? _progphong : _proggouraud;
+   glUseProgram ( p.id );
+   glUniform1i ( p.uniloc[0], 0 ); // texture unit 0
+   glUniform1i ( p.uniloc[1], first );
+   glUniform1i ( p.uniloc[2], _numparts );
+   glUniformMatrix4fv ( p.uniloc[3], 1, GL_FALSE, pr.e );
+   glUniform3fv ( p.uniloc[4], 1, l.pos.e );
+   glUniform4fv ( p.uniloc[5], 1, l.amb.get(f) );
+   glUniform4fv ( p.uniloc[6], 1, l.dif.get(f) );
+   glUniform4fv ( p.uniloc[7], 1, l.spe.get(f) );
+   glUniform4fv ( p.uniloc[8], 1, mtl.ambient.get(f) );
+   glUniform4fv ( p.uniloc[9], 1, mtl.specular.get(f) );
+   glUniform1fv ( p.uniloc[10], 1, &sh );
+
+   glActiveTexture ( GL_TEXTURE0 );
+   glBindTexture ( GL_TEXTURE_BUFFER, _tex );
+   glBindVertexArray ( va[0] );
+   glDrawElementsInstanced ( GL_TRIANGLES, _numindices, _indextype, 0, _numinstances );
+   glBindVertexArray(0); // break the existing vertex array object binding.
+   glBindTexture ( GL_TEXTURE_BUFFER, 0 );
+ }
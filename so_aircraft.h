@@ -0,0 +1,52 @@
+
+// Ensure the header file is included only once in multi-file projects
+#ifndef SO_AIRCRAFT_H
+#define SO_AIRCRAFT_H
+
+// Include needed header files
+# include <gsim/gs_mat.h>
+# include <gsim/gs_light.h>
+# include <gsim/gs_array.h>
+# include <gsim/gs_model.h>
+# include "ogl_tools.h"
+
+// Draws several instances of a model made of parts, each part with its own
+// transformation, as the body and control surfaces of an aircraft.
+// The parts are merged in one vertex array with a part id per vertex, and the
+// matrices of all instances and parts are sent in one texture buffer, so that
+// the lit pass and the shadow pass are drawn with one call each.
+class SoAircraft : public GlObjects
+ { private :
+    GlShader _vshgou, _fshgou, _vshphong, _fshphong;
+    GlProgram _proggouraud, _progphong;
+    GsArray<GsMat> _transfs; // matrices of the lit pass for all instances, then of the shadow pass
+    GsMaterial _mtl;         // material of the first part having materials
+    GsMaterial _shadowmtl;   // material of the shadows
+    GLuint _tex;             // buffer texture reading the matrices
+    int _numparts;           // number of parts given to build()
+    int _numinstances;       // number of aircraft drawn
+    int _numindices;         // number of indices to draw
+    GLenum _indextype;       // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    bool _phong;
+   public :
+    SoAircraft ();
+   ~SoAircraft ();
+    void phong ( bool b ) { _phong=b; }
+    bool phong () const { return _phong; }
+    int parts () const { return _numparts; }
+    int instances () const { return _numinstances; }
+    // sets the number of aircraft to draw, their transformations are reset to the identity
+    void instances ( int n );
+    void init ();
+    // merges the n parts in one vertex array, at most 256 parts are accepted
+    void build ( GsModel** parts, int n );
+    // sets the transformations of instance i: part k is drawn with body*parts[k] and its
+    // shadow with shadow*parts[k]; parts can be null when all parts move with the body
+    void transform ( int i, const GsMat& body, const GsMat& shadow, const GsMat* parts );
+    void draw ( const GsMat& pr, const GsLight& l );
+    void draw_shadows ( const GsMat& pr, const GsLight& l );
+   private :
+    void draw_pass ( int first, const GsMat& pr, const GsLight& l, const GsMaterial& mtl );
+ };
+
+#endif // SO_AIRCRAFT_H
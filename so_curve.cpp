@@ -23,18 +23,19 @@ void SoCurve::init()
 }
 
 // build may be called everytime the object changes (not the case for this axis object):
-void SoCurve::build(GsArray<GsVec> curve, GsColor c)
+void SoCurve::build(const GsArray<GsVec>& curve, GsColor c)
 {
-	int i;
-	//const float d = r / 20.0f;
-
-	P.size(0); C.size(0); // set size to zero
-	//P.reserve(18); C.reserve(18); // reserve some space to avoid re-allocations below
+	build(curve.pt(), curve.size(), c);
+}
 
-	P = curve;
-	for (int i = 0; i < curve.size(); i++) {
-		C.push(c);
-	}
+void SoCurve::build(const GsVec* pnts, int n, GsColor c)
+{
+	// the arrays keep their capacity between builds, so that the lines rebuilt
+	// every frame do not reallocate memory:
+	P.size(n);
+	for (int i = 0; i < n; i++) P[i] = pnts[i];
+	C.size(n);
+	C.setall(c);
 
 	// send data to OpenGL buffers:
 	glBindVertexArray(va[0]);
@@ -51,11 +52,8 @@ void SoCurve::build(GsArray<GsVec> curve, GsColor c)
 
 	glBindVertexArray(0); // break the existing vertex array object binding.
 
-						  // save size so that we can free our buffers and later draw the OpenGL arrays:
+	// save size so that we can later draw the OpenGL arrays:
 	_numpoints = P.size();
-
-	// free non-needed memory:
-	P.capacity(0); C.capacity(0);
 }
 
 // draw will be called everytime we need to display this object:
@@ -24,7 +24,9 @@ private:
 public:
 	SoCurve();
 	void init();
-	void build(GsArray<GsVec> curve, GsColor c);
+	void build(const GsArray<GsVec>& curve, GsColor c);
+	// same as above for n points, which can be temporary data of the frame:
+	void build(const GsVec* pnts, int n, GsColor c);
 	void draw(GsMat& tr, GsMat& pr);
 };
 
@@ -1,12 +1,56 @@
 
+# include <string.h>
+# include <gsim/gs_pack.h>
 # include "so_model.h"
 
 SoModel::SoModel()
  {
    _numpoints = 0;
+   _numindices = 0;
+   _indextype = GL_UNSIGNED_INT;
+   _format = Separate;
    _phong = false;
+   _indexed = true;
  }
 
+// Open addressing hash table of the vertices already added to P, N and C,
+// used to share vertices with equal position, normal and color:
+class VertexTable
+ { private :
+    GsArray<int> _slots; // indices of vertices, or -1 for free slots
+    unsigned _mask;
+    static unsigned hash ( const GsVec& p, const GsVec& n, const GsColor& c )
+     { gsuint32 w[7];
+       memcpy ( w, p.e, 12 );
+       memcpy ( w+3, n.e, 12 );
+       memcpy ( w+6, &c, 4 );
+       gsuint32 h = 2166136261u;
+       for ( int i=0; i<7; i++ ) { h ^= w[i]; h *= 16777619u; h ^= h>>15; }
+       return h;
+     }
+   public :
+    VertexTable ( int maxvertices )
+     { unsigned size=16;
+       while ( size<2u*unsigned(maxvertices) ) size*=2;
+       _mask = size-1;
+       _slots.size ( int(size) );
+       _slots.setall ( -1 );
+     }
+    // returns the index of the equal vertex, pushing it to the arrays if not yet there
+    int add ( GsArray<GsVec>& P, GsArray<GsVec>& N, GsArray<GsColor>& C,
+              const GsVec& p, const GsVec& n, const GsColor& c )
+     { unsigned k = hash(p,n,c)&_mask;
+       while ( _slots[k]>=0 )
+        { int i = _slots[k];
+          if ( memcmp(P[i].e,p.e,12)==0 && memcmp(N[i].e,n.e,12)==0 && C[i]==c ) return i;
+          k = (k+1)&_mask;
+        }
+       _slots[k] = P.size();
+       P.push()=p; N.push()=n; C.push()=c;
+       return _slots[k];
+     }
+ };
+
 void SoModel::init ()
  {
    // Load programs:
@@ -20,7 +64,7 @@ void SoModel::init ()
 
    // Define buffers needed:
    gen_vertex_arrays ( 1 ); // will use 1 vertex array
-   gen_buffers ( 3 );       // will use 3 buffers
+   gen_buffers ( 4 );       // will use 4 buffers: P, N, C and indices
 
    _proggouraud.uniform_locations ( 9 ); // will send 9 variables
    _proggouraud.uniform_location ( 0, "vTransf" );
@@ -45,43 +89,116 @@ void SoModel::init ()
    _progphong.uniform_location ( 8, "sh" );
  }
 
-void SoModel::build ( GsModel& m )
+// Interleaves P, N and C in data, with normals in the 10:10:10:2 format. If half is true
+// positions are half floats relative to the bounds and dequant maps them back.
+static void pack_vertices ( const GsArray<GsVec>& P, const GsArray<GsVec>& N, const GsArray<GsColor>& C,
+                            bool half, GsArray<gsbyte>& data, GsMat& dequant )
+ {
+   int i, n=P.size(), stride=half? 16:20;
+   data.size ( n*stride );
+   dequant.identity ();
+   if ( n==0 ) return;
+
+   GsArray<gsuint32> normals ( n );
+   gs_pack_normals ( N.pt(), normals.pt(), n );
+   gsbyte* d = data.pt();
+
+   if ( !half )
+    { for ( i=0; i<n; i++, d+=stride )
+       { memcpy ( d, P[i].e, 12 );
+         memcpy ( d+12, &normals[i], 4 );
+         memcpy ( d+16, &C[i], 4 );
+       }
+      return;
+    }
+
+   // coordinates are mapped to [-1,1] with the same scale in all axes:
+   GsVec a=P[0], b=P[0];
+   for ( i=1; i<n; i++ )
+    { GS_UPDMIN(a.x,P[i].x); GS_UPDMAX(b.x,P[i].x);
+      GS_UPDMIN(a.y,P[i].y); GS_UPDMAX(b.y,P[i].y);
+      GS_UPDMIN(a.z,P[i].z); GS_UPDMAX(b.z,P[i].z);
+    }
+   GsVec c = (a+b)/2.0f;
+   float r = GS_MAX3 ( b.x-c.x, b.y-c.y, b.z-c.z );
+   if ( r<=0 ) r=1.0f;
+   GsMat t, s;
+   t.translation ( c );
+   s.scale ( r );
+   dequant = t*s;
+
+   GsArray<float> rel ( 3*n );
+   GsArray<gsuint16> h ( 3*n );
+   const float* p = P[0].e;
+   float inv=1.0f/r, cx=c.x, cy=c.y, cz=c.z;
+   for ( i=0; i<n; i++ )
+    { rel[3*i]   = (p[3*i]-cx)*inv;
+      rel[3*i+1] = (p[3*i+1]-cy)*inv;
+      rel[3*i+2] = (p[3*i+2]-cz)*inv;
+    }
+   gs_floats_to_halfs ( rel.pt(), h.pt(), 3*n );
+
+   const gsuint16 one = 0x3c00; // unused 4th coordinate
+   for ( i=0; i<n; i++, d+=stride )
+    { memcpy ( d, &h[3*i], 6 );
+      memcpy ( d+6, &one, 2 );
+      memcpy ( d+8, &normals[i], 4 );
+      memcpy ( d+12, &C[i], 4 );
+    }
+ }
+
+void SoModel::make_arrays ( GsModel& m, bool indexed, GsArray<GsVec>& P, GsArray<GsVec>& N,
+                            GsArray<GsColor>& C, GsArray<gsuint>& I )
  {
    int i;
-   GsColor c;
-   P.size(0); C.size(0); N.size(0);
+   GsColor c, prevc=GsColor::gray;
 
    /* There are multiple ways to organize data to send to OpenGL. 
       Here we send material information per vertex but we only send the diffuse color
       information per vertex. The other components are uniforms sent to affect the whole object.
       This is a solution that keeps this code simple and is ok for most objects.
+      When indexed, the corners with equal position, normal and color share one vertex,
+      otherwise each face gets its own 3 vertices.
    */
 
+   VertexTable table ( indexed? 3*m.F.size():0 );
+   GsVec fn[3];
+
    // build arrays:
    for ( i=0; i<m.F.size(); i++ )
     { GsModel::Face& f = m.F[i];
-      P.push()=m.V[f.a]; P.push()=m.V[f.b]; P.push()=m.V[f.c]; 
+      const GsVec* fp[3] = { &m.V[f.a], &m.V[f.b], &m.V[f.c] };
 
       if ( m.Fn.size()>0 && i<m.Fn.size() )
        { GsModel::Face& f = m.Fn[i];
-         N.push()=m.N[f.a]; N.push()=m.N[f.b]; N.push()=m.N[f.c];
-         //std::cout<<i<<": "<<N.top()<<"\n";
+         fn[0]=m.N[f.a]; fn[1]=m.N[f.b]; fn[2]=m.N[f.c];
        }
       else if ( m.N.size()>0 && i<m.N.size() )
-       { GsVec n=m.N[i]; N.push()=n; N.push()=n; N.push()=n; }
+       { fn[0]=m.N[i]; fn[1]=fn[0]; fn[2]=fn[0]; }
       else
-       { GsVec n=m.face_normal(i); N.push()=n; N.push()=n; N.push()=n; }
+       { fn[0]=m.face_normal(i); fn[1]=fn[0]; fn[2]=fn[0]; }
 
       c = GsColor::gray;
       if ( m.Fm.size()>0 && i<m.Fm.size() ) 
        { int id=m.Fm[i]; 
-         if (id<0) { if (C.size()>0)c=C.top(); } else c=m.M[id].diffuse;
-         //std::cout<<i<<"/"<<id<<" "<<c<<"\n";
+         if (id<0) { if (i>0)c=prevc; } else c=m.M[id].diffuse;
        }
       else if ( m.M.size()>0 && i<m.M.size() ) 
        { c = m.M[i].diffuse; }
-      C.push()=c; C.push()=c; C.push()=c;
+      prevc = c;
+
+      for ( int k=0; k<3; k++ )
+       { if ( indexed ) I.push() = (gsuint) table.add ( P, N, C, *fp[k], fn[k], c );
+          else { P.push()=*fp[k]; N.push()=fn[k]; C.push()=c; }
+       }
     }
+ }
+
+void SoModel::build ( GsModel& m )
+ {
+   int i;
+   P.size(0); C.size(0); N.size(0); I.size(0);
+   make_arrays ( m, _indexed, P, N, C, I );
 
    if ( m.M.size()>0 ) _mtl=m.M[0]; else _mtl.init();
 
@@ -91,29 +208,62 @@ void SoModel::build ( GsModel& m )
    glEnableVertexAttribArray ( 1 );
    glEnableVertexAttribArray ( 2 );
 
-   glBindBuffer ( GL_ARRAY_BUFFER, buf[0] );
-   glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*P.size(), P.pt(), GL_STATIC_DRAW );
-   glVertexAttribPointer ( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+   if ( _format==Separate )
+    { _dequant.identity ();
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[0] );
+      glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*P.size(), P.pt(), GL_STATIC_DRAW );
+      glVertexAttribPointer ( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
 
-   glBindBuffer ( GL_ARRAY_BUFFER, buf[1] );
-   glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*N.size(), N.pt(), GL_STATIC_DRAW );
-   glVertexAttribPointer ( 1, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[1] );
+      glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*N.size(), N.pt(), GL_STATIC_DRAW );
+      glVertexAttribPointer ( 1, 3, GL_FLOAT, GL_FALSE, 0, 0 );
 
-   glBindBuffer ( GL_ARRAY_BUFFER, buf[2] );
-   glBufferData ( GL_ARRAY_BUFFER, 4*sizeof(gsbyte)*C.size(), C.pt(), GL_STATIC_DRAW );
-   glVertexAttribPointer ( 2, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, 0 );
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[2] );
+      glBufferData ( GL_ARRAY_BUFFER, 4*sizeof(gsbyte)*C.size(), C.pt(), GL_STATIC_DRAW );
+      glVertexAttribPointer ( 2, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, 0 );
+    }
+   else // all attributes in buffer 0:
+    { bool half = _format==InterleavedHalf;
+      GLsizei stride = (GLsizei)vertex_size();
+      GsArray<gsbyte> data;
+      pack_vertices ( P, N, C, half, data, _dequant );
 
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[0] );
+      glBufferData ( GL_ARRAY_BUFFER, data.size(), data.pt(), GL_STATIC_DRAW );
+      glVertexAttribPointer ( 0, 3, half? GL_HALF_FLOAT:GL_FLOAT, GL_FALSE, stride, 0 );
+      glVertexAttribPointer ( 1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)(size_t)(half? 8:12) );
+      glVertexAttribPointer ( 2, 4, GL_UNSIGNED_BYTE, GL_FALSE, stride, (void*)(size_t)(half? 12:16) );
 
+      // release the separate buffers of a previous build:
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[1] );
+      glBufferData ( GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW );
+      glBindBuffer ( GL_ARRAY_BUFFER, buf[2] );
+      glBufferData ( GL_ARRAY_BUFFER, 0, 0, GL_STATIC_DRAW );
+    }
+
+   // the index buffer binding is kept in the vertex array object:
+   glBindBuffer ( GL_ELEMENT_ARRAY_BUFFER, buf[3] );
+   if ( P.size()<=65536 ) // 16 bit indices are enough
+    { GsArray<gsuint16> I16 ( I.size() );
+      for ( i=0; i<I.size(); i++ ) I16[i]=(gsuint16)I[i];
+      glBufferData ( GL_ELEMENT_ARRAY_BUFFER, sizeof(gsuint16)*I16.size(), I16.pt(), GL_STATIC_DRAW );
+      _indextype = GL_UNSIGNED_SHORT;
+    }
+   else
+    { glBufferData ( GL_ELEMENT_ARRAY_BUFFER, sizeof(gsuint)*I.size(), I.pt(), GL_STATIC_DRAW );
+      _indextype = GL_UNSIGNED_INT;
+    }
 
    glBindVertexArray(0); // break the existing vertex array object binding.
 
    std::cout<<"build ok.\n";
 
-   // save size so that we can free our buffers and later draw the OpenGL arrays:
+   // save sizes so that we can free our buffers and later draw the OpenGL arrays:
    _numpoints = P.size();
+   _numindices = I.size();
 
    // free non-needed memory:
-   P.capacity(0); C.capacity(0); N.capacity(0);
+   P.capacity(0); C.capacity(0); N.capacity(0); I.capacity(0);
  }
 
 void SoModel::draw ( const GsMat& tr, const GsMat& pr, const GsLight& l, bool shadow )
@@ -129,9 +279,13 @@ void SoModel::draw ( const GsMat& tr, const GsMat& pr, const GsLight& l, bool sh
    float sh = (float)_mtl.shininess;
    if ( sh<0.001f ) sh=64;
 
+   // half float positions are mapped back to model coordinates first (_dequant is
+   // the identity for other formats):
+   GsMat mtr = tr*_dequant;
+
    if ( _phong )
     { glUseProgram ( _progphong.id );
-      glUniformMatrix4fv ( _progphong.uniloc[0], 1, GL_FALSE, tr.e );
+      glUniformMatrix4fv ( _progphong.uniloc[0], 1, GL_FALSE, mtr.e );
       glUniformMatrix4fv ( _progphong.uniloc[1], 1, GL_FALSE, pr.e );
       glUniform3fv ( _progphong.uniloc[2], 1, l.pos.e );
       glUniform4fv ( _progphong.uniloc[3], 1, l.amb.get(f) );
@@ -143,7 +297,7 @@ void SoModel::draw ( const GsMat& tr, const GsMat& pr, const GsLight& l, bool sh
     }
    else
     { glUseProgram ( _proggouraud.id );
-      glUniformMatrix4fv ( _proggouraud.uniloc[0], 1, GL_FALSE, tr.e );
+      glUniformMatrix4fv ( _proggouraud.uniloc[0], 1, GL_FALSE, mtr.e );
       glUniformMatrix4fv ( _proggouraud.uniloc[1], 1, GL_FALSE, pr.e );
       glUniform3fv ( _proggouraud.uniloc[2], 1, l.pos.e );
       glUniform4fv ( _proggouraud.uniloc[3], 1, l.amb.get(f) );
@@ -155,7 +309,10 @@ void SoModel::draw ( const GsMat& tr, const GsMat& pr, const GsLight& l, bool sh
     }
 
    glBindVertexArray ( va[0] );
-   glDrawArrays ( GL_TRIANGLES, 0, _numpoints );
+   if ( _numindices>0 )
+    glDrawElements ( GL_TRIANGLES, _numindices, _indextype, 0 );
+   else
+    glDrawArrays ( GL_TRIANGLES, 0, _numpoints );
    glBindVertexArray(0); // break the existing vertex array object binding.
  }
 
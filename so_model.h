@@ -15,23 +15,47 @@
 // here is an example of how to organize a scene object in a class.
 // Scene object axis:
 class SoModel : public GlObjects
- { private :
+ { public :
+    // layouts of the vertex data sent to OpenGL:
+    enum VertexFormat { Separate,       // float P, N and C in 3 buffers, 28 bytes per vertex
+                        Interleaved,    // float position, 10:10:10:2 normal and color in 1 buffer, 20 bytes
+                        InterleavedHalf // as Interleaved with half float positions relative to the bounds, 16 bytes
+                      };
+   private :
     GlShader _vshgou, _fshgou, _vshphong, _fshphong;
     GlProgram _proggouraud, _progphong;
 
     GsArray<GsVec>   P; // coordinates
     GsArray<GsColor> C; // diffuse colors per face
     GsArray<GsVec>   N; // normals
+    GsArray<gsuint>  I; // triangle indices to the shared vertices in P, C and N
     GsMaterial _mtl;    // main material
     int _numpoints;     // just saves the number of points
+    int _numindices;    // number of indices to draw, 0 if not indexed
+    GLenum _indextype;  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    GsMat _dequant;     // maps half float positions back to the model coordinates
+    VertexFormat _format;
     bool _phong;
+    bool _indexed;
    public :
     SoModel ();
     void phong ( bool b ) { _phong=b; }
     bool phong () const { return _phong; }
+    // equal vertices are shared with an index buffer (the default), applied at the next build
+    void indexed ( bool b ) { _indexed=b; }
+    bool indexed () const { return _indexed; }
+    // the vertex format is also applied at the next build, the default is Separate
+    void vertex_format ( VertexFormat f ) { _format=f; }
+    VertexFormat vertex_format () const { return _format; }
+    int vertex_size () const { return _format==Separate? 28 : _format==Interleaved? 20:16; }
+    int vertices () const { return _numpoints; }
+    int indices () const { return _numindices; }
     void init ();
     void build ( GsModel& m );
     void draw ( const GsMat& tr, const GsMat& pr, const GsLight& l, bool shadow );
+    // appends the triangles of m to the arrays as build() does, I is only used when indexed
+    static void make_arrays ( GsModel& m, bool indexed, GsArray<GsVec>& P, GsArray<GsVec>& N,
+                              GsArray<GsColor>& C, GsArray<gsuint>& I );
  };
 
 #endif // SO_MODEL_H
@@ -0,0 +1,146 @@
+
+# include <ctype.h>
+# include "so_text.h"
+
+// 5x7 font, 7 rows of 5 pixels per character:
+struct Glyph { char c; const char* rows; };
+static const Glyph Font[] =
+ { { '0', ".###.#...##..###.#.###..##...#.###." },
+   { '1', "..#...##....#....#....#....#...###." },
+   { '2', ".###.#...#....#...#...#...#...#####" },
+   { '3', "#####...#...#.....#.....##...#.###." },
+   { '4', "...#...##..#.#.#..#.#####...#....#." },
+   { '5', "######....####.....#....##...#.###." },
+   { '6', "..##..#...#....####.#...##...#.###." },
+   { '7', "#####....#...#...#...#....#....#..." },
+   { '8', ".###.#...##...#.###.#...##...#.###." },
+   { '9', ".###.#...##...#.####....#...#..##.." },
+   { 'A', ".###.#...##...#######...##...##...#" },
+   { 'B', "####.#...##...#####.#...##...#####." },
+   { 'C', ".###.#...##....#....#....#...#.###." },
+   { 'D', "###..#..#.#...##...##...##..#.###.." },
+   { 'E', "######....#....####.#....#....#####" },
+   { 'F', "######....#....####.#....#....#...." },
+   { 'G', ".###.#...##....#.####...##...#.####" },
+   { 'H', "#...##...##...#######...##...##...#" },
+   { 'I', ".###...#....#....#....#....#...###." },
+   { 'J', "..###...#....#....#....#.#..#..##.." },
+   { 'K', "#...##..#.#.#..##...#.#..#..#.#...#" },
+   { 'L', "#....#....#....#....#....#....#####" },
+   { 'M', "#...###.###.#.##.#.##...##...##...#" },
+   { 'N', "#...##...###..##.#.##..###...##...#" },
+   { 'O', ".###.#...##...##...##...##...#.###." },
+   { 'P', "####.#...##...#####.#....#....#...." },
+   { 'Q', ".###.#...##...##...##.#.##..#..##.#" },
+   { 'R', "####.#...##...#####.#.#..#..#.#...#" },
+   { 'S', ".#####....#.....###.....#....#####." },
+   { 'T', "#####..#....#....#....#....#....#.." },
+   { 'U', "#...##...##...##...##...##...#.###." },
+   { 'V', "#...##...##...##...##...#.#.#...#.." },
+   { 'W', "#...##...##...##.#.##.#.##.#.#.#.#." },
+   { 'X', "#...##...#.#.#...#...#.#.#...##...#" },
+   { 'Y', "#...##...#.#.#...#....#....#....#.." },
+   { 'Z', "#####....#...#...#...#...#....#####" },
+   { '.', "..........................##...##.." },
+   { ':', "......##...##........##...##......." },
+   { ',', ".....................##...##...#..." },
+   { '-', "...............#####..............." },
+   { '_', "..............................#####" },
+   { '=', "..........#####.....#####.........." },
+   { '/', ".........#...#...#...#...#........." },
+   { '%', "##...##..#...#...#...#...#..##...##" },
+   { '(', "...#...#...#....#....#.....#.....#." },
+   { ')', ".#.....#.....#....#....#...#...#..." },
+   { 0, 0 }
+ };
+
+static const char* glyph ( char c )
+ {
+   c = (char)toupper ( (unsigned char)c );
+   for ( const Glyph* g=Font; g->c; g++ ) if ( g->c==c ) return g->rows;
+   return 0; // drawn as a space
+ }
+
+SoText::SoText ()
+ {
+   _numpoints = 0;
+ }
+
+// init is called only once:
+void SoText::init ()
+ {
+   // Build program:
+   _vsh.load_and_compile ( GL_VERTEX_SHADER, "../shaders/vsh_mcol_flat.glsl" );
+   _fsh.load_and_compile ( GL_FRAGMENT_SHADER, "../shaders/fsh_flat.glsl" );
+   _prog.init_and_link ( _vsh, _fsh );
+
+   // Define buffers needed:
+   gen_vertex_arrays ( 1 ); // will use 1 vertex array
+   gen_buffers ( 2 );       // will use 2 buffers: one for coordinates and one for colors
+   _prog.uniform_locations ( 2 ); // will send 2 variables: the 2 matrices below
+   _prog.uniform_location ( 0, "vTransf" );
+   _prog.uniform_location ( 1, "vProj" );
+ }
+
+void SoText::build ( const char* text, int x, int y, int s, GsColor c, int w, int h )
+ {
+   P.size(0); C.size(0);
+
+   // pixels are converted to normalized device coordinates:
+   const float sx=2.0f/float(w), sy=2.0f/float(h);
+   int cx=x, cy=y;
+   for ( const char* t=text; *t; t++ )
+    { if ( *t=='\n' ) { cx=x; cy+=9*s; continue; }
+      const char* rows = glyph ( *t );
+      for ( int r=0; rows && r<7; r++ )
+       { for ( int i=0; i<5; i++ )
+          { if ( rows[r*5+i]!='#' ) continue;
+            int e=i; // runs of pixels in a row are one quad
+            while ( e<4 && rows[r*5+e+1]=='#' ) e++;
+            float x1 = float(cx+i*s)*sx-1.0f, x2 = float(cx+(e+1)*s)*sx-1.0f;
+            float y1 = 1.0f-float(cy+r*s)*sy, y2 = 1.0f-float(cy+(r+1)*s)*sy;
+            P.push().set ( x1, y1, 0 ); P.push().set ( x1, y2, 0 ); P.push().set ( x2, y2, 0 );
+            P.push().set ( x1, y1, 0 ); P.push().set ( x2, y2, 0 ); P.push().set ( x2, y1, 0 );
+            i=e;
+          }
+       }
+      cx += 6*s;
+    }
+   C.size ( P.size() );
+   C.setall ( c );
+
+   // send data to OpenGL buffers:
+   glBindVertexArray ( va[0] );
+   glEnableVertexAttribArray ( 0 );
+   glEnableVertexAttribArray ( 1 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[0] );
+   glBufferData ( GL_ARRAY_BUFFER, 3*sizeof(float)*P.size(), P.pt(), GL_STREAM_DRAW );
+   glVertexAttribPointer ( 0, 3, GL_FLOAT, GL_FALSE, 0, 0 );
+
+   glBindBuffer ( GL_ARRAY_BUFFER, buf[1] );
+   glBufferData ( GL_ARRAY_BUFFER, 4*sizeof(gsbyte)*C.size(), C.pt(), GL_STREAM_DRAW );
+   glVertexAttribPointer ( 1, 4, GL_UNSIGNED_BYTE, GL_FALSE, 0, 0 );
+
+   glBindVertexArray(0); // break the existing vertex array object binding.
+
+   // save size so that we can later draw the OpenGL arrays; the arrays are
+   // kept since the text is built again often:
+   _numpoints = P.size();
+ }
+
+// draw will be called everytime we need to display this object:
+void SoText::draw ()
+ {
+   // Prepare program, the coordinates are already in the window:
+   glUseProgram ( _prog.id );
+   glUniformMatrix4fv ( _prog.uniloc[0], 1, GL_FALSE, GsMat::id.e );
+   glUniformMatrix4fv ( _prog.uniloc[1], 1, GL_FALSE, GsMat::id.e );
+
+   // Draw without depth test, on top of the scene:
+   glDisable ( GL_DEPTH_TEST );
+   glBindVertexArray ( va[0] );
+   glDrawArrays ( GL_TRIANGLES, 0, _numpoints );
+   glBindVertexArray(0); // break the existing vertex array object binding.
+   glEnable ( GL_DEPTH_TEST );
+ }
@@ -0,0 +1,32 @@
+// Ensure the header file is included only once in multi-file projects
+#ifndef SO_TEXT_H
+#define SO_TEXT_H
+
+// Include needed header files
+# include <gsim/gs_color.h>
+# include <gsim/gs_array.h>
+# include <gsim/gs_vec.h>
+# include "ogl_tools.h"
+
+// Text drawn over the scene in window coordinates, with a built-in 5x7 pixel
+// font (upper case letters, digits and a few symbols) whose pixels are quads,
+// so that no texture or old OpenGL functions are needed:
+class SoText : public GlObjects
+ { private :
+    GlShader _vsh, _fsh;
+    GlProgram _prog;
+    GsArray<GsVec>   P; // coordinates
+    GsArray<GsColor> C; // color
+    int _numpoints;     // just saves the number of points
+
+   public :
+    SoText ();
+    void init ();
+    // builds the lines of text, separated by '\n', starting at pixel (x,y) from
+    // the top left corner of a w x h window; each font pixel has size s
+    void build ( const char* text, int x, int y, int s, GsColor c, int w, int h );
+    // draws the text on top of the scene
+    void draw ();
+ };
+
+#endif // SO_TEXT_H